@@ -0,0 +1,360 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <creek/BytecodeInterpreter.hpp>
+#include <creek/Compiler.hpp>
+#include <creek/Expression.hpp>
+#include <creek/Expression_ControlFlow.hpp>
+#include <creek/Interpreter.hpp>
+#include <creek/Scope.hpp>
+#include <creek/StandardLibrary.hpp>
+#include <creek/Variable.hpp>
+using namespace creek;
+
+
+// source code to measure
+struct Input
+{
+    std::string name;
+    std::string code;
+    bool eval;
+};
+
+// size of an input, used to report throughput
+struct InputSize
+{
+    size_t bytes;
+    size_t tokens;
+    size_t nodes;
+};
+
+// timing of the repetitions of a stage, in seconds
+struct Stats
+{
+    double min;
+    double median;
+    double mean;
+    double deviation;
+};
+
+
+// show help
+void show_usage(char* path);
+
+// generate a source code with `units` copies of a code sample
+std::string generate_code(int units);
+
+// read a source file
+bool read_file(const std::string& path, std::string& code);
+
+// measure every stage of an input
+void run_input(const Input& input, int repetitions, const std::string& bytecode_path);
+
+// print the stats of a stage
+void print_stats(const std::string& stage, const Stats& stats, const InputSize& size);
+
+
+std::chrono::steady_clock::time_point start_timer() {
+    return std::chrono::steady_clock::now();
+}
+double diff_timer(std::chrono::steady_clock::time_point start) {
+    std::chrono::duration<double> diff = std::chrono::steady_clock::now() - start;
+    return diff.count();
+}
+
+// run a stage once to warm up, then `repetitions` times
+// `stage` returns the seconds taken by the measured part
+template<class Stage>
+Stats measure(int repetitions, Stage stage)
+{
+    stage();
+
+    std::vector<double> times;
+    for (int i = 0; i < repetitions; i += 1)
+    {
+        times.push_back(stage());
+    }
+    std::sort(times.begin(), times.end());
+
+    Stats stats;
+    stats.min = times.front();
+    stats.median = times.size() % 2 ? times[times.size() / 2] : (times[times.size() / 2 - 1] + times[times.size() / 2]) / 2;
+    stats.mean = 0;
+    for (auto t : times)
+    {
+        stats.mean += t;
+    }
+    stats.mean /= times.size();
+    stats.deviation = 0;
+    for (auto t : times)
+    {
+        stats.deviation += (t - stats.mean) * (t - stats.mean);
+    }
+    stats.deviation = std::sqrt(stats.deviation / times.size());
+    return stats;
+}
+
+
+// main function
+int main(int argc, char** argv)
+{
+    int repetitions = 10;
+    int generated_units = 1000;
+    bool eval_files = false;
+    std::string bytecode_path = "benchmark.creekb";
+    std::vector<const char*> input_paths;
+
+
+    // parse command
+    for (int i = 1; i < argc; i += 1)
+    {
+        // help
+        if (strcmp(argv[i], "-h") == 0)
+        {
+            show_usage(argv[0]);
+            return 0;
+        }
+        // repetitions
+        else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+        {
+            i += 1;
+            repetitions = std::max(1, std::atoi(argv[i]));
+        }
+        // generated code size
+        else if (strcmp(argv[i], "-g") == 0 && i + 1 < argc)
+        {
+            i += 1;
+            generated_units = std::max(0, std::atoi(argv[i]));
+        }
+        // evaluate input files
+        else if (strcmp(argv[i], "-e") == 0)
+        {
+            eval_files = true;
+        }
+        // set bytecode file
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+        {
+            i += 1;
+            bytecode_path = argv[i];
+        }
+        // unknown option
+        else if (argv[i][0] == '-')
+        {
+            show_usage(argv[0]);
+            return -1;
+        }
+        // add input file
+        else
+        {
+            input_paths.push_back(argv[i]);
+        }
+    }
+
+    // inputs
+    std::vector<Input> inputs;
+    if (generated_units > 0)
+    {
+        inputs.push_back({ "generated (" + std::to_string(generated_units) + " units)", generate_code(generated_units), true });
+    }
+    for (auto& input_path : input_paths)
+    {
+        Input input = { input_path, "", eval_files };
+        if (!read_file(input_path, input.code))
+        {
+            std::cerr << "Can't open input file " << input_path << ".\n";
+            return -1;
+        }
+        inputs.push_back(input);
+    }
+
+    // measure
+    int result = 0;
+    std::cout << repetitions << " repetitions per stage, after one warm-up run.\n";
+    for (auto& input : inputs)
+    {
+        try
+        {
+            run_input(input, repetitions, bytecode_path);
+        }
+        catch (const Exception& e)
+        {
+            std::cerr << "Exception thrown while measuring " << input.name << ":\n";
+            std::cerr << "\t" << e.message() << "\n";
+            result = -1;
+        }
+    }
+    std::remove(bytecode_path.c_str());
+
+    return result;
+}
+
+
+// show help
+void show_usage(char* path)
+{
+    std::cout << "usage: " << path << "  [options] [input files]\n";
+    std::cout << "Available options:\n"
+                 "    -h              Display usage.\n"
+                 "    -n <count>      Repetitions of each stage (default 10).\n"
+                 "    -g <units>      Size of the generated input; 0 to skip it\n"
+                 "                    (default 1000).\n"
+                 "    -e              Evaluate the input files too (the\n"
+                 "                    generated input is always evaluated).\n"
+                 "    -o <path>       Set temporary bytecode file.\n"
+                 "Measures scan, parse, const_optimize, bytecode save/load and\n"
+                 "eval of each input, reporting the median, minimum, mean and\n"
+                 "deviation of the repetitions, and the median throughput in\n"
+                 "tokens, expression nodes and source MB per second.\n";
+}
+
+// generate a source code with `units` copies of a code sample
+std::string generate_code(int units)
+{
+    std::stringstream code;
+    for (int i = 0; i < units; i += 1)
+    {
+        std::string n = std::to_string(i);
+        code << "// unit " << n << "\n"
+                "class Point" << n << " {\n"
+                "    func init(self, x, y) {\n"
+                "        self::x = x;\n"
+                "        self::y = y;\n"
+                "    }\n"
+                "    func sum(self) {\n"
+                "        return self::x + self::y;\n"
+                "    }\n"
+                "}\n"
+                "func calc" << n << "(a, b) {\n"
+                "    var c = a * " << n << " + b / 2 - 0x1F % 3;\n"
+                "    if c > 10 { c = c - 1; } else { c = c + 1.5; }\n"
+                "    for i = 0 .. 3 { c = c + i; }\n"
+                "    while c > 100 { c = c / 2; }\n"
+                "    return c;\n"
+                "}\n"
+                "var text" << n << " = \"unit \\\"" << n << "\\\"\" + 'a';\n"
+                "var list" << n << " = [1, 2.5, 0b101, null, true, false, text" << n << "];\n"
+                "var map" << n << " = {\"key\": " << n << ", \"list\": list" << n << "};\n"
+                "var point" << n << " = Point" << n << "(" << n << ", calc" << n << "(" << n << ", 2));\n"
+                "var result" << n << " = point" << n << ".sum() + map" << n << "[\"key\"] + list" << n << "[1];\n"
+                "\n";
+    }
+    return code.str();
+}
+
+// read a source file
+bool read_file(const std::string& path, std::string& code)
+{
+    std::ifstream file(path, std::ios_base::binary);
+    if (file.fail())
+    {
+        return false;
+    }
+    std::stringstream stream;
+    stream << file.rdbuf();
+    code = stream.str();
+    return true;
+}
+
+// measure every stage of an input
+void run_input(const Input& input, int repetitions, const std::string& bytecode_path)
+{
+    Interpreter interpreter;
+    std::unique_ptr<Expression> program(interpreter.load_code(input.code));
+
+    InputSize size;
+    size.bytes = input.code.size();
+    size.tokens = interpreter.scan(input.code).size() - 1; // without EOF
+    Compiler compiler;
+    compiler.compile(program.get());
+    size.nodes = compiler.expression_count();
+
+    std::cout << "\n" << input.name << ": " << size.bytes << " bytes, " << size.tokens << " tokens, " << size.nodes << " nodes\n";
+    std::cout << std::left << std::setw(16) << "stage"
+              << std::right << std::setw(12) << "median ms"
+              << std::setw(12) << "min ms"
+              << std::setw(12) << "mean ms"
+              << std::setw(8) << "dev %"
+              << std::setw(12) << "Mtokens/s"
+              << std::setw(12) << "Mnodes/s"
+              << std::setw(10) << "MB/s" << "\n";
+
+    // scan
+    print_stats("scan", measure(repetitions, [&]() {
+        auto start = start_timer();
+        auto tokens = interpreter.scan(input.code);
+        return diff_timer(start);
+    }), size);
+
+    // parse
+    auto tokens = interpreter.scan(input.code);
+    print_stats("parse", measure(repetitions, [&]() {
+        auto start = start_timer();
+        auto expressions = interpreter.parse(tokens);
+        double time = diff_timer(start);
+        ExprBasicBlock block(expressions);
+        return time;
+    }), size);
+
+    // const optimize
+    print_stats("const_optimize", measure(repetitions, [&]() {
+        auto start = start_timer();
+        std::unique_ptr<Expression> optimized(program->const_optimize());
+        double time = diff_timer(start);
+        return time;
+    }), size);
+
+    // bytecode
+    BytecodeInterpreter bytecode_interpreter;
+    print_stats("save_file", measure(repetitions, [&]() {
+        auto start = start_timer();
+        bytecode_interpreter.save_file(bytecode_path, program.get());
+        return diff_timer(start);
+    }), size);
+
+    print_stats("load_file", measure(repetitions, [&]() {
+        auto start = start_timer();
+        std::unique_ptr<Expression> loaded(bytecode_interpreter.load_file(bytecode_path));
+        double time = diff_timer(start);
+        return time;
+    }), size);
+
+    // eval
+    if (input.eval)
+    {
+        print_stats("eval", measure(repetitions, [&]() {
+            Scope scope;
+            load_standard_library(scope);
+            auto start = start_timer();
+            Variable result = program->eval(scope);
+            return diff_timer(start);
+        }), size);
+    }
+}
+
+// print the stats of a stage
+void print_stats(const std::string& stage, const Stats& stats, const InputSize& size)
+{
+    double median = std::max(stats.median, 1e-9);
+    std::cout << std::left << std::setw(16) << stage << std::right << std::fixed
+              << std::setprecision(3)
+              << std::setw(12) << stats.median * 1000
+              << std::setw(12) << stats.min * 1000
+              << std::setw(12) << stats.mean * 1000
+              << std::setprecision(1)
+              << std::setw(8) << (stats.mean > 0 ? stats.deviation / stats.mean * 100 : 0)
+              << std::setprecision(3)
+              << std::setw(12) << size.tokens / median / 1e6
+              << std::setw(12) << size.nodes / median / 1e6
+              << std::setw(10) << size.bytes / median / 1e6 << "\n";
+}
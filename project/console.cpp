@@ -5,6 +5,7 @@
 
 #include <creek/BytecodeInterpreter.hpp>
 #include <creek/CFunction.hpp>
+#include <creek/Compiler.hpp>
 #include <creek/Expression.hpp>
 #include <creek/Expression_ControlFlow.hpp>
 #include <creek/Expression_DataTypes.hpp>
@@ -12,7 +13,9 @@
 #include <creek/Scope.hpp>
 #include <creek/StandardLibrary.hpp>
 #include <creek/VarName.hpp>
+#include <creek/VarResolver.hpp>
 #include <creek/Version.hpp>
+#include <creek/VirtualMachine.hpp>
 using namespace creek;
 
 
@@ -177,6 +180,7 @@ int main(int argc, char** argv)
         if (const_optimize)
         {
             program.reset(program->const_optimize());
+            VarResolver().resolve(program.get());
         }
 
         // output
@@ -186,6 +190,15 @@ int main(int argc, char** argv)
         }
         else
         {
+            // the interactive session uses the variables of the program
+            if (interactive)
+            {
+                if (auto compiled = dynamic_cast<ExprProgram*>(program.get()))
+                {
+                    program.reset(Compiler().decompile(*compiled->program()));
+                }
+                VarResolver().resolve_shared(program.get());
+            }
             exec_program(program.get(), scope);
         }
     }
@@ -361,12 +374,15 @@ void exec_interactive(bool const_optimize, Scope& scope)
                 try
                 {
                     Interpreter interpreter;
-                    program.reset(interpreter.load_code(input));
+                    program.reset(new ExprBasicBlock(interpreter.parse(interpreter.scan(input))));
 
                     if (const_optimize)
                     {
                         program.reset(program->const_optimize());
                     }
+
+                    // the variables of each line stay in the session scope
+                    VarResolver().resolve_shared(program.get());
                 }
                 catch (const SyntaxError& e)
                 {
@@ -0,0 +1,326 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <creek/CFunction.hpp>
+#include <creek/Compiler.hpp>
+#include <creek/Expression.hpp>
+#include <creek/Interpreter.hpp>
+#include <creek/Scope.hpp>
+#include <creek/StandardLibrary.hpp>
+#include <creek/Variable.hpp>
+#include <creek/Version.hpp>
+#include <creek/VirtualMachine.hpp>
+using namespace creek;
+
+
+// script measured by a microbenchmark
+// `$N` in the code is replaced by the number of iterations
+struct Microbenchmark
+{
+    std::string name;
+    int iterations;
+    std::string code;
+};
+
+// timing of the repetitions of a run, in seconds
+struct Stats
+{
+    double min;
+    double median;
+    double mean;
+    double deviation;
+};
+
+// result of a microbenchmark in one mode
+struct Result
+{
+    std::string name;
+    std::string mode;
+    int iterations;
+    Stats stats;
+};
+
+
+// microbenchmarks, one per hot construct
+const std::vector<Microbenchmark> microbenchmarks =
+{
+    { "loop_for", 200000,
+        "var s = 0;\n"
+        "for i = 0 .. $N { s = s + i; }\n" },
+
+    { "loop_while", 200000,
+        "var i = 0;\n"
+        "while i < $N { i = i + 1; }\n" },
+
+    { "call_function", 100000,
+        "func f(a, b) { return a + b; }\n"
+        "var s = 0;\n"
+        "for i = 0 .. $N { s = f(s, i); }\n" },
+
+    { "call_cfunction", 100000,
+        "var s = 0;\n"
+        "for i = 0 .. $N { s = native_add(s, i); }\n" },
+
+    { "call_method", 100000,
+        "class Counter {\n"
+        "    func init(self) { self::n = 0; }\n"
+        "    func add(self, x) { self::n = self::n + x; }\n"
+        "}\n"
+        "var c = Counter();\n"
+        "for i = 0 .. $N { c.add(i); }\n" },
+
+    { "vector_index", 100000,
+        "var v = [0, 0, 0, 0, 0, 0, 0, 0];\n"
+        "for i = 0 .. $N { v[i % 8] = v[(i + 1) % 8] + 1; }\n" },
+
+    { "map_index", 100000,
+        "var m = {\"a\": 0, \"b\": 1, 2: 2};\n"
+        "for i = 0 .. $N { m[\"a\"] = m[\"b\"] + m[2] + i; }\n" },
+
+    { "string_concat", 100000,
+        "var s = \"abc\";\n"
+        "for i = 0 .. $N { var t = s + \"def\"; }\n" },
+
+    { "try_throw", 20000,
+        "var s = 0;\n"
+        "for i = 0 .. $N { try { throw i; } catch e { s = s + 1; } }\n" },
+};
+
+
+// show help
+void show_usage(char* path);
+
+// C++ function called from script
+double native_add(double a, double b);
+
+// measure a microbenchmark in both modes
+void run_microbenchmark(const Microbenchmark& microbenchmark, double scale, int repetitions, std::vector<Result>& results);
+
+// write the results as JSON
+void write_json(std::ostream& out, int repetitions, double scale, const std::vector<Result>& results);
+
+
+std::chrono::steady_clock::time_point start_timer() {
+    return std::chrono::steady_clock::now();
+}
+double diff_timer(std::chrono::steady_clock::time_point start) {
+    std::chrono::duration<double> diff = std::chrono::steady_clock::now() - start;
+    return diff.count();
+}
+
+// run once to warm up, then `repetitions` times
+// `run` returns the seconds taken by the measured part
+template<class Run>
+Stats measure(int repetitions, Run run)
+{
+    run();
+
+    std::vector<double> times;
+    for (int i = 0; i < repetitions; i += 1)
+    {
+        times.push_back(run());
+    }
+    std::sort(times.begin(), times.end());
+
+    Stats stats;
+    stats.min = times.front();
+    stats.median = times.size() % 2 ? times[times.size() / 2] : (times[times.size() / 2 - 1] + times[times.size() / 2]) / 2;
+    stats.mean = 0;
+    for (auto t : times)
+    {
+        stats.mean += t;
+    }
+    stats.mean /= times.size();
+    stats.deviation = 0;
+    for (auto t : times)
+    {
+        stats.deviation += (t - stats.mean) * (t - stats.mean);
+    }
+    stats.deviation = std::sqrt(stats.deviation / times.size());
+    return stats;
+}
+
+
+// main function
+int main(int argc, char** argv)
+{
+    int repetitions = 10;
+    double scale = 1;
+    const char* output_path = nullptr;
+    std::vector<std::string> filters;
+
+
+    // parse command
+    for (int i = 1; i < argc; i += 1)
+    {
+        // help
+        if (strcmp(argv[i], "-h") == 0)
+        {
+            show_usage(argv[0]);
+            return 0;
+        }
+        // repetitions
+        else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+        {
+            i += 1;
+            repetitions = std::max(1, std::atoi(argv[i]));
+        }
+        // iterations scale
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+        {
+            i += 1;
+            scale = std::max(0.001, std::atof(argv[i]));
+        }
+        // set output file
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+        {
+            i += 1;
+            output_path = argv[i];
+        }
+        // unknown option
+        else if (argv[i][0] == '-')
+        {
+            show_usage(argv[0]);
+            return -1;
+        }
+        // add filter
+        else
+        {
+            filters.push_back(argv[i]);
+        }
+    }
+
+    // measure
+    std::vector<Result> results;
+    for (auto& microbenchmark : microbenchmarks)
+    {
+        bool selected = filters.empty();
+        for (auto& filter : filters)
+        {
+            selected = selected || microbenchmark.name.find(filter) != std::string::npos;
+        }
+        if (!selected)
+        {
+            continue;
+        }
+
+        try
+        {
+            run_microbenchmark(microbenchmark, scale, repetitions, results);
+        }
+        catch (const Exception& e)
+        {
+            std::cerr << "Exception thrown while measuring " << microbenchmark.name << ":\n";
+            std::cerr << "\t" << e.message() << "\n";
+            return -1;
+        }
+    }
+
+    // output
+    if (output_path)
+    {
+        std::ofstream file(output_path, std::ios_base::trunc);
+        if (file.fail())
+        {
+            std::cerr << "Can't open output file " << output_path << ".\n";
+            return -1;
+        }
+        write_json(file, repetitions, scale, results);
+    }
+    else
+    {
+        write_json(std::cout, repetitions, scale, results);
+    }
+
+    return 0;
+}
+
+
+// show help
+void show_usage(char* path)
+{
+    std::cout << "usage: " << path << "  [options] [names]\n";
+    std::cout << "Available options:\n"
+                 "    -h              Display usage.\n"
+                 "    -n <count>      Repetitions of each run (default 10).\n"
+                 "    -s <scale>      Multiply the iterations of each\n"
+                 "                    microbenchmark (default 1).\n"
+                 "    -o <path>       Set output file (default stdout).\n"
+                 "Runs the microbenchmarks whose name contains any of the\n"
+                 "given names (all if none), both evaluating the expression\n"
+                 "tree and in the virtual machine, and writes the results as\n"
+                 "JSON. Times are in nanoseconds.\n";
+}
+
+// C++ function called from script
+double native_add(double a, double b)
+{
+    return a + b;
+}
+
+// measure a microbenchmark in both modes
+void run_microbenchmark(const Microbenchmark& microbenchmark, double scale, int repetitions, std::vector<Result>& results)
+{
+    int iterations = std::max(1, static_cast<int>(microbenchmark.iterations * scale));
+
+    std::string code = microbenchmark.code;
+    for (size_t pos = code.find("$N"); pos != std::string::npos; pos = code.find("$N", pos))
+    {
+        code.replace(pos, 2, std::to_string(iterations));
+    }
+
+    Interpreter interpreter;
+    std::unique_ptr<Expression> tree(interpreter.load_code(code));
+    std::unique_ptr<Expression> vm(new ExprProgram(Compiler().compile(tree.get())));
+
+    for (auto& mode : { std::make_pair("tree", tree.get()), std::make_pair("vm", vm.get()) })
+    {
+        Expression* program = mode.second;
+        Stats stats = measure(repetitions, [&]() {
+            Scope scope;
+            load_standard_library(scope);
+            scope.create_local_var(VarName::from_name("native_add"), new CFunction(scope, &native_add));
+            auto start = start_timer();
+            Variable result = program->eval(scope);
+            return diff_timer(start);
+        });
+        results.push_back({ microbenchmark.name, mode.first, iterations, stats });
+    }
+}
+
+// write the results as JSON
+void write_json(std::ostream& out, int repetitions, double scale, const std::vector<Result>& results)
+{
+    out.precision(15);
+    out << "{\n";
+    out << "  \"version\": \"" << Version::linked().str() << "\",\n";
+    out << "  \"repetitions\": " << repetitions << ",\n";
+    out << "  \"scale\": " << scale << ",\n";
+    out << "  \"results\": [";
+    for (size_t i = 0; i < results.size(); i += 1)
+    {
+        auto& result = results[i];
+        out << (i > 0 ? ",\n" : "\n");
+        out << "    {"
+            << "\"name\": \"" << result.name << "\", "
+            << "\"mode\": \"" << result.mode << "\", "
+            << "\"iterations\": " << result.iterations << ", "
+            << "\"median_ns\": " << std::llround(result.stats.median * 1e9) << ", "
+            << "\"min_ns\": " << std::llround(result.stats.min * 1e9) << ", "
+            << "\"mean_ns\": " << std::llround(result.stats.mean * 1e9) << ", "
+            << "\"deviation_ns\": " << std::llround(result.stats.deviation * 1e9) << ", "
+            << "\"ns_per_iteration\": " << result.stats.median * 1e9 / result.iterations
+            << "}";
+    }
+    out << "\n  ]\n";
+    out << "}\n";
+}
@@ -22,7 +22,8 @@ int main(int argc, char** argv)
             std::cout << "saving program\n";
 
             VarNameMap var_name_map;
-            auto bytecode = program->bytecode(var_name_map);
+            Bytecode bytecode;
+            program->bytecode(bytecode, var_name_map);
             auto bytes = bytecode.bytes();
 
             std::ofstream file("test.creekb", std::ios_base::binary|std::ios_base::trunc);
@@ -0,0 +1,99 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <creek/BytecodeCache.hpp>
+#include <creek/Data.hpp>
+#include <creek/Exception.hpp>
+#include <creek/ModuleRegistry.hpp>
+#include <creek/Scope.hpp>
+#include <creek/StandardLibrary.hpp>
+#include <creek/Variable.hpp>
+using namespace creek;
+
+
+// module returning a function that creates counters
+const std::string module_name = "test_require_counter";
+const std::string module_code =
+    "func make() { var n = 0; return func() { n = n + 1; n }; } make";
+
+
+// require the module with a new registry, as a new run of a program would,
+// and count twice with a new counter
+// returns the counts, or an empty vector on error
+std::vector<double> run(const std::string& path);
+
+// call a function without arguments
+Variable call(Variable& function);
+
+
+// main function
+int main(int argc, char** argv)
+{
+    auto path = "./" + module_name + ".txt";
+    {
+        std::ofstream file(path, std::ios_base::trunc);
+        file << module_code;
+    }
+    auto bytecode_path = BytecodeCache().bytecode_path(path);
+    std::remove(bytecode_path.c_str());
+
+    // the first run interprets the source and writes the bytecode file,
+    // the second one loads the bytecode file
+    auto from_source = run(path);
+    bool is_cached = std::ifstream(bytecode_path).good();
+    auto from_cache = run(path);
+
+    std::remove(bytecode_path.c_str());
+    std::remove(path.c_str());
+
+    std::vector<double> expected = { 1, 2 };
+    if (from_source != expected || !is_cached || from_cache != expected)
+    {
+        std::cerr << "Module " << module_name << " failed:\n";
+        std::cerr << "\tfrom source: " << (from_source == expected ? "ok" : "wrong counts") << "\n";
+        std::cerr << "\tcached: " << (is_cached ? "yes" : "no") << "\n";
+        std::cerr << "\tfrom cache: " << (from_cache == expected ? "ok" : "wrong counts") << "\n";
+        return -1;
+    }
+
+    std::cout << "Module " << module_name << " ok.\n";
+    return 0;
+}
+
+
+// require the module with a new registry and count twice
+std::vector<double> run(const std::string& path)
+{
+    std::vector<double> counts;
+    try
+    {
+        Scope scope;
+        load_standard_library(scope);
+
+        ModuleRegistry modules({ path });
+        Variable make = modules.require(scope, module_name);
+        Variable counter = call(make);
+        for (int i = 0; i < 2; i += 1)
+        {
+            counts.push_back(call(counter).double_value());
+        }
+    }
+    catch (const Exception& e)
+    {
+        std::cerr << "Exception thrown while running " << path << ":\n";
+        std::cerr << "\t" << e.message() << "\n";
+        counts.clear();
+    }
+    return counts;
+}
+
+// call a function without arguments
+Variable call(Variable& function)
+{
+    std::vector< std::unique_ptr<Data> > args;
+    return Variable(function->call(args));
+}
@@ -0,0 +1,68 @@
+#include <creek/AttrCache.hpp>
+
+#include <creek/GlobalScope.hpp>
+
+
+namespace creek
+{
+    // `AttrCache` constructor.
+    AttrCache::AttrCache() : m_next(0)
+    {
+
+    }
+
+
+    // Get an attribute of an object.
+    Variable AttrCache::attr(Variable& object, VarName key)
+    {
+        if (object && object->type() == DataType::object)
+        {
+            if (Variable* attr = find(static_cast<Object*>(*object)->value(), key))
+            {
+                return *attr;
+            }
+        }
+        return object.attr(key);
+    }
+
+    // Get a method of the class of an object.
+    Variable AttrCache::method(Variable& object, VarName key)
+    {
+        const Variable* class_obj = GlobalScope::current().class_of(*object);
+        if (class_obj && *class_obj && (*class_obj)->type() == DataType::object)
+        {
+            if (Variable* method = find(static_cast<Object*>(**class_obj)->value(), key))
+            {
+                return *method;
+            }
+        }
+        Variable class_copy = object->get_class();
+        return class_copy.attr(key);
+    }
+
+
+    // Find an attribute in a definition.
+    Variable* AttrCache::find(const Object::Value& definition, VarName key)
+    {
+        const Shape* shape = definition->shape;
+        for (auto& entry : m_entries)
+        {
+            if (entry.shape == shape)
+            {
+                return &definition->slots[entry.slot];
+            }
+        }
+
+        size_t slot = shape->find(key);
+        if (slot == Shape::no_slot)
+        {
+            return nullptr;
+        }
+
+        Entry& entry = m_entries[m_next];
+        m_next = (m_next + 1) % size;
+        entry.shape = shape;
+        entry.slot = slot;
+        return &definition->slots[slot];
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+
+#include <creek/api_mode.hpp>
+#include <creek/Object.hpp>
+#include <creek/Shape.hpp>
+#include <creek/Variable.hpp>
+#include <creek/VarName.hpp>
+
+
+namespace creek
+{
+    /// @brief  Inline cache for the attribute lookups of a call site.
+    /// Remembers the slot of the attribute for the last shapes seen (up to
+    /// `size`, so it is polymorphic), to skip the slot lookup and the copy of
+    /// the attribute data.
+    class CREEK_API AttrCache
+    {
+    public:
+        /// @brief  Number of definitions remembered.
+        static const size_t size = 4;
+
+
+        /// @brief  `AttrCache` constructor.
+        AttrCache();
+
+
+        /// @brief  Get an attribute of an object.
+        /// Same as `object.attr(key)`.
+        /// @param  object      Object.
+        /// @param  key         Attribute key; must be always the same.
+        Variable attr(Variable& object, VarName key);
+
+        /// @brief  Get a method of the class of an object.
+        /// Same as `Variable(object->get_class()).attr(key)`.
+        /// @param  object      Object.
+        /// @param  key         Method name; must be always the same.
+        Variable method(Variable& object, VarName key);
+
+
+    private:
+        /// @brief  Cached lookup.
+        struct Entry
+        {
+            const Shape* shape = nullptr;       ///< Shape where the attribute was found.
+            size_t slot = Shape::no_slot;       ///< Slot of the attribute.
+        };
+
+        /// @brief  Find an attribute in a definition.
+        /// @return Null if not found.
+        Variable* find(const Object::Value& definition, VarName key);
+
+        Entry m_entries[size];
+        size_t m_next;
+    };
+}
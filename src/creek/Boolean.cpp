@@ -8,7 +8,7 @@ namespace creek
 {
     // `Boolean` constructor.
     // @param  value   Boolean value.
-    Boolean::Boolean(Value value) : m_value(value)
+    Boolean::Boolean(Value value) : Data(DataType::boolean), m_value(value)
     {
 
     }
@@ -163,8 +163,13 @@ namespace creek
         }
     }
 
+    size_t Boolean::hash() const
+    {
+        return this->bool_value();
+    }
+
     Data* Boolean::get_class() const
     {
-        return GlobalScope::class_Boolean->copy();
+        return GlobalScope::current().class_Boolean->copy();
     }
 }
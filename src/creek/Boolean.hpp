@@ -48,6 +48,7 @@ namespace creek
         // Data* bit_xor(Data* other) override;
         // Data* bit_not() override;
         int cmp(Data* other) override;
+        size_t hash() const override;
 
         Data* get_class() const override;
 
@@ -1,243 +1,510 @@
 #include <creek/Bytecode.hpp>
 
-#include <creek/Endian.hpp>
+#include <algorithm>
+#include <cstring>
+#include <limits>
 
 
 namespace creek
 {
     Bytecode::Bytecode() :
-        m_ss(std::ios_base::in|std::ios_base::out|std::ios_base::ate)
+        m_data(m_buffer.data()),
+        m_size(0),
+        m_position(0),
+        m_good(true),
+        m_functions_base(0)
     {
 
     }
 
     Bytecode::Bytecode(const Bytecode& other) :
-        m_ss(std::ios_base::in|std::ios_base::out|std::ios_base::ate)
+        m_data(other.m_data),
+        m_size(other.m_size),
+        m_position(other.m_position),
+        m_good(other.m_good),
+        m_owner(other.m_owner),
+        m_functions(other.m_functions),
+        m_functions_base(other.m_functions_base)
+    {
+        if (!other.in_place())
+        {
+            m_buffer = other.m_buffer;
+            m_data = m_buffer.data();
+        }
+    }
+
+    Bytecode::Bytecode(Bytecode&& other) : Bytecode()
     {
-        write(other.m_ss.str());
+        *this = std::move(other);
+    }
+
+    Bytecode::Bytecode(const std::string& bytes) :
+        m_buffer(bytes),
+        m_data(m_buffer.data()),
+        m_size(m_buffer.size()),
+        m_position(0),
+        m_good(true),
+        m_functions_base(0)
+    {
+
     }
 
-    Bytecode::Bytecode(Bytecode&& other) :
-        m_ss(std::ios_base::in|std::ios_base::out|std::ios_base::ate)   //.m_ss.str(), std::ios_base::in|std::ios_base::out|std::ios_base::ate)
+    Bytecode::Bytecode(std::string&& bytes) :
+        m_buffer(std::move(bytes)),
+        m_data(m_buffer.data()),
+        m_size(m_buffer.size()),
+        m_position(0),
+        m_good(true),
+        m_functions_base(0)
     {
-        std::swap(m_ss, other.m_ss);
+
     }
 
-    Bytecode::Bytecode(const std::string& bytes)
-        :
-        m_ss(std::ios_base::in|std::ios_base::out|std::ios_base::ate)
+    Bytecode::Bytecode(const char* data, size_t size, const std::shared_ptr<const void>& owner) :
+        m_data(data),
+        m_size(size),
+        m_position(0),
+        m_good(true),
+        m_owner(owner),
+        m_functions_base(0)
     {
-        write(bytes);
+
     }
 
     /// @brief  `Bytecode` constructor.
-    Bytecode::Bytecode(const std::stringstream& ss) : Bytecode()
+    Bytecode::Bytecode(const std::stringstream& ss) : Bytecode(ss.str())
     {
-        m_ss.str(ss.str());
+
     }
 
     /// @brief  `Bytecode` constructor.
-    Bytecode::Bytecode(std::stringstream&& ss) : Bytecode()
+    Bytecode::Bytecode(std::stringstream&& ss) : Bytecode(ss.str())
+    {
+
+    }
+
+    Bytecode& Bytecode::operator= (const Bytecode& other)
+    {
+        if (this != &other)
+        {
+            *this = Bytecode(other);
+        }
+        return *this;
+    }
+
+    Bytecode& Bytecode::operator= (Bytecode&& other)
     {
-        m_ss.swap(ss);
+        if (this != &other)
+        {
+            bool in_place = other.in_place();
+            m_buffer = std::move(other.m_buffer);
+            m_data = in_place ? other.m_data : m_buffer.data();
+            m_size = other.m_size;
+            m_position = other.m_position;
+            m_good = other.m_good;
+            m_owner = std::move(other.m_owner);
+            m_functions = std::move(other.m_functions);
+            m_functions_base = other.m_functions_base;
+
+            other.m_buffer.clear();
+            other.m_data = other.m_buffer.data();
+            other.m_size = 0;
+            other.m_position = 0;
+            other.m_good = true;
+            other.m_functions_base = 0;
+        }
+        return *this;
     }
 
+
     std::string Bytecode::bytes() const
     {
-        return m_ss.str();
+        return std::string(m_data, m_size);
     }
 
     std::string Bytecode::bytes(unsigned pos, unsigned length) const
     {
-        return m_ss.str().substr(pos, length);
+        if (pos > m_size)
+            return std::string();
+        return std::string(m_data + pos, std::min<size_t>(length, m_size - pos));
+    }
+
+    const char* Bytecode::data() const
+    {
+        return m_data;
+    }
+
+    size_t Bytecode::size() const
+    {
+        return m_size;
+    }
+
+    const std::shared_ptr<const void>& Bytecode::owner() const
+    {
+        return m_owner;
+    }
+
+    Bytecode Bytecode::sub(size_t pos, size_t length) const
+    {
+        pos = std::min(pos, m_size);
+        length = std::min(length, m_size - pos);
+
+        if (in_place())
+        {
+            Bytecode part(m_data + pos, length, m_owner);
+            part.m_functions = m_functions;
+            part.m_functions_base = m_functions_base + pos;
+            return part;
+        }
+
+        Bytecode part(std::string(m_data + pos, length));
+        for (auto& function : functions())
+        {
+            if (function.begin >= pos && function.end <= pos + length)
+            {
+                part.add_function(function.begin - pos, function.end - pos, function.captures);
+            }
+        }
+        return part;
     }
 
     void Bytecode::write(const std::string& bytes)
     {
-        m_ss.write(&bytes.front(), bytes.size());
+        write(bytes.data(), bytes.size());
+    }
+
+    void Bytecode::write(const char* data, size_t count)
+    {
+        if (count > 0)
+            std::memcpy(grow(count), data, count);
+    }
+
+    void Bytecode::reserve(size_t count)
+    {
+        grow(0);
+        m_buffer.reserve(m_size + count);
+        m_data = m_buffer.data();
     }
 
     std::string Bytecode::read(unsigned count)
     {
-        std::string bytes(count, '\0');
-        m_ss.read(&bytes.front(), count);
-        if (!m_ss)
-            throw EmptyBytecode(count);
-        return bytes;
+        const char* bytes = take(count);
+        return std::string(bytes, count);
+    }
+
+    unsigned Bytecode::position()
+    {
+        return static_cast<unsigned>(m_position);
+    }
+
+    void Bytecode::skip(size_t count)
+    {
+        take(count);
+    }
+
+    void Bytecode::seek(size_t position)
+    {
+        if (position > m_size)
+        {
+            m_good = false;
+            throw EmptyBytecode(position);
+        }
+        m_position = position;
+    }
+
+    void Bytecode::add_function(size_t begin, size_t end, const std::vector<uint32_t>& captures)
+    {
+        // copy the table shared with other parts of the bytecode
+        if (!m_functions || m_functions.use_count() > 1)
+        {
+            auto functions = this->functions();
+            m_functions = std::make_shared< std::vector<Function> >(std::move(functions));
+            m_functions_base = 0;
+        }
+
+        // the bodies of nested functions are added before the outer one
+        Function function = { begin, end, captures };
+        auto i = std::upper_bound(m_functions->begin(), m_functions->end(), function, [](const Function& a, const Function& b) {
+            return a.begin < b.begin;
+        });
+        m_functions->insert(i, function);
+    }
+
+    std::vector<Bytecode::Function> Bytecode::functions() const
+    {
+        std::vector<Function> functions;
+        if (m_functions)
+        {
+            for (auto& function : *m_functions)
+            {
+                if (function.begin >= m_functions_base && function.end <= m_functions_base + m_size)
+                {
+                    functions.push_back({ function.begin - m_functions_base, function.end - m_functions_base, function.captures });
+                }
+            }
+        }
+        return functions;
+    }
+
+    void Bytecode::functions(std::vector<Function> functions)
+    {
+        m_functions = std::make_shared< std::vector<Function> >(std::move(functions));
+        m_functions_base = 0;
+    }
+
+    size_t Bytecode::function_end(size_t begin) const
+    {
+        const Function* function = find_function(begin);
+        return function ? function->end - m_functions_base : 0;
+    }
+
+    const std::vector<uint32_t>* Bytecode::function_captures(size_t begin) const
+    {
+        const Function* function = find_function(begin);
+        return function ? &function->captures : nullptr;
     }
 
     Bytecode& Bytecode::operator<< (const Bytecode& other)
     {
-        write(other.bytes());
+        write(other.m_data, other.m_size);
         return *this;
     }
 
     Bytecode& Bytecode::operator<< (int8_t value)
     {
-        write(Endian::sint8_to_bytes(value));
+        write_uint(static_cast<uint8_t>(value), 1);
         return *this;
     }
 
     Bytecode& Bytecode::operator<< (int16_t value)
     {
-        write(Endian::sint16_to_bytes(value));
+        write_uint(static_cast<uint16_t>(value), 2);
         return *this;
     }
 
     Bytecode& Bytecode::operator<< (int32_t value)
     {
-        write(Endian::sint32_to_bytes(value));
+        write_uint(static_cast<uint32_t>(value), 4);
         return *this;
     }
 
     Bytecode& Bytecode::operator<< (int64_t value)
     {
-        write(Endian::sint64_to_bytes(value));
+        write_uint(static_cast<uint64_t>(value), 8);
         return *this;
     }
 
     Bytecode& Bytecode::operator<< (uint8_t value)
     {
-        return *this << static_cast<int8_t>(value);
+        write_uint(value, 1);
+        return *this;
     }
 
     Bytecode& Bytecode::operator<< (uint16_t value)
     {
-        return *this << static_cast<int16_t>(value);
+        write_uint(value, 2);
+        return *this;
     }
 
     Bytecode& Bytecode::operator<< (uint32_t value)
     {
-        return *this << static_cast<int32_t>(value);
+        write_uint(value, 4);
+        return *this;
     }
 
     Bytecode& Bytecode::operator<< (uint64_t value)
     {
-        return *this << static_cast<int64_t>(value);
+        write_uint(value, 8);
+        return *this;
     }
 
     Bytecode& Bytecode::operator<< (float value)
     {
-        write(Endian::float32_to_bytes(value));
+        // TODO: Extend support to other floats standars.
+        static_assert(std::numeric_limits<float>::is_iec559, "Only IEC 559/IEEE 754 floating-points are supported");
+
+        uint32_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        write_uint(bits, 4);
         return *this;
     }
 
     Bytecode& Bytecode::operator<< (double value)
     {
-        write(Endian::float64_to_bytes(value));
+        // TODO: Extend support to other floats standars.
+        static_assert(std::numeric_limits<double>::is_iec559, "Only IEC 559/IEEE 754 floating-points are supported");
+
+        uint64_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        write_uint(bits, 8);
         return *this;
     }
 
     Bytecode& Bytecode::operator<< (bool value)
     {
-        write(Endian::sint8_to_bytes(value));
+        write_uint(value ? 1 : 0, 1);
         return *this;
     }
 
     Bytecode& Bytecode::operator<< (const std::string& value)
     {
-        *this << static_cast<int16_t>(value.size());
-        for(auto& c : value)
-        {
-            *this << static_cast<int8_t>(c);
-        }
+        write_uint(value.size(), 2);
+        write(value);
         return *this;
     }
 
     Bytecode& Bytecode::operator>> (int8_t& value)
     {
-        value = Endian::bytes_to_sint8(read(1));
+        value = static_cast<int8_t>(read_uint(1));
         return *this;
     }
 
     Bytecode& Bytecode::operator>> (int16_t& value)
     {
-        value = Endian::bytes_to_sint16(read(2));
+        value = static_cast<int16_t>(read_uint(2));
         return *this;
     }
 
     Bytecode& Bytecode::operator>> (int32_t& value)
     {
-        value = Endian::bytes_to_sint32(read(4));
+        value = static_cast<int32_t>(read_uint(4));
         return *this;
     }
 
     Bytecode& Bytecode::operator>> (int64_t& value)
     {
-        value = Endian::bytes_to_sint64(read(8));
+        value = static_cast<int64_t>(read_uint(8));
         return *this;
     }
 
     Bytecode& Bytecode::operator>> (uint8_t& value)
     {
-        int8_t svalue = 0;
-        *this >> svalue;
-        value = svalue;
+        value = static_cast<uint8_t>(read_uint(1));
         return *this;
     }
 
     Bytecode& Bytecode::operator>> (uint16_t& value)
     {
-        int16_t svalue = 0;
-        *this >> svalue;
-        value = svalue;
+        value = static_cast<uint16_t>(read_uint(2));
         return *this;
     }
 
     Bytecode& Bytecode::operator>> (uint32_t& value)
     {
-        int32_t svalue = 0;
-        *this >> svalue;
-        value = svalue;
+        value = static_cast<uint32_t>(read_uint(4));
         return *this;
     }
 
     Bytecode& Bytecode::operator>> (uint64_t& value)
     {
-        int64_t svalue = 0;
-        *this >> svalue;
-        value = svalue;
+        value = read_uint(8);
         return *this;
     }
 
     Bytecode& Bytecode::operator>> (float& value)
     {
-        value = Endian::bytes_to_float32(read(4));
+        uint32_t bits = static_cast<uint32_t>(read_uint(4));
+        std::memcpy(&value, &bits, sizeof(value));
         return *this;
     }
 
     Bytecode& Bytecode::operator>> (double& value)
     {
-        value = Endian::bytes_to_float32(read(8));
+        uint64_t bits = read_uint(8);
+        std::memcpy(&value, &bits, sizeof(value));
         return *this;
     }
 
     Bytecode& Bytecode::operator>> (bool& value)
     {
-        int8_t svalue = 0;
-        *this >> svalue;
-        value = svalue;
+        value = read_uint(1) != 0;
         return *this;
     }
 
     Bytecode& Bytecode::operator>> (std::string& value)
     {
-        int16_t size = 0;
-        *this >> size;
-        value.resize(size, '\0');
+        size_t size = static_cast<size_t>(read_uint(2));
+        const char* bytes = take(size);
+        value.assign(bytes, size);
+        return *this;
+    }
+
+    Bytecode::operator bool() const
+    {
+        return m_good;
+    }
+
+
+    bool Bytecode::in_place() const
+    {
+        return m_data != m_buffer.data();
+    }
 
-        for(int16_t i = 0; i < size; ++i)
+    char* Bytecode::grow(size_t count)
+    {
+        // reading in place: copy the bytes before writing
+        if (in_place())
         {
-            int8_t c = '\0';
-            *this >> c;
-            value[i] = static_cast<char>(c);
+            m_buffer.assign(m_data, m_size);
+            m_owner.reset();
         }
-        return *this;
+
+        m_buffer.resize(m_size + count);
+        m_data = m_buffer.data();
+        char* bytes = &m_buffer[m_size];
+        m_size += count;
+        return bytes;
     }
 
-    Bytecode::operator bool() const
+    const char* Bytecode::take(size_t count)
+    {
+        if (count > m_size - m_position)
+        {
+            m_good = false;
+            throw EmptyBytecode(count);
+        }
+
+        const char* bytes = m_data + m_position;
+        m_position += count;
+        return bytes;
+    }
+
+    const Bytecode::Function* Bytecode::find_function(size_t begin) const
+    {
+        if (!m_functions)
+        {
+            return nullptr;
+        }
+
+        size_t position = m_functions_base + begin;
+        auto i = std::lower_bound(m_functions->begin(), m_functions->end(), position, [](const Function& a, size_t b) {
+            return a.begin < b;
+        });
+        if (i == m_functions->end() || i->begin != position || i->end > m_functions_base + m_size)
+        {
+            return nullptr;
+        }
+        return &*i;
+    }
+
+    void Bytecode::write_uint(uint64_t value, size_t count)
+    {
+        char* bytes = grow(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            bytes[i] = static_cast<char>(value >> (8 * i));
+        }
+    }
+
+    uint64_t Bytecode::read_uint(size_t count)
     {
-        return m_ss.good();
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(take(count));
+        uint64_t value = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+        }
+        return value;
     }
 }
 
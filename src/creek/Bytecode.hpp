@@ -1,6 +1,11 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <sstream>
+#include <string>
+#include <vector>
 
 #include <creek/api_mode.hpp>
 #include <creek/Exception.hpp>
@@ -9,9 +14,25 @@
 namespace creek
 {
     /// @brief  Portable bynary storage (FIFO).
+    /// Values are appended in little-endian order to a contiguous growable
+    /// buffer, and extracted straight from it, advancing a read position.
+    /// A bytecode can also read from memory it does not own (see the
+    /// `const char*` constructor); writing to it copies that memory first.
+    /// Besides the bytes, a bytecode keeps a table with the extent of the
+    /// function bodies it contains, so they can be skipped without reading,
+    /// and the variables each function captures.
     class CREEK_API Bytecode
     {
     public:
+        /// @brief  Bytes of a function body.
+        struct Function
+        {
+            size_t begin;                   ///< Position of the first byte.
+            size_t end;                     ///< Position after the last byte.
+            std::vector<uint32_t> captures; ///< IDs of the var names captured by the function.
+        };
+
+
         /// @brief  `Bytecode` constructor.
         Bytecode();
 
@@ -24,6 +45,18 @@ namespace creek
         /// @brief  `Bytecode` constructor.
         Bytecode(const std::string& bytes);
 
+        /// @brief  `Bytecode` constructor.
+        Bytecode(std::string&& bytes);
+
+        /// @brief  `Bytecode` constructor.
+        /// Reads the bytes in place, without copying them. Copies and parts
+        /// (see `sub`) of this bytecode read in place too.
+        /// @param  data    First byte.
+        /// @param  size    Number of bytes.
+        /// @param  owner   Object keeping the bytes alive; if null, the
+        ///                 bytes must outlive this bytecode and its copies.
+        Bytecode(const char* data, size_t size, const std::shared_ptr<const void>& owner = nullptr);
+
         /// @brief  `Bytecode` constructor.
         Bytecode(const std::stringstream& ss);
 
@@ -31,9 +64,33 @@ namespace creek
         Bytecode(std::stringstream&& ss);
 
 
+        /// @brief  Copy another bytecode.
+        Bytecode& operator= (const Bytecode& other);
+
+        /// @brief  Move another bytecode.
+        Bytecode& operator= (Bytecode&& other);
+
+
         /// @brief  Get bytes.
         std::string bytes() const;
 
+        /// @brief  Get the first byte, without copying.
+        const char* data() const;
+
+        /// @brief  Get the number of bytes.
+        size_t size() const;
+
+        /// @brief  Get the object keeping the bytes read in place alive.
+        /// @return Null if the bytes are owned by this bytecode, or if they
+        ///         are read in place without owner.
+        const std::shared_ptr<const void>& owner() const;
+
+        /// @brief  Get a part of this bytecode, with its function bodies.
+        /// Copies the bytes, unless they are read in place.
+        /// @param  pos     Initial byte.
+        /// @param  length  Number of bytes.
+        Bytecode sub(size_t pos, size_t length) const;
+
         /// @brief  Get bytes.
         /// @param  pos Initial byte.
         /// @param  length Number of bytes to get.
@@ -43,10 +100,57 @@ namespace creek
         /// @brief  Insert bytes at the end of the bytecode.
         void write(const std::string& bytes);
 
+        /// @brief  Insert bytes at the end of the bytecode.
+        /// @param  data    First byte.
+        /// @param  count   Number of bytes.
+        void write(const char* data, size_t count);
+
+        /// @brief  Reserve memory for `count` more bytes.
+        void reserve(size_t count);
+
         /// @brief  Extract bytes from the beginning of the bytecode.
         /// @param  count Number of bytes to read.
         std::string read(unsigned count);
 
+        /// @brief  Get the number of bytes already extracted.
+        unsigned position();
+
+        /// @brief  Skip bytes from the beginning of the bytecode.
+        /// @param  count   Number of bytes to skip.
+        void skip(size_t count);
+
+        /// @brief  Set the number of bytes already extracted.
+        /// @param  position    Next byte to extract.
+        void seek(size_t position);
+
+
+        /// @brief  Record the bytes of a function body.
+        /// Called by the writers after inserting the body of a function
+        /// whose variables are resolved.
+        /// @param  begin       Position of the first byte.
+        /// @param  end         Position after the last byte.
+        /// @param  captures    IDs of the var names captured by the function,
+        ///                     in the order of its closure environment.
+        void add_function(size_t begin, size_t end, const std::vector<uint32_t>& captures);
+
+        /// @brief  Get the function bodies, sorted by position.
+        std::vector<Function> functions() const;
+
+        /// @brief  Set the function bodies.
+        /// @param  functions   Function bodies, sorted by position.
+        void functions(std::vector<Function> functions);
+
+        /// @brief  Find the end of the function body starting at `begin`.
+        /// @return Position after the last byte of the body, or 0 if no body
+        ///         starts at `begin`.
+        size_t function_end(size_t begin) const;
+
+        /// @brief  Get the variables captured by the function whose body
+        /// starts at `begin`.
+        /// @return IDs of the var names, or `nullptr` if no body starts at
+        ///         `begin`.
+        const std::vector<uint32_t>* function_captures(size_t begin) const;
+
 
         /// @brief  Append another bytecode.
         Bytecode& operator<< (const Bytecode& other);
@@ -131,7 +235,35 @@ namespace creek
 
 
     private:
-        std::stringstream m_ss;
+        /// @brief  Make room for `count` more bytes at the end.
+        /// @return Pointer to the new bytes.
+        char* grow(size_t count);
+
+        /// @brief  Check there are `count` bytes left to extract.
+        /// @return Pointer to the next byte.
+        const char* take(size_t count);
+
+        /// @brief  Find the function whose body starts at `begin`.
+        /// @return Function in `m_functions`, or `nullptr`.
+        const Function* find_function(size_t begin) const;
+
+        /// @brief  Insert an unsigned integer of `count` bytes.
+        void write_uint(uint64_t value, size_t count);
+
+        /// @brief  Extract an unsigned integer of `count` bytes.
+        uint64_t read_uint(size_t count);
+
+        /// @brief  Check if the bytes are read in place.
+        bool in_place() const;
+
+        std::string m_buffer;   ///< Owned bytes; unused while reading in place.
+        const char* m_data;     ///< First byte; points to `m_buffer` or to the memory read in place.
+        size_t m_size;          ///< Number of bytes.
+        size_t m_position;      ///< Number of bytes already extracted.
+        bool m_good;            ///< Whether no extraction has failed.
+        std::shared_ptr<const void> m_owner;    ///< Keeps the memory read in place alive.
+        std::shared_ptr< std::vector<Function> > m_functions;   ///< Function bodies, shared by the parts of a bytecode.
+        size_t m_functions_base;    ///< Position of the first byte in `m_functions`.
     };
 }
 
@@ -0,0 +1,159 @@
+#include <creek/BytecodeCache.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+
+#include <creek/BytecodeInterpreter.hpp>
+#include <creek/Compiler.hpp>
+#include <creek/Exception.hpp>
+#include <creek/Expression.hpp>
+#include <creek/Interpreter.hpp>
+#include <creek/utility.hpp>
+#include <creek/VirtualMachine.hpp>
+
+#ifdef CREEK_WINDOWS
+# include <process.h>
+#else
+# include <unistd.h>
+#endif
+
+
+namespace creek
+{
+    const std::string BytecodeCache::directory_variable = "CREEK_CACHE_DIR";
+    const std::string BytecodeCache::extension = ".creekb";
+
+
+    namespace
+    {
+        // read a whole file
+        std::string read_source(const std::string& path)
+        {
+            std::ifstream file(path, std::ios_base::binary);
+            if (file.fail())
+            {
+                throw Exception("Can't open source file");
+            }
+
+            std::stringstream code;
+            code << file.rdbuf();
+            return code.str();
+        }
+
+        // unique suffix for the temporary files of this process
+        std::string process_suffix()
+        {
+            #ifdef CREEK_WINDOWS
+                return int_to_string(_getpid());
+            #else
+                return int_to_string(getpid());
+            #endif
+        }
+    }
+
+
+    /// @brief  `BytecodeCache` constructor.
+    BytecodeCache::BytecodeCache()
+    {
+        const char* directory = std::getenv(directory_variable.c_str());
+        if (directory)
+        {
+            m_directory = directory;
+        }
+    }
+
+    /// @brief  `BytecodeCache` constructor.
+    /// @param  directory   Cache directory.
+    BytecodeCache::BytecodeCache(const std::string& directory) :
+        m_directory(directory)
+    {
+
+    }
+
+
+    const std::string& BytecodeCache::directory() const
+    {
+        return m_directory;
+    }
+
+    std::string BytecodeCache::bytecode_path(const std::string& path) const
+    {
+        size_t name_begin = path.find_last_of("/\\");
+        name_begin = name_begin == std::string::npos ? 0 : name_begin + 1;
+        size_t name_end = path.find_last_of('.');
+        if (name_end == std::string::npos || name_end < name_begin)
+        {
+            name_end = path.size();
+        }
+
+        // next to the source
+        if (m_directory.empty())
+        {
+            return path.substr(0, name_end) + extension;
+        }
+
+        // in the cache directory; sources with the same name in different
+        // directories are told apart by the hash of their path
+        std::stringstream cache_path;
+        cache_path << m_directory;
+        if (m_directory.back() != '/' && m_directory.back() != '\\')
+        {
+            cache_path << '/';
+        }
+        cache_path << path.substr(name_begin, name_end - name_begin) << '-'
+                   << std::hex << std::setw(16) << std::setfill('0') << BytecodeInterpreter::source_hash(path)
+                   << extension;
+        return cache_path.str();
+    }
+
+    Expression* BytecodeCache::load_file(const std::string& path)
+    {
+        auto code = read_source(path);
+        auto source_hash = BytecodeInterpreter::source_hash(code);
+        auto cache_path = bytecode_path(path);
+
+        // cached bytecode; missing, stale and invalid files are replaced
+        BytecodeInterpreter bytecode_interpreter;
+        try
+        {
+            return bytecode_interpreter.load_file(cache_path, source_hash);
+        }
+        catch (const Exception&)
+        {
+
+        }
+
+        // interpret the source
+        Interpreter interpreter;
+        std::unique_ptr<Expression> program(interpreter.load_code(code));
+
+        // write to a temporary file and rename it, so other processes never
+        // read a partial file
+        auto temp_path = cache_path + "." + process_suffix() + ".tmp";
+        try
+        {
+            bytecode_interpreter.save_file(temp_path, program.get(), source_hash);
+            if (std::rename(temp_path.c_str(), cache_path.c_str()) != 0)
+            {
+                // Windows does not replace existing files
+                std::remove(cache_path.c_str());
+                if (std::rename(temp_path.c_str(), cache_path.c_str()) != 0)
+                {
+                    std::remove(temp_path.c_str());
+                }
+            }
+        }
+        catch (const Exception&)
+        {
+            std::remove(temp_path.c_str());
+        }
+
+        // the same form as the programs read from the bytecode files
+        Compiler compiler;
+        return new ExprProgram(compiler.compile(program.get()));
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <creek/api_mode.hpp>
+
+
+namespace creek
+{
+    class Expression;
+
+
+    /// @brief  Cache of compiled source files.
+    /// A source file is compiled once to a bytecode file that stores the
+    /// hash of the source; later loads read the bytecode file instead while
+    /// the source keeps the same hash. Bytecode files are written next to
+    /// the source (`name.creekb`), or to the cache directory if set.
+    class CREEK_API BytecodeCache
+    {
+    public:
+        /// @brief  Environment variable with the default cache directory.
+        static const std::string directory_variable;
+
+        /// @brief  Extension of the bytecode files.
+        static const std::string extension;
+
+
+        /// @brief  `BytecodeCache` constructor.
+        /// The cache directory is read from `directory_variable`.
+        BytecodeCache();
+
+        /// @brief  `BytecodeCache` constructor.
+        /// @param  directory   Cache directory; empty to write the
+        ///                     bytecode files next to the sources.
+        BytecodeCache(const std::string& directory);
+
+
+        /// @brief  Get the cache directory.
+        const std::string& directory() const;
+
+        /// @brief  Get the path of the bytecode file of a source file.
+        /// @param  path        Path to the source file.
+        std::string bytecode_path(const std::string& path) const;
+
+        /// @brief  Interpret a source file.
+        /// The cached bytecode file is used if it matches the source;
+        /// otherwise the source is interpreted and the bytecode file is
+        /// written. Failing to write it is not an error.
+        /// Either way the program is compiled for the virtual machine.
+        /// @param  path        Path to the source file.
+        Expression* load_file(const std::string& path);
+
+
+    private:
+        std::string m_directory;
+    };
+}
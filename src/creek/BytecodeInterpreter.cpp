@@ -1,7 +1,10 @@
 #include <creek/BytecodeInterpreter.hpp>
 
 #include <fstream>
+#include <utility>
+#include <vector>
 
+#include <creek/Compiler.hpp>
 #include <creek/Expression.hpp>
 #include <creek/Expression_Arithmetic.hpp>
 #include <creek/Expression_DataTypes.hpp>
@@ -13,13 +16,41 @@
 #include <creek/Expression_DynLoad.hpp>
 #include <creek/Expression_General.hpp>
 #include <creek/Expression_Variable.hpp>
+#include <creek/MappedFile.hpp>
 #include <creek/OpCode.hpp>
 #include <creek/utility.hpp>
+#include <creek/VirtualMachine.hpp>
 #include <iostream> // TODO: remove
 
 namespace creek
 {
-    const std::string BytecodeInterpreter::magic_number = {0x00, 0x11, 0x22, 'C', 'R', 'E', 'E', 'K'};
+    const std::string BytecodeInterpreter::magic_number = {0x00, 0x11, 0x22, 'C', 'R', 'E', 'E', 'B'};
+    const uint16_t BytecodeInterpreter::version = 2;
+
+
+    namespace
+    {
+        // size of the header before the sections
+        size_t header_size(size_t section_count)
+        {
+            return BytecodeInterpreter::magic_number.size() + 2 + 2 + section_count * 9;
+        }
+
+        // insert a string with a 32-bit size
+        void write_string(Bytecode& bytecode, const std::string& value)
+        {
+            bytecode << static_cast<uint32_t>(value.size());
+            bytecode.write(value);
+        }
+
+        // extract a string with a 32-bit size
+        std::string read_string(Bytecode& bytecode)
+        {
+            uint32_t size = 0;
+            bytecode >> size;
+            return bytecode.read(size);
+        }
+    }
 
 
     /// @brief  `Interpreter` constructor..
@@ -34,36 +65,16 @@ namespace creek
     /// @param  program     Expression to save.
     void BytecodeInterpreter::save_file(const std::string& path, const Expression* program)
     {
-        Bytecode bytecode;
-
-        // translate
-        VarNameMap var_name_map;
-        auto program_bytecode = program->bytecode(var_name_map);
-
-        // magic
-        bytecode.write(magic_number);
-
-        // pointer length in bytes
-        bytecode << static_cast<uint8_t>(sizeof(intptr_t));
-
-        // var name map
-        bytecode << static_cast<uint32_t>(var_name_map.map().size());
-        for (auto& i : var_name_map.map())
-        {
-            bytecode << i.second << i.first;
-        }
-
-        // program bytecode
-        bytecode << program_bytecode;
+        save(path, program, nullptr);
+    }
 
-        // file
-        std::ofstream file(path, std::ios_base::binary|std::ios_base::trunc);
-        if (file.fail())
-        {
-            throw Exception("Can't open output file");
-        }
-        auto bytes = bytecode.bytes();
-        file.write(bytes.c_str(), bytes.size());
+    /// Compile to bytecode file, storing the hash of its source.
+    /// @param  path        Path to the bytecode file.
+    /// @param  program     Expression to save.
+    /// @param  source_hash Hash of the source code of the program.
+    void BytecodeInterpreter::save_file(const std::string& path, const Expression* program, uint64_t source_hash)
+    {
+        save(path, program, &source_hash);
     }
 
     /// Interpret a source file.
@@ -72,94 +83,311 @@ namespace creek
     {
         auto bytecode = load(path);
 
-        auto expression = parse(bytecode);
+        auto expression = load_bytecode(bytecode);
 
         return expression;
     }
 
+    /// Interpret a bytecode file compiled from a given source.
+    /// @param  path        Path to the bytecode file.
+    /// @param  source_hash Hash of the source code.
+    Expression* BytecodeInterpreter::load_file(const std::string& path, uint64_t source_hash)
+    {
+        auto bytecode = load(path);
+
+        auto var_name_map = parse_header(bytecode, &source_hash);
+
+        Compiler compiler;
+        auto program = compiler.compile(bytecode, var_name_map);
+
+        return new ExprProgram(program);
+    }
+
     /// Interpret a bytecode.
     /// @param  bytecode    Bytecode.
     Expression* BytecodeInterpreter::load_bytecode(Bytecode& bytecode)
     {
-        auto expression = parse(bytecode);
+        auto var_name_map = parse_header(bytecode);
 
-        return expression;
+        Compiler compiler;
+        auto program = compiler.compile(bytecode, var_name_map);
+
+        return new ExprProgram(program);
     }
 
-    Bytecode BytecodeInterpreter::load(const std::string& path)
+    /// Hash a source code (64-bit FNV-1a).
+    /// @param  code        Source code.
+    uint64_t BytecodeInterpreter::source_hash(const std::string& code)
     {
-        // open file
-        std::ifstream file(path, std::ios::binary);
-        if (file.fail())
+        uint64_t hash = 0xcbf29ce484222325;
+        for (unsigned char c : code)
         {
-            throw Exception("Can't open bytecode file");
+            hash ^= c;
+            hash *= 0x100000001b3;
+        }
+        return hash;
+    }
+
+    void BytecodeInterpreter::save(const std::string& path, const Expression* program, const uint64_t* source_hash)
+    {
+        // translate
+        VarNameMap var_name_map;
+        Bytecode code;
+        program->bytecode(code, var_name_map);
+
+        std::vector< std::pair<Section, Bytecode> > sections(5);
+
+        // var names, by ID
+        std::vector<const VarName::Name*> names(var_name_map.map().size());
+        for (auto& i : var_name_map.map())
+        {
+            names[i.second] = &i.first;
+        }
+        sections[0].first = Section::names;
+        sections[0].second << static_cast<uint32_t>(names.size());
+        for (auto name : names)
+        {
+            write_string(sections[0].second, *name);
+        }
+
+        // string constants
+        sections[1].first = Section::strings;
+        sections[1].second << static_cast<uint32_t>(var_name_map.strings().size());
+        for (auto& value : var_name_map.strings())
+        {
+            write_string(sections[1].second, value);
+        }
+
+        // number constants
+        sections[2].first = Section::numbers;
+        sections[2].second << static_cast<uint32_t>(var_name_map.numbers().size());
+        for (auto value : var_name_map.numbers())
+        {
+            sections[2].second << value;
+        }
+
+        // function bodies, relative to the code
+        auto functions = code.functions();
+        sections[3].first = Section::functions;
+        sections[3].second << static_cast<uint32_t>(functions.size());
+        for (auto& function : functions)
+        {
+            sections[3].second << static_cast<uint32_t>(function.begin) << static_cast<uint32_t>(function.end);
+            sections[3].second << static_cast<uint32_t>(function.captures.size());
+            for (auto id : function.captures)
+            {
+                sections[3].second << id;
+            }
         }
 
-        // read whole file
-        std::stringstream ss;
-        std::copy(std::istreambuf_iterator<char>(file),
-                  std::istreambuf_iterator<char>(),
-                  std::ostreambuf_iterator<char>(ss));
+        // code
+        sections[4].first = Section::code;
+        sections[4].second = std::move(code);
+
+        // source hash
+        if (source_hash)
+        {
+            sections.emplace_back(Section::source, Bytecode());
+            sections.back().second << *source_hash;
+        }
 
-        // close file
-        file.close();
+        // header and section table
+        Bytecode header;
+        header.write(magic_number);
+        header << version;
+        header << static_cast<uint16_t>(sections.size());
+        size_t offset = header_size(sections.size());
+        for (auto& section : sections)
+        {
+            header << static_cast<uint8_t>(section.first);
+            header << static_cast<uint32_t>(offset) << static_cast<uint32_t>(section.second.size());
+            offset += section.second.size();
+        }
 
-        return Bytecode(ss);
+        // file
+        std::ofstream file(path, std::ios_base::binary|std::ios_base::trunc);
+        if (file.fail())
+        {
+            throw Exception("Can't open output file");
+        }
+        file.write(header.data(), header.size());
+        for (auto& section : sections)
+        {
+            file.write(section.second.data(), section.second.size());
+        }
     }
 
-    Expression* BytecodeInterpreter::parse(Bytecode& bytecode)
+    Bytecode BytecodeInterpreter::load(const std::string& path)
+    {
+        // map file; the bytecode keeps it alive
+        auto file = std::make_shared<MappedFile>(path);
+        if (!file->is_open())
+        {
+            throw Exception("Can't open bytecode file");
+        }
+
+        return Bytecode(file->data(), file->size(), file);
+    }
+
+    std::shared_ptr<VarNameMap> BytecodeInterpreter::parse_header(Bytecode& bytecode, const uint64_t* source_hash)
     {
-        // magic number
+        // magic number and version
         std::string magic = bytecode.read(magic_number.size());
         if (magic != magic_number)
         {
             throw InvalidBytecode();
         }
 
-        // pointer length in bytes
-        uint8_t ptr_len = 0;
-        bytecode >> ptr_len;
-        if (ptr_len != sizeof(intptr_t))
+        uint16_t file_version = 0;
+        bytecode >> file_version;
+        if (file_version != version)
         {
-            std::string msg = std::string("Bytecode architecture is ") + int_to_string(ptr_len * 8) + std::string("-bit, using ") + int_to_string(sizeof(intptr_t) * 8);
+            std::string msg = std::string("Bytecode version is ") + int_to_string(file_version) + std::string(", using ") + int_to_string(version);
             throw Exception(msg);
         }
 
-        // var name map
-        uint32_t nvar = 0;
-        bytecode >> nvar;
-        VarNameMap var_name_map;
-        for (uint32_t i = 0; i < nvar; i += 1)
+        // section table; missing sections are empty
+        uint16_t section_count = 0;
+        bytecode >> section_count;
+        std::map<Section, Bytecode> sections;
+        size_t code_begin = bytecode.size();
+        for (uint16_t i = 0; i < section_count; i += 1)
+        {
+            uint8_t kind = 0;
+            uint32_t offset = 0;
+            uint32_t size = 0;
+            bytecode >> kind >> offset >> size;
+            if (offset < header_size(section_count) || offset > bytecode.size() || size > bytecode.size() - offset)
+            {
+                throw InvalidBytecode();
+            }
+
+            if (static_cast<Section>(kind) == Section::code)
+            {
+                code_begin = offset;
+            }
+            sections[static_cast<Section>(kind)] = bytecode.sub(offset, size);
+        }
+        if (code_begin == bytecode.size())
+        {
+            throw InvalidBytecode();
+        }
+
+        // source hash, checked before reading anything else
+        if (source_hash)
+        {
+            Bytecode& source = sections[Section::source];
+            if (source.size() < 8)
+            {
+                throw StaleBytecode();
+            }
+            uint64_t file_source_hash = 0;
+            source >> file_source_hash;
+            if (file_source_hash != *source_hash)
+            {
+                throw StaleBytecode();
+            }
+        }
+
+        auto var_name_map = std::make_shared<VarNameMap>();
+
+        // var names
+        Bytecode& names = sections[Section::names];
+        uint32_t name_count = 0;
+        if (names.size() > 0)
+        {
+            names >> name_count;
+        }
+        for (uint32_t i = 0; i < name_count; i += 1)
+        {
+            var_name_map->register_name(i, read_string(names));
+        }
+
+        // string constants
+        Bytecode& strings = sections[Section::strings];
+        uint32_t string_count = 0;
+        if (strings.size() > 0)
+        {
+            strings >> string_count;
+        }
+        for (uint32_t i = 0; i < string_count; i += 1)
+        {
+            if (var_name_map->id_from_string(read_string(strings)) != i)
+            {
+                throw InvalidBytecode();
+            }
+        }
+
+        // number constants
+        Bytecode& numbers = sections[Section::numbers];
+        uint32_t number_count = 0;
+        if (numbers.size() > 0)
+        {
+            numbers >> number_count;
+        }
+        for (uint32_t i = 0; i < number_count; i += 1)
+        {
+            double value = 0.0;
+            numbers >> value;
+            if (var_name_map->id_from_number(value) != i)
+            {
+                throw InvalidBytecode();
+            }
+        }
+
+        // function bodies, relative to the code
+        Bytecode& function_table = sections[Section::functions];
+        uint32_t function_count = 0;
+        if (function_table.size() > 0)
         {
-            VarName::Id id = 0;
-            VarName::Name name;
-            bytecode >> id >> name;
-            var_name_map.register_name(id, name);
+            function_table >> function_count;
+        }
+        if (function_count > function_table.size() / 12)
+        {
+            throw InvalidBytecode();
+        }
+        std::vector<Bytecode::Function> functions(function_count);
+        for (auto& function : functions)
+        {
+            uint32_t begin = 0;
+            uint32_t end = 0;
+            uint32_t capture_count = 0;
+            function_table >> begin >> end >> capture_count;
+            if (begin > end || capture_count > function_table.size() / 4)
+            {
+                throw InvalidBytecode();
+            }
+            function.begin = code_begin + begin;
+            function.end = code_begin + end;
+
+            function.captures.resize(capture_count);
+            for (auto& id : function.captures)
+            {
+                function_table >> id;
+                if (id >= name_count)
+                {
+                    throw InvalidBytecode();
+                }
+            }
         }
+        bytecode.functions(std::move(functions));
 
-        // parse each expression
-        auto e = parse_expression(bytecode, var_name_map);
-        return e ? e : new ExprVoid();
-
-        // uint32_t nexpr = 0;
-        // bytecode >> nexpr;
-        // std::vector<Expression*> expressions(nexpr);
-        // for (uint32_t i = 0; i < nexpr; i += 1)
-        // {
-        //     if (auto e = parse_expression(bytecode, var_name_map))
-        //     {
-        //         expressions.push_back(e);
-        //     }
-        // }
-
-        // return expressions;
+        // position at the code
+        bytecode.seek(code_begin);
+
+        return var_name_map;
     }
 
     Expression* BytecodeInterpreter::parse_expression(Bytecode& bytecode, const VarNameMap& var_name_map)
     {
         uint8_t op_code = static_cast<uint8_t>(OpCode::nop);
         bytecode >> op_code;
-        switch (static_cast<OpCode>(op_code))
+        return parse_operation(static_cast<OpCode>(op_code), bytecode, var_name_map);
+    }
+
+    Expression* BytecodeInterpreter::parse_operation(OpCode op_code, Bytecode& bytecode, const VarNameMap& var_name_map)
+    {
+        switch (op_code)
         {
             // debug
             case OpCode::nop:                       //< 0x00
@@ -342,14 +570,12 @@ namespace creek
             }
             case OpCode::data_number:               //< 0x33
             {
-                Number::Value value = 0.0f;
-                bytecode >> value;
+                Number::Value value = parse_number(bytecode, var_name_map);
                 return new ExprNumber(value);
             }
             case OpCode::data_string:               //< 0x34
             {
-                String::Value value;
-                bytecode >> value;
+                String::Value value = parse_string(bytecode, var_name_map);
                 return new ExprString(value);
             }
             case OpCode::data_identifier:           //< 0x35
@@ -681,11 +907,8 @@ namespace creek
                 bool is_variadic = false;
                 bytecode >> is_variadic;
 
-                std::string library_path;
-                bytecode >> library_path;
-
-                std::string func_name;
-                bytecode >> func_name;
+                std::string library_path = parse_string(bytecode, var_name_map);
+                std::string func_name = parse_string(bytecode, var_name_map);
 
                 return new ExprDynFunc(arg_names, is_variadic, library_path, func_name);
             }
@@ -725,8 +948,7 @@ namespace creek
                     static_defs.emplace_back(id);
                 }
 
-                std::string library_path;
-                bytecode >> library_path;
+                std::string library_path = parse_string(bytecode, var_name_map);
 
                 return new ExprDynClass(id, method_defs, static_defs, library_path);
             }
@@ -742,16 +964,35 @@ namespace creek
 
     VarName BytecodeInterpreter::parse_var_name(Bytecode& bytecode, const VarNameMap& var_name_map)
     {
-        VarName::Id local_id;
+        VarNameMap::Id local_id = 0;
         bytecode >> local_id;
 
         VarName::Id global_id = var_name_map.global_from_local(local_id);
         return VarName::from_id(global_id);
     }
 
+    std::string BytecodeInterpreter::parse_string(Bytecode& bytecode, const VarNameMap& var_name_map)
+    {
+        VarNameMap::Id id = 0;
+        bytecode >> id;
+        return var_name_map.string_from_id(id);
+    }
+
+    double BytecodeInterpreter::parse_number(Bytecode& bytecode, const VarNameMap& var_name_map)
+    {
+        VarNameMap::Id id = 0;
+        bytecode >> id;
+        return var_name_map.number_from_id(id);
+    }
+
 
     InvalidBytecode::InvalidBytecode() : Exception("Invalid bytecode")
     {
 
     }
+
+    StaleBytecode::StaleBytecode() : Exception("Bytecode compiled from a different source")
+    {
+
+    }
 }
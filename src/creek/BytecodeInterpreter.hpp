@@ -1,12 +1,15 @@
 #pragma once
 
+#include <cstdint>
 #include <map>
+#include <memory>
 #include <regex>
 #include <set>
 #include <string>
 
 #include <creek/api_mode.hpp>
 #include <creek/Bytecode.hpp>
+#include <creek/OpCode.hpp>
 #include <creek/VarNameMap.hpp>
 
 
@@ -16,12 +19,44 @@ namespace creek
 
 
     /// Bytecode interpreter.
+    /// Bytecode files start with the `magic_number` and the `version`
+    /// (uint16), followed by the number of sections (uint16) and, for each
+    /// section, its kind (uint8), and its offset from the beginning of the
+    /// file and size (uint32). Integers are little-endian, and strings are
+    /// stored as a size (uint32) plus the bytes. The sections are:
+    /// - `names`: count (uint32) and var names, by ID.
+    /// - `strings`: count (uint32) and string constants, by ID.
+    /// - `numbers`: count (uint32) and number constants (float64), by ID.
+    /// - `functions`: count (uint32) and, for each function body, its
+    ///   first and last byte (uint32) relative to the code, and the count
+    ///   (uint32) and IDs (uint32) of the var names it captures; sorted by
+    ///   first byte. Only functions with resolved variables are listed.
+    /// - `code`: op-code tree of the program; var names and constants are
+    ///   stored as IDs (uint32).
+    /// - `source`: hash (uint64) of the source code the program was
+    ///   compiled from; optional.
     class CREEK_API BytecodeInterpreter
     {
     public:
+        /// @brief  Section of a bytecode file.
+        enum class Section : uint8_t
+        {
+            names       = 0x01,     ///< Var names.
+            strings     = 0x02,     ///< String constants.
+            numbers     = 0x03,     ///< Number constants.
+            functions   = 0x04,     ///< Function body table.
+            code        = 0x05,     ///< Op-code tree.
+            source      = 0x06,     ///< Hash of the source code.
+        };
+
+
         /// @brief  Bytecode header.
         static const std::string magic_number;
 
+        /// @brief  Version of the bytecode format.
+        /// Files of other versions are rejected.
+        static const uint16_t version;
+
 
         /// @brief  `Interpreter` constructor.
         BytecodeInterpreter();
@@ -32,26 +67,63 @@ namespace creek
         /// @param  program     Expression to save.
         void save_file(const std::string& path, const Expression* program);
 
+        /// @brief  Compile to bytecode file, storing the hash of its source.
+        /// @param  path        Path to the bytecode file.
+        /// @param  program     Expression to save.
+        /// @param  source_hash Hash of the source code of the program.
+        void save_file(const std::string& path, const Expression* program, uint64_t source_hash);
+
         /// @brief  Interpret a bytecode file.
+        /// The program is compiled for the virtual machine. The file is
+        /// mapped in memory, and the function bodies are read from it on
+        /// their first call.
         /// @param  path        Path to the bytecode file.
         Expression* load_file(const std::string& path);
 
+        /// @brief  Interpret a bytecode file compiled from a given source.
+        /// `StaleBytecode` is thrown if the file does not store the same
+        /// source hash.
+        /// @param  path        Path to the bytecode file.
+        /// @param  source_hash Hash of the source code.
+        Expression* load_file(const std::string& path, uint64_t source_hash);
+
         /// @brief  Interpret a bytecode.
+        /// The program is compiled for the virtual machine.
         /// @param  bytecode    Bytecode.
         Expression* load_bytecode(Bytecode& bytecode);
 
 
+        /// @brief  Hash a source code (64-bit FNV-1a).
+        /// @param  code        Source code.
+        static uint64_t source_hash(const std::string& code);
+
+
     private:
+        friend class Compiler;
+
+        void save(const std::string& path, const Expression* program, const uint64_t* source_hash);
         Bytecode load(const std::string& path);
-        Expression* parse(Bytecode& bytecode);
+        std::shared_ptr<VarNameMap> parse_header(Bytecode& bytecode, const uint64_t* source_hash = nullptr);
         Expression* parse_expression(Bytecode& bytecode, const VarNameMap& var_name_map);
+        Expression* parse_operation(OpCode op_code, Bytecode& bytecode, const VarNameMap& var_name_map);
         VarName parse_var_name(Bytecode& bytecode, const VarNameMap& var_name_map);
+        std::string parse_string(Bytecode& bytecode, const VarNameMap& var_name_map);
+        double parse_number(Bytecode& bytecode, const VarNameMap& var_name_map);
     };
 
 
-    class InvalidBytecode : Exception
+    /// Bytecode with a wrong format.
+    class CREEK_API InvalidBytecode : public Exception
     {
     public:
         InvalidBytecode();
     };
+
+
+    /// Bytecode compiled from a different source.
+    class CREEK_API StaleBytecode : public Exception
+    {
+    public:
+        StaleBytecode();
+    };
 }
@@ -10,7 +10,7 @@ namespace creek
 {
     // `CFunction` constructor.
     // @param  value   CFunction value.
-    CFunction::CFunction(const Value& value) : m_value(value)
+    CFunction::CFunction(const Value& value) : Data(DataType::cfunction), m_value(value)
     {
 
     }
@@ -59,8 +59,9 @@ namespace creek
 
     int CFunction::cmp(Data* other)
     {
-        if (auto other_cfunction = dynamic_cast<CFunction*>(other))
+        if (other->type() == DataType::cfunction)
         {
+            auto other_cfunction = static_cast<CFunction*>(other);
             return m_value == other_cfunction->m_value;
         }
         else
@@ -0,0 +1,839 @@
+#include <creek/Compiler.hpp>
+
+#include <cstdint>
+#include <memory>
+
+#include <creek/Boolean.hpp>
+#include <creek/BytecodeInterpreter.hpp>
+#include <creek/Exception.hpp>
+#include <creek/Expression.hpp>
+#include <creek/Expression_DataTypes.hpp>
+#include <creek/Identifier.hpp>
+#include <creek/Null.hpp>
+#include <creek/Number.hpp>
+#include <creek/Scope.hpp>
+#include <creek/String.hpp>
+#include <creek/Void.hpp>
+
+
+namespace creek
+{
+    /// @brief  `Compiler` constructor.
+    Compiler::Compiler() : m_expression_count(0)
+    {
+
+    }
+
+
+    /// @brief  Compile an expression.
+    /// @param  expression  Expression to compile.
+    std::shared_ptr<Program> Compiler::compile(const Expression* expression)
+    {
+        auto var_name_map = std::make_shared<VarNameMap>();
+        Bytecode bytecode;
+        expression->bytecode(bytecode, *var_name_map);
+        return compile(bytecode, var_name_map);
+    }
+
+    /// @brief  Compile the op-code tree of an expression.
+    /// @param  bytecode        Bytecode, positioned at the expression.
+    /// @param  var_name_map    Var names used in the bytecode.
+    std::shared_ptr<Program> Compiler::compile(Bytecode& bytecode, const std::shared_ptr<const VarNameMap>& var_name_map)
+    {
+        m_var_name_map = var_name_map;
+
+        // the program is run in the scope it is given
+        m_resolver.begin_function();
+        auto program = compile_program(bytecode);
+        m_resolver.end_function();
+        return program;
+    }
+
+    /// @brief  Compile a lazy program from its source bytecode.
+    /// @param  program     Lazy program; compiled in place.
+    void Compiler::compile(Program& program)
+    {
+        m_var_name_map = program.source_var_name_map();
+        Bytecode bytecode(program.source_bytes());
+
+        // a function body is run in the scope of its call, below the closure
+        // environment with the captures found where the function was created
+        auto& function_vars = program.function_vars();
+        FunctionVars vars;
+        m_resolver.begin_function();
+        if (function_vars)
+        {
+            m_resolver.begin_function(vars);
+            vars.captures = function_vars->captures;
+            for (auto& arg_name : program.arg_names())
+            {
+                m_resolver.declare(arg_name);
+            }
+        }
+
+        compile_expression(bytecode, program);
+        program.emit(OpCode::control_return);
+
+        if (function_vars)
+        {
+            m_resolver.end_function();
+            function_vars->slot_count = vars.slot_count;
+            function_vars->captured_slots = vars.captured_slots;
+        }
+        m_resolver.end_function();
+    }
+
+    /// @brief  Get an expression equivalent to a compiled program.
+    /// @param  program     Program compiled from bytecode.
+    Expression* Compiler::decompile(const Program& program)
+    {
+        if (!program.source_var_name_map())
+        {
+            throw Exception("Program has no source bytecode");
+        }
+
+        Bytecode bytecode(program.source_bytes());
+        BytecodeInterpreter interpreter;
+        Expression* expression = interpreter.parse_expression(bytecode, *program.source_var_name_map());
+        return expression ? expression : new ExprVoid();
+    }
+
+    // Number of expressions compiled so far.
+    size_t Compiler::expression_count() const
+    {
+        return m_expression_count;
+    }
+
+
+    std::shared_ptr<Program> Compiler::compile_program(Bytecode& bytecode)
+    {
+        auto program = std::make_shared<Program>();
+
+        unsigned begin = bytecode.position();
+        compile_expression(bytecode, *program);
+        program->emit(OpCode::control_return);
+        unsigned end = bytecode.position();
+
+        program->source(bytecode.sub(begin, end - begin), m_var_name_map);
+        return program;
+    }
+
+    std::shared_ptr<Program> Compiler::compile_function(Bytecode& bytecode, const std::vector<VarName>& arg_names, const std::shared_ptr<FunctionVars>& vars)
+    {
+        // the arguments take the first slots of the function scope
+        m_resolver.begin_function(*vars);
+        for (auto& arg_name : arg_names)
+        {
+            m_resolver.declare(arg_name);
+        }
+
+        // compile now unless the body can be read later from the same memory
+        std::shared_ptr<Program> program;
+        size_t begin = bytecode.position();
+        size_t end = bytecode.function_end(begin);
+        if (end == 0 || !bytecode.owner())
+        {
+            program = compile_program(bytecode);
+        }
+        else
+        {
+            program = std::make_shared<Program>();
+            program->source(bytecode.sub(begin, end - begin), m_var_name_map);
+            program->function(arg_names, vars);
+
+            // captured in the order of the function table, which the body
+            // keeps when it is compiled
+            for (auto id : *bytecode.function_captures(begin))
+            {
+                VarName var_name = VarName::from_id(m_var_name_map->global_from_local(id));
+                unsigned depth = 0;
+                unsigned slot = Scope::no_slot;
+                m_resolver.find(var_name, depth, slot);
+            }
+            bytecode.skip(end - begin);
+        }
+
+        m_resolver.end_function();
+        return program;
+    }
+
+    void Compiler::push_scope(Program& program)
+    {
+        program.emit(OpCode::vm_push_scope);
+        m_resolver.begin_scope();
+    }
+
+    void Compiler::pop_scope(Program& program)
+    {
+        program.emit(OpCode::vm_pop_scope);
+        m_resolver.end_scope();
+    }
+
+    void Compiler::emit_var(Program& program, OpCode op_code, VarName var_name)
+    {
+        unsigned depth = 0;
+        unsigned slot = Scope::no_slot;
+        if (op_code == OpCode::var_create_local)
+        {
+            slot = m_resolver.declare(var_name);
+        }
+        else
+        {
+            find_var(var_name, depth, slot);
+        }
+        program.emit(op_code, program.add_name(var_name), slot, depth);
+    }
+
+    void Compiler::find_var(VarName var_name, unsigned& depth, unsigned& slot)
+    {
+        m_resolver.find(var_name, depth, slot);
+        if (depth > UINT16_MAX)
+        {
+            throw Exception("Too many nested scopes");
+        }
+    }
+
+    void Compiler::compile_expression(Bytecode& bytecode, Program& program)
+    {
+        uint8_t byte = static_cast<uint8_t>(OpCode::nop);
+        bytecode >> byte;
+        OpCode op_code = static_cast<OpCode>(byte);
+        m_expression_count += 1;
+
+        switch (op_code)
+        {
+            // debug
+            case OpCode::nop:                       //< 0x00
+            {
+                program.emit(OpCode::vm_const, program.add_constant(new Void()));
+                break;
+            }
+            case OpCode::print:                     //< 0x01
+            {
+                compile_unary(bytecode, program, op_code);
+                break;
+            }
+
+
+            // arithmetic, bitwise and comparison
+            case OpCode::add:                       //< 0x10
+            case OpCode::sub:                       //< 0x11
+            case OpCode::mul:                       //< 0x12
+            case OpCode::div:                       //< 0x13
+            case OpCode::mod:                       //< 0x14
+            case OpCode::exp:                       //< 0x15
+            case OpCode::bit_and:                   //< 0x17
+            case OpCode::bit_or:                    //< 0x18
+            case OpCode::bit_xor:                   //< 0x19
+            case OpCode::bit_left_shift:            //< 0x1B
+            case OpCode::bit_right_shift:           //< 0x1C
+            case OpCode::bool_xor:                  //< 0x1F
+            case OpCode::cmp:                       //< 0x21
+            case OpCode::eq:                        //< 0x22
+            case OpCode::ne:                        //< 0x23
+            case OpCode::lt:                        //< 0x24
+            case OpCode::le:                        //< 0x25
+            case OpCode::gt:                        //< 0x26
+            case OpCode::ge:                        //< 0x27
+            {
+                compile_binary(bytecode, program, op_code);
+                break;
+            }
+            case OpCode::unm:                       //< 0x16
+            case OpCode::bit_not:                   //< 0x1A
+            case OpCode::bool_not:                  //< 0x20
+            {
+                compile_unary(bytecode, program, op_code);
+                break;
+            }
+
+
+            // boolean short-circuit
+            case OpCode::bool_and:                  //< 0x1D
+            {
+                compile_expression(bytecode, program);
+                uint32_t jump = program.emit(OpCode::vm_jump_if_false_keep);
+                compile_expression(bytecode, program);
+                program.patch(jump, program.size());
+                break;
+            }
+            case OpCode::bool_or:                   //< 0x1E
+            {
+                compile_expression(bytecode, program);
+                uint32_t jump = program.emit(OpCode::vm_jump_if_true_keep);
+                compile_expression(bytecode, program);
+                program.patch(jump, program.size());
+                break;
+            }
+
+
+            // data types
+            case OpCode::data_void:                 //< 0x30
+            case OpCode::data_null:                 //< 0x31
+            case OpCode::data_boolean:              //< 0x32
+            case OpCode::data_number:               //< 0x33
+            case OpCode::data_string:               //< 0x34
+            case OpCode::data_identifier:           //< 0x35
+            {
+                program.emit(OpCode::vm_const, program.add_constant(parse_constant(bytecode, op_code)));
+                break;
+            }
+            case OpCode::data_vector:               //< 0x36
+            {
+                uint32_t size = 0;
+                bytecode >> size;
+                for (uint32_t i = 0; i < size; i += 1)
+                {
+                    compile_expression(bytecode, program);
+                }
+                program.emit(OpCode::data_vector, size);
+                break;
+            }
+            case OpCode::data_map:                  //< 0x37
+            {
+                uint32_t size = 0;
+                bytecode >> size;
+                for (uint32_t i = 0; i < size; i += 1)
+                {
+                    compile_expression(bytecode, program);
+                    compile_expression(bytecode, program);
+                }
+                program.emit(OpCode::data_map, size);
+                break;
+            }
+            case OpCode::data_function:             //< 0x38
+            {
+                uint32_t nargs = 0;
+                bytecode >> nargs;
+                std::vector<VarName> arg_names(nargs);
+                for (uint32_t i = 0; i < nargs; i += 1)
+                {
+                    arg_names[i] = parse_var_name(bytecode);
+                }
+
+                bool variadic = false;
+                bytecode >> variadic;
+
+                auto vars = std::make_shared<FunctionVars>();
+                auto body = compile_function(bytecode, arg_names, vars);
+
+                auto function = new ExprFunction(arg_names, variadic, std::make_shared<ExprProgram>(body), vars);
+                program.emit(OpCode::vm_eval, program.add_expression(function));
+                break;
+            }
+            case OpCode::data_class:                //< 0x39
+            {
+                BytecodeInterpreter interpreter;
+
+                VarName class_name = parse_var_name(bytecode);
+                Expression* super_class = interpreter.parse_expression(bytecode, *m_var_name_map);
+                super_class->resolve(m_resolver);
+
+                uint32_t nmethods = 0;
+                bytecode >> nmethods;
+
+                std::vector<ExprClass::MethodDef> method_defs;
+                for (uint32_t i = 0; i < nmethods; i += 1)
+                {
+                    VarName id = parse_var_name(bytecode);
+
+                    uint32_t narg = 0;
+                    bytecode >> narg;
+                    std::vector<VarName> arg_names(narg);
+                    for (uint32_t iarg = 0; iarg < narg; iarg += 1)
+                    {
+                        arg_names[iarg] = parse_var_name(bytecode);
+                    }
+
+                    bool is_variadic = false;
+                    bytecode >> is_variadic;
+
+                    auto vars = std::make_shared<FunctionVars>();
+                    auto body = compile_function(bytecode, arg_names, vars);
+
+                    method_defs.emplace_back(id, arg_names, is_variadic, std::make_shared<ExprProgram>(body));
+                    method_defs.back().vars = vars;
+                }
+
+                std::vector<ExprClass::StaticDef> static_defs;
+
+                auto class_expr = new ExprClass(class_name, super_class, method_defs, static_defs);
+                program.emit(OpCode::vm_eval, program.add_expression(class_expr));
+                break;
+            }
+
+
+            // control flow
+            case OpCode::control_block:             //< 0x40
+            {
+                uint32_t nexpr = 0;
+                bytecode >> nexpr;
+                if (nexpr == 0)
+                {
+                    program.emit(OpCode::vm_const, program.add_constant(new Void()));
+                }
+                for (uint32_t i = 0; i < nexpr; i += 1)
+                {
+                    if (i > 0)
+                    {
+                        program.emit(OpCode::vm_pop);
+                    }
+                    compile_expression(bytecode, program);
+                }
+                break;
+            }
+            case OpCode::control_do:                //< 0x41
+            {
+                push_scope(program);
+                compile_expression(bytecode, program);
+                pop_scope(program);
+                break;
+            }
+            case OpCode::control_if:                //< 0x42
+            {
+                push_scope(program);
+                compile_expression(bytecode, program);
+                uint32_t jump_else = program.emit(OpCode::vm_jump_if_false);
+                compile_expression(bytecode, program);
+                uint32_t jump_end = program.emit(OpCode::vm_jump);
+                program.patch(jump_else, program.size());
+                compile_expression(bytecode, program);
+                program.patch(jump_end, program.size());
+                pop_scope(program);
+                break;
+            }
+            case OpCode::control_switch:            //< 0x43
+            {
+                // the condition stays on the stack until a case matches
+                push_scope(program);
+                compile_expression(bytecode, program);
+
+                std::vector<uint32_t> jumps_end;
+
+                uint32_t nbranch = 0;
+                bytecode >> nbranch;
+                for (uint32_t i = 0; i < nbranch; i += 1)
+                {
+                    std::vector<uint32_t> jumps_body;
+
+                    uint32_t nvalue = 0;
+                    bytecode >> nvalue;
+                    for (uint32_t ivalue = 0; ivalue < nvalue; ivalue += 1)
+                    {
+                        compile_expression(bytecode, program);
+                        jumps_body.push_back(program.emit(OpCode::vm_jump_if_case));
+                    }
+                    uint32_t jump_next = program.emit(OpCode::vm_jump);
+
+                    for (auto jump : jumps_body)
+                    {
+                        program.patch(jump, program.size());
+                    }
+                    compile_expression(bytecode, program);
+                    jumps_end.push_back(program.emit(OpCode::vm_jump));
+
+                    program.patch(jump_next, program.size());
+                }
+
+                program.emit(OpCode::vm_pop);
+                compile_expression(bytecode, program);
+
+                for (auto jump : jumps_end)
+                {
+                    program.patch(jump, program.size());
+                }
+                pop_scope(program);
+                break;
+            }
+            case OpCode::control_loop:              //< 0x44
+            {
+                // the scope of the body is cleared on each iteration
+                program.emit(OpCode::vm_const, program.add_constant(new Void()));
+                push_scope(program);
+                uint32_t loop = program.emit(OpCode::vm_loop_begin);
+
+                uint32_t top = program.size();
+                compile_expression(bytecode, program);
+                program.emit(OpCode::vm_loop_set);
+                program.emit(OpCode::vm_clear_scope);
+                program.emit(OpCode::vm_jump, top);
+
+                program.patch(loop, program.size());
+                program.emit(OpCode::vm_loop_end);
+                pop_scope(program);
+                break;
+            }
+            case OpCode::control_while:             //< 0x45
+            {
+                program.emit(OpCode::vm_const, program.add_constant(new Void()));
+                push_scope(program);
+                uint32_t loop = program.emit(OpCode::vm_loop_begin);
+
+                // the condition is evaluated in the scope of the body
+                uint32_t top = program.size();
+                compile_expression(bytecode, program);
+                uint32_t jump_exit = program.emit(OpCode::vm_jump_if_false);
+                compile_expression(bytecode, program);
+                program.emit(OpCode::vm_loop_set);
+                program.emit(OpCode::vm_clear_scope);
+                program.emit(OpCode::vm_jump, top);
+
+                program.patch(jump_exit, program.size());
+                program.patch(loop, program.size());
+                program.emit(OpCode::vm_loop_end);
+                pop_scope(program);
+                break;
+            }
+            case OpCode::control_for:               //< 0x46
+            {
+                VarName var_name = parse_var_name(bytecode);
+
+                // variable with initial value
+                push_scope(program);
+                compile_expression(bytecode, program);
+                emit_var(program, OpCode::var_create_local, var_name);
+                program.emit(OpCode::vm_pop);
+
+                program.emit(OpCode::vm_const, program.add_constant(new Void()));
+                push_scope(program);
+                uint32_t loop = program.emit(OpCode::vm_loop_begin);
+
+                // constant bounds: the machine checks and adds them itself
+                size_t bounds = bytecode.position();
+                std::unique_ptr<Data> max_value(parse_constant(bytecode));
+                std::unique_ptr<Data> step_value(max_value ? parse_constant(bytecode) : nullptr);
+                if (step_value)
+                {
+                    unsigned depth = 0;
+                    unsigned slot = Scope::no_slot;
+                    find_var(var_name, depth, slot);
+                    uint32_t range = program.add_for_range(ForRange{
+                        program.add_name(var_name), slot, static_cast<uint16_t>(depth),
+                        program.add_constant(max_value.release()), program.add_constant(step_value.release())
+                    });
+                    uint32_t check = program.emit(OpCode::vm_for_check, 0, range);
+
+                    // execute body block; the step checks the maximum again
+                    uint32_t body = program.size();
+                    compile_expression(bytecode, program);
+                    program.emit(OpCode::vm_loop_set);
+                    program.emit(OpCode::vm_clear_scope);
+                    uint32_t step = program.emit(OpCode::vm_for_step, body, range);
+
+                    program.patch(check, step + 1);
+                    program.patch(loop, program.size());
+                    program.emit(OpCode::vm_loop_end);
+                    pop_scope(program);
+                    pop_scope(program);
+                    break;
+                }
+                else if (max_value)
+                {
+                    // only the maximum was constant: compile both again
+                    m_expression_count -= 1;
+                    bytecode.seek(bounds);
+                }
+
+                // check maximum
+                uint32_t top = program.size();
+                emit_var(program, OpCode::var_load_local, var_name);
+                compile_expression(bytecode, program);
+                program.emit(OpCode::lt);
+                uint32_t jump_exit = program.emit(OpCode::vm_jump_if_false);
+                uint32_t jump_body = program.emit(OpCode::vm_jump);
+
+                // add step
+                uint32_t step = program.size();
+                emit_var(program, OpCode::var_load_local, var_name);
+                compile_expression(bytecode, program);
+                program.emit(OpCode::add);
+                emit_var(program, OpCode::var_store_local, var_name);
+                program.emit(OpCode::vm_pop);
+                program.emit(OpCode::vm_jump, top);
+
+                // execute body block
+                program.patch(jump_body, program.size());
+                compile_expression(bytecode, program);
+                program.emit(OpCode::vm_loop_set);
+                program.emit(OpCode::vm_clear_scope);
+                program.emit(OpCode::vm_jump, step);
+
+                program.patch(jump_exit, program.size());
+                program.patch(loop, program.size());
+                program.emit(OpCode::vm_loop_end);
+                pop_scope(program);
+                pop_scope(program);
+                break;
+            }
+            case OpCode::control_for_in:            //< 0x47
+            {
+                VarName var_name = parse_var_name(bytecode);
+
+                // range and iterator stay on the stack
+                compile_expression(bytecode, program);
+                program.emit(OpCode::vm_for_in_begin);
+
+                push_scope(program);
+                program.emit(OpCode::vm_const, program.add_constant(new Null()));
+                emit_var(program, OpCode::var_create_local, var_name);
+                program.emit(OpCode::vm_pop);
+
+                program.emit(OpCode::vm_const, program.add_constant(new Void()));
+                push_scope(program);
+                uint32_t loop = program.emit(OpCode::vm_loop_begin);
+
+                uint32_t top = program.emit(OpCode::vm_for_in_next);
+                emit_var(program, OpCode::var_store_local, var_name);
+                program.emit(OpCode::vm_pop);
+                compile_expression(bytecode, program);
+                program.emit(OpCode::vm_loop_set);
+                program.emit(OpCode::vm_clear_scope);
+                program.emit(OpCode::vm_jump, top);
+
+                program.patch(top, program.size());
+                program.patch(loop, program.size());
+                program.emit(OpCode::vm_loop_end);
+                program.emit(OpCode::vm_drop, 2);
+                pop_scope(program);
+                pop_scope(program);
+                break;
+            }
+            case OpCode::control_try:               //< 0x48
+            {
+                uint32_t try_begin = program.emit(OpCode::vm_try_begin);
+                compile_expression(bytecode, program);
+                program.emit(OpCode::vm_try_end);
+                uint32_t jump_end = program.emit(OpCode::vm_jump);
+
+                // catch handler
+                program.patch(try_begin, program.size());
+                VarName id = parse_var_name(bytecode);
+                push_scope(program);
+                program.emit(OpCode::vm_const, program.add_constant(new Null()));
+                emit_var(program, OpCode::var_create_local, id);
+                program.emit(OpCode::vm_pop);
+                compile_expression(bytecode, program);
+                pop_scope(program);
+
+                program.patch(jump_end, program.size());
+                break;
+            }
+            case OpCode::control_throw:             //< 0x49
+            case OpCode::control_return:            //< 0x4A
+            case OpCode::control_break:             //< 0x4B
+            {
+                compile_unary(bytecode, program, op_code);
+                break;
+            }
+
+
+            // general
+            case OpCode::call:                      //< 0x50
+            {
+                compile_expression(bytecode, program);
+
+                uint32_t narg = 0;
+                bytecode >> narg;
+                for (uint32_t i = 0; i < narg; i += 1)
+                {
+                    compile_expression(bytecode, program);
+                }
+
+                program.emit(OpCode::call, narg);
+                break;
+            }
+            case OpCode::variadic_call:             //< 0x51
+            {
+                compile_expression(bytecode, program);
+
+                uint32_t narg = 0;
+                bytecode >> narg;
+                for (uint32_t i = 0; i < narg; i += 1)
+                {
+                    compile_expression(bytecode, program);
+                }
+
+                compile_expression(bytecode, program);
+
+                program.emit(OpCode::variadic_call, narg);
+                break;
+            }
+            case OpCode::call_method:               //< 0x52
+            case OpCode::variadic_call_method:      //< 0x53
+            {
+                compile_expression(bytecode, program);
+                uint32_t method = program.add_attr_lookup(parse_var_name(bytecode));
+
+                uint32_t narg = 0;
+                bytecode >> narg;
+                for (uint32_t i = 0; i < narg; i += 1)
+                {
+                    compile_expression(bytecode, program);
+                }
+
+                if (op_code == OpCode::variadic_call_method)
+                {
+                    compile_expression(bytecode, program);
+                }
+
+                program.emit(op_code, narg, method);
+                break;
+            }
+            case OpCode::index_get:                 //< 0x54
+            {
+                compile_binary(bytecode, program, op_code);
+                break;
+            }
+            case OpCode::index_set:                 //< 0x55
+            {
+                compile_expression(bytecode, program);
+                compile_expression(bytecode, program);
+                compile_expression(bytecode, program);
+                program.emit(op_code);
+                break;
+            }
+            case OpCode::attr_get:                  //< 0x56
+            {
+                compile_expression(bytecode, program);
+                program.emit(op_code, program.add_attr_lookup(parse_var_name(bytecode)));
+                break;
+            }
+            case OpCode::attr_set:                  //< 0x57
+            {
+                compile_expression(bytecode, program);
+                uint32_t attr = program.add_name(parse_var_name(bytecode));
+                compile_expression(bytecode, program);
+                program.emit(op_code, attr);
+                break;
+            }
+
+
+            // variable
+            case OpCode::var_create_local:          //< 0x60
+            case OpCode::var_store_local:           //< 0x62
+            {
+                VarName var_name = parse_var_name(bytecode);
+                compile_expression(bytecode, program);
+                emit_var(program, op_code, var_name);
+                break;
+            }
+            case OpCode::var_load_local:            //< 0x61
+            {
+                emit_var(program, op_code, parse_var_name(bytecode));
+                break;
+            }
+            case OpCode::var_create_global:         //< 0x63
+            case OpCode::var_store_global:          //< 0x65
+            {
+                uint32_t var_name = program.add_name(parse_var_name(bytecode));
+                compile_expression(bytecode, program);
+                program.emit(op_code, var_name);
+                break;
+            }
+            case OpCode::var_load_global:           //< 0x64
+            {
+                program.emit(op_code, program.add_name(parse_var_name(bytecode)));
+                break;
+            }
+
+
+            // dynamic load
+            case OpCode::dyn_func:                  //< 0x70
+            case OpCode::dyn_class:                 //< 0x71
+            {
+                BytecodeInterpreter interpreter;
+                auto expression = interpreter.parse_operation(op_code, bytecode, *m_var_name_map);
+                expression->resolve(m_resolver);
+                program.emit(OpCode::vm_eval, program.add_expression(expression));
+                break;
+            }
+
+
+            default:
+            {
+                throw InvalidBytecode();
+            }
+        }
+    }
+
+    void Compiler::compile_binary(Bytecode& bytecode, Program& program, OpCode op_code)
+    {
+        compile_expression(bytecode, program);
+        compile_expression(bytecode, program);
+        program.emit(op_code);
+    }
+
+    void Compiler::compile_unary(Bytecode& bytecode, Program& program, OpCode op_code)
+    {
+        compile_expression(bytecode, program);
+        program.emit(op_code);
+    }
+
+    Data* Compiler::parse_constant(Bytecode& bytecode)
+    {
+        size_t position = bytecode.position();
+        uint8_t byte = static_cast<uint8_t>(OpCode::nop);
+        bytecode >> byte;
+
+        Data* constant = parse_constant(bytecode, static_cast<OpCode>(byte));
+        if (constant)
+        {
+            m_expression_count += 1;
+        }
+        else
+        {
+            bytecode.seek(position);
+        }
+        return constant;
+    }
+
+    Data* Compiler::parse_constant(Bytecode& bytecode, OpCode op_code)
+    {
+        switch (op_code)
+        {
+            case OpCode::data_void:
+            {
+                return new Void();
+            }
+            case OpCode::data_null:
+            {
+                return new Null();
+            }
+            case OpCode::data_boolean:
+            {
+                Boolean::Value value = false;
+                bytecode >> value;
+                return new Boolean(value);
+            }
+            case OpCode::data_number:
+            {
+                VarNameMap::Id id = 0;
+                bytecode >> id;
+                return new Number(m_var_name_map->number_from_id(id));
+            }
+            case OpCode::data_string:
+            {
+                VarNameMap::Id id = 0;
+                bytecode >> id;
+                return new String(m_var_name_map->string_from_id(id));
+            }
+            case OpCode::data_identifier:
+            {
+                return new Identifier(parse_var_name(bytecode));
+            }
+            default:
+            {
+                return nullptr;
+            }
+        }
+    }
+
+    VarName Compiler::parse_var_name(Bytecode& bytecode)
+    {
+        VarNameMap::Id local_id = 0;
+        bytecode >> local_id;
+
+        VarName::Id global_id = m_var_name_map->global_from_local(local_id);
+        return VarName::from_id(global_id);
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <creek/api_mode.hpp>
+#include <creek/Bytecode.hpp>
+#include <creek/VarNameMap.hpp>
+#include <creek/VarResolver.hpp>
+#include <creek/VirtualMachine.hpp>
+
+
+namespace creek
+{
+    class Data;
+    class Expression;
+
+
+    /// @brief  Bytecode compiler.
+    /// Translates the op-code tree of a bytecode into a flat `Program` for
+    /// the `VirtualMachine`.
+    /// Function bodies listed in the function table of a bytecode read in
+    /// place are not compiled, but left as lazy programs; the table gives
+    /// the variables they capture.
+    /// Local variables are resolved while compiling, with the scopes the
+    /// machine will create, so they are found by depth and slot like in the
+    /// expressions resolved by `VarResolver`.
+    class CREEK_API Compiler
+    {
+    public:
+        /// @brief  `Compiler` constructor.
+        Compiler();
+
+
+        /// @brief  Compile an expression.
+        /// @param  expression  Expression to compile.
+        std::shared_ptr<Program> compile(const Expression* expression);
+
+        /// @brief  Compile the op-code tree of an expression.
+        /// @param  bytecode        Bytecode, positioned at the expression.
+        /// @param  var_name_map    Var names used in the bytecode.
+        std::shared_ptr<Program> compile(Bytecode& bytecode, const std::shared_ptr<const VarNameMap>& var_name_map);
+
+        /// @brief  Compile a lazy program from its source bytecode.
+        /// @param  program     Lazy program; compiled in place.
+        void compile(Program& program);
+
+        /// @brief  Get an expression equivalent to a compiled program.
+        /// @param  program     Program compiled from bytecode.
+        Expression* decompile(const Program& program);
+
+        /// @brief  Number of expressions compiled so far.
+        /// Counts the nodes of the op-code tree, function bodies included.
+        size_t expression_count() const;
+
+
+    private:
+        void compile_expression(Bytecode& bytecode, Program& program);
+        void compile_binary(Bytecode& bytecode, Program& program, OpCode op_code);
+        void compile_unary(Bytecode& bytecode, Program& program, OpCode op_code);
+        std::shared_ptr<Program> compile_program(Bytecode& bytecode);
+        std::shared_ptr<Program> compile_function(Bytecode& bytecode, const std::vector<VarName>& arg_names, const std::shared_ptr<FunctionVars>& vars);
+        void push_scope(Program& program);
+        void pop_scope(Program& program);
+        void emit_var(Program& program, OpCode op_code, VarName var_name);
+        void find_var(VarName var_name, unsigned& depth, unsigned& slot);
+        Data* parse_constant(Bytecode& bytecode);
+        Data* parse_constant(Bytecode& bytecode, OpCode op_code);
+        VarName parse_var_name(Bytecode& bytecode);
+
+        std::shared_ptr<const VarNameMap> m_var_name_map;
+        VarResolver m_resolver;
+        size_t m_expression_count;
+    };
+}
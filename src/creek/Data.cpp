@@ -1,6 +1,7 @@
 #include <creek/Data.hpp>
 
 #include <creek/Exception.hpp>
+#include <creek/Iterator.hpp>
 #include <creek/Variable.hpp>
 
 
@@ -26,6 +27,27 @@ namespace creek
         #endif
     }
 
+    Data::Data(DataType type) : m_type(type)
+    {
+        #ifdef CREEK_INSTANCE_COUNT
+            instance_count += 1;
+            std::clong << "Data instance count: " << instance_count << "\n";
+        #endif
+    }
+
+    Data::Data(const Data& other) : m_type(other.m_type)
+    {
+        #ifdef CREEK_INSTANCE_COUNT
+            instance_count += 1;
+            std::clong << "Data instance count: " << instance_count << "\n";
+        #endif
+    }
+
+    Data& Data::operator = (const Data& other)
+    {
+        return *this;
+    }
+
     Data* Data::copy() const
     {
         throw Undefined(class_name() + "::copy");
@@ -120,6 +142,21 @@ namespace creek
     }
 
 
+    /// @brief  Get an iterator over the values of this container.
+    /// By default iterates over the keys given by the `keys` method.
+    Data* Data::iter()
+    {
+        Variable keys(call_method(VarName::vn_keys, {}));
+        return new KeysIterator(Variable(copy()), keys);
+    }
+
+    /// @brief  Get the next value of this iterator.
+    bool Data::next(Variable& value)
+    {
+        throw Undefined(class_name() + "::next");
+    }
+
+
     /// @name   Object attribute
     /// @{
     /// @brief  Get the attribute.
@@ -206,6 +243,11 @@ namespace creek
         throw Undefined(class_name() + "::cmp");
     }
 
+    size_t Data::hash() const
+    {
+        return 0;
+    }
+
     Data* Data::call(std::vector< std::unique_ptr<Data> >& args)
     {
         throw Undefined(class_name() + "::call");
@@ -241,6 +283,11 @@ namespace creek
         return method->call(up_args);
     }
 
+    unsigned Data::ref_count() const
+    {
+        return m_ref_count;
+    }
+
 
     // `WrongArgNumber` constructor.
     // @param  expected    Number of expected arguments.
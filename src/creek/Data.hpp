@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -15,6 +17,26 @@ namespace creek
     class Variable;
 
 
+    /// @brief  Built-in data type.
+    /// Cheap type tag, to check the type of a data without virtual calls nor
+    /// `dynamic_cast`.
+    enum class DataType : uint8_t
+    {
+        other,              ///< Any other data type.
+        void_data,          ///< `Void`.
+        null,               ///< `Null`.
+        boolean,            ///< `Boolean`.
+        number,             ///< `Number`.
+        string,             ///< `String`.
+        identifier,         ///< `Identifier`.
+        vector,             ///< `Vector`.
+        map,                ///< `Map`.
+        object,             ///< `Object`.
+        function,           ///< `Function`.
+        cfunction,          ///< `CFunction`.
+    };
+
+
     /// @brief  Abstract class for variable's data.
     class CREEK_API Data
     {
@@ -22,6 +44,18 @@ namespace creek
         Data();
         virtual ~Data();
 
+        /// @brief  `Data` constructor.
+        /// @param  type    Type tag of the derived class.
+        Data(DataType type);
+
+        /// @brief  `Data` copy constructor.
+        /// The copy starts with its own reference count.
+        Data(const Data& other);
+
+        /// @brief  `Data` copy operator.
+        /// The reference count is not copied.
+        Data& operator = (const Data& other);
+
         /// @brief  Create a copy of this data.
         virtual Data* copy() const;
 
@@ -29,6 +63,9 @@ namespace creek
         /// By default, calls `copy`.
         virtual Data* clone() const;
 
+        /// @brief  Get the type tag.
+        DataType type() const;
+
         /// @brief  Get data class name.
         virtual std::string class_name() const;
 
@@ -88,6 +125,22 @@ namespace creek
         /// @}
 
 
+        /// @name   Iteration
+        /// Used by `for ... in`.
+        /// @{
+        /// @brief  Get an iterator over the values of this container.
+        /// By default iterates over the keys given by the `keys` method,
+        /// getting each value with `index`.
+        /// @return A new iterator.
+        virtual Data* iter();
+
+        /// @brief  Get the next value of this iterator.
+        /// @param  value       Set to the next value.
+        /// @return `false` if no values are left.
+        virtual bool next(Variable& value);
+        /// @}
+
+
         /// @name   Object attribute
         /// @{
         /// @brief  Get the attribute.
@@ -155,6 +208,11 @@ namespace creek
         /// This special operation must return an integer.
         /// @return -1 if less-than, 0 if equal, +1 if greater-than.
         virtual int cmp(Data* other);
+
+        /// @brief  Hash for hash containers.
+        /// Data that compare equal must have the same hash. The default hash
+        /// is the same for every data, so any data can still be a key.
+        virtual size_t hash() const;
         /// @}
 
 
@@ -183,6 +241,16 @@ namespace creek
             VarName method_name,
             const std::vector<Data*>& args
         ) const;
+
+
+        /// @brief  Get the number of variables sharing this data.
+        unsigned ref_count() const;
+
+    private:
+        friend class Variable;
+
+        unsigned m_ref_count = 1;
+        DataType m_type = DataType::other;
     };
 
 
@@ -204,6 +272,12 @@ namespace creek
 // template implementation
 namespace creek
 {
+    /// @brief  Get the type tag.
+    inline DataType Data::type() const
+    {
+        return m_type;
+    }
+
     /// @brief  Dynamic cast that throws.
     /// @param  T   Data type to cast to.
     template<class T> const T* Data::assert_cast() const
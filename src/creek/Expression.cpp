@@ -17,6 +17,13 @@ namespace creek
         return clone();
     }
 
+    /// @brief  Resolve the local variables used in this expression.
+    /// By default does nothing.
+    void Expression::resolve(VarResolver& resolver)
+    {
+
+    }
+
 
     // `RuntimeError` constructor.
     // @param  expr    Expression associated with the error.
@@ -11,6 +11,7 @@ namespace creek
 {
     class Scope;
     class Variable;
+    class VarResolver;
 
 
     /// Expression statement in a program.
@@ -31,13 +32,19 @@ namespace creek
         /// By default returns a copy of this.
         virtual Expression* const_optimize() const;
 
+        /// @brief  Resolve the local variables used in this expression.
+        /// By default does nothing.
+        virtual void resolve(VarResolver& resolver);
+
 
         /// @brief  Evaluate this expression.
         /// @return Result of the expression; may be `nullptr`.
         virtual Variable eval(Scope& scope) = 0;
 
-        /// @brief  Get the bytecode of this expression.
-        virtual Bytecode bytecode(VarNameMap& var_name_map) const = 0;
+        /// @brief  Write the bytecode of this expression.
+        /// @param  bytecode        Bytecode to append to.
+        /// @param  var_name_map    Var names used in the bytecode.
+        virtual void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const = 0;
     };
 
 
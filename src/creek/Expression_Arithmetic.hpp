@@ -12,25 +12,25 @@ namespace creek
     /// @{
 
     /// @brief  Expression: Add two values.
-    using ExprAdd = ExprBinary<OpCode::add, &Data::add>;
+    using ExprAdd = ExprBinary<OpCode::add, &Variable::add>;
 
     /// @brief  Expression: Subtract two values.
-    using ExprSub = ExprBinary<OpCode::sub, &Data::sub>;
+    using ExprSub = ExprBinary<OpCode::sub, &Variable::sub>;
 
     /// @brief  Expression: Multiply two values.
-    using ExprMul = ExprBinary<OpCode::mul, &Data::mul>;
+    using ExprMul = ExprBinary<OpCode::mul, &Variable::mul>;
 
     /// @brief  Expression: Divide two values.
-    using ExprDiv = ExprBinary<OpCode::div, &Data::div>;
+    using ExprDiv = ExprBinary<OpCode::div, &Variable::div>;
 
     /// @brief  Expression: Modulo two values.
-    using ExprMod = ExprBinary<OpCode::mod, &Data::mod>;
+    using ExprMod = ExprBinary<OpCode::mod, &Variable::mod>;
 
     /// @brief  Expression: Exponentiate two values.
-    using ExprExp = ExprBinary<OpCode::exp, &Data::exp>;
+    using ExprExp = ExprBinary<OpCode::exp, &Variable::exp>;
 
     /// @brief  Expression: Negate one values.
-    using ExprUnm = ExprUnary<OpCode::unm, &Data::unm>;
+    using ExprUnm = ExprUnary<OpCode::unm, &Variable::unm>;
 
 
     // /// @brief  Expression: Add two values.
@@ -14,27 +14,27 @@ namespace creek
 
     /// @brief  Expression: Bitwise AND two values.
     /// Returns L & R.
-    using ExprBitAnd = ExprBinary<OpCode::bit_and, &Data::bit_and>;
+    using ExprBitAnd = ExprBinary<OpCode::bit_and, &Variable::bit_and>;
 
     /// @brief  Expression: Bitwise OR two values.
     /// Returns L | R.
-    using ExprBitOr = ExprBinary<OpCode::bit_or, &Data::bit_or>;
+    using ExprBitOr = ExprBinary<OpCode::bit_or, &Variable::bit_or>;
 
     /// @brief  Expression: Bitwise XOR two values.
     /// Returns L ^ R.
-    using ExprBitXor = ExprBinary<OpCode::bit_xor, &Data::bit_xor>;
+    using ExprBitXor = ExprBinary<OpCode::bit_xor, &Variable::bit_xor>;
 
     /// @brief  Expression: Bitwise NOT one value.
     /// Returns ~L.
-    using ExprBitNot = ExprUnary<OpCode::bit_not, &Data::bit_not>;
+    using ExprBitNot = ExprUnary<OpCode::bit_not, &Variable::bit_not>;
 
     /// @brief  Expression: Bitwise left shift two values.
     /// Returns L << R.
-    using ExprBitLeftShift = ExprBinary<OpCode::bit_left_shift, &Data::bit_left_shift>;
+    using ExprBitLeftShift = ExprBinary<OpCode::bit_left_shift, &Variable::bit_left_shift>;
 
     /// @brief  Expression: Bitwise right shift two values.
     /// Returns L >> R.
-    using ExprBitRightShift = ExprBinary<OpCode::bit_right_shift, &Data::bit_right_shift>;
+    using ExprBitRightShift = ExprBinary<OpCode::bit_right_shift, &Variable::bit_right_shift>;
 
 
     // /// @brief  Expression: Bitwise AND two values.
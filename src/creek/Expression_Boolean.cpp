@@ -5,6 +5,7 @@
 #include <creek/OpCode.hpp>
 #include <creek/Scope.hpp>
 #include <creek/Variable.hpp>
+#include <creek/VarResolver.hpp>
 
 
 namespace creek
@@ -48,7 +49,7 @@ namespace creek
         {
             Scope scope;
             Variable l = m_lexpr->eval(scope);
-            if (l->bool_value() == true)
+            if (l->bool_value() == false)
             {
                 return m_lexpr->const_optimize();
             }
@@ -63,10 +64,16 @@ namespace creek
         }
     }
 
+    void ExprBoolAnd::resolve(VarResolver& resolver)
+    {
+        m_lexpr->resolve(resolver);
+        m_rexpr->resolve(resolver);
+    }
+
     Variable ExprBoolAnd::eval(Scope& scope)
     {
         Variable l(m_lexpr->eval(scope));
-        if (l->bool_value() == false)
+        if (l.bool_value() == false)
         {
             return l;
         }
@@ -77,9 +84,11 @@ namespace creek
         }
     }
 
-    Bytecode ExprBoolAnd::bytecode(VarNameMap& var_name_map) const
+    void ExprBoolAnd::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() << static_cast<uint8_t>(OpCode::bool_and) << m_lexpr->bytecode(var_name_map) << m_rexpr->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::bool_and);
+        m_lexpr->bytecode(bytecode, var_name_map);
+        m_rexpr->bytecode(bytecode, var_name_map);
     }
 
 
@@ -122,7 +131,7 @@ namespace creek
         {
             Scope scope;
             Variable l = m_lexpr->eval(scope);
-            if (l->bool_value() == false)
+            if (l->bool_value() == true)
             {
                 return m_lexpr->const_optimize();
             }
@@ -137,10 +146,16 @@ namespace creek
         }
     }
 
+    void ExprBoolOr::resolve(VarResolver& resolver)
+    {
+        m_lexpr->resolve(resolver);
+        m_rexpr->resolve(resolver);
+    }
+
     Variable ExprBoolOr::eval(Scope& scope)
     {
         Variable l(m_lexpr->eval(scope));
-        if (l->bool_value() == true)
+        if (l.bool_value() == true)
         {
             return l;
         }
@@ -151,9 +166,11 @@ namespace creek
         }
     }
 
-    Bytecode ExprBoolOr::bytecode(VarNameMap& var_name_map) const
+    void ExprBoolOr::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() << static_cast<uint8_t>(OpCode::bool_or) << m_lexpr->bytecode(var_name_map) << m_rexpr->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::bool_or);
+        m_lexpr->bytecode(bytecode, var_name_map);
+        m_rexpr->bytecode(bytecode, var_name_map);
     }
 
 
@@ -192,20 +209,28 @@ namespace creek
         }
     }
 
+    void ExprBoolXor::resolve(VarResolver& resolver)
+    {
+        m_lexpr->resolve(resolver);
+        m_rexpr->resolve(resolver);
+    }
+
     Variable ExprBoolXor::eval(Scope& scope)
     {
         Variable l(m_lexpr->eval(scope));
         Variable r(m_rexpr->eval(scope));
 
-        bool l_bool = l->bool_value();
-        bool r_bool = r->bool_value();
+        bool l_bool = l.bool_value();
+        bool r_bool = r.bool_value();
 
-        return Variable(new Boolean(l_bool != r_bool));
+        return Variable::make_boolean(l_bool != r_bool);
     }
 
-    Bytecode ExprBoolXor::bytecode(VarNameMap& var_name_map) const
+    void ExprBoolXor::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() << static_cast<uint8_t>(OpCode::bool_xor) << m_lexpr->bytecode(var_name_map) << m_rexpr->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::bool_xor);
+        m_lexpr->bytecode(bytecode, var_name_map);
+        m_rexpr->bytecode(bytecode, var_name_map);
     }
 
 
@@ -240,14 +265,20 @@ namespace creek
         }
     }
 
+    void ExprBoolNot::resolve(VarResolver& resolver)
+    {
+        m_expr->resolve(resolver);
+    }
+
     Variable ExprBoolNot::eval(Scope& scope)
     {
         Variable l(m_expr->eval(scope));
-        return Variable(new Boolean(!l->bool_value()));
+        return Variable::make_boolean(!l.bool_value());
     }
 
-    Bytecode ExprBoolNot::bytecode(VarNameMap& var_name_map) const
+    void ExprBoolNot::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() << static_cast<uint8_t>(OpCode::bool_not) << m_expr->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::bool_not);
+        m_expr->bytecode(bytecode, var_name_map);
     }
 }
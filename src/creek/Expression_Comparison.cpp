@@ -5,6 +5,7 @@
 #include <creek/Number.hpp>
 #include <creek/Scope.hpp>
 #include <creek/Variable.hpp>
+#include <creek/VarResolver.hpp>
 
 
 namespace creek
@@ -42,16 +43,24 @@ namespace creek
         }
     }
 
+    void ExprCmp::resolve(VarResolver& resolver)
+    {
+        m_lexpr->resolve(resolver);
+        m_rexpr->resolve(resolver);
+    }
+
     Variable ExprCmp::eval(Scope& scope)
     {
         Variable l(m_lexpr->eval(scope));
         Variable r(m_rexpr->eval(scope));
-        return Variable(new Number(l->cmp(*r)));
+        return Variable::make_number(l.cmp(r));
     }
 
-    Bytecode ExprCmp::bytecode(VarNameMap& var_name_map) const
+    void ExprCmp::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() << static_cast<uint8_t>(OpCode::cmp) << m_lexpr->bytecode(var_name_map) << m_rexpr->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::cmp);
+        m_lexpr->bytecode(bytecode, var_name_map);
+        m_rexpr->bytecode(bytecode, var_name_map);
     }
 
 
@@ -88,16 +97,24 @@ namespace creek
         }
     }
 
+    void ExprEQ::resolve(VarResolver& resolver)
+    {
+        m_lexpr->resolve(resolver);
+        m_rexpr->resolve(resolver);
+    }
+
     Variable ExprEQ::eval(Scope& scope)
     {
         Variable l(m_lexpr->eval(scope));
         Variable r(m_rexpr->eval(scope));
-        return Variable(new Boolean(l->cmp(*r) == 0));
+        return Variable::make_boolean(l.cmp(r) == 0);
     }
 
-    Bytecode ExprEQ::bytecode(VarNameMap& var_name_map) const
+    void ExprEQ::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() << static_cast<uint8_t>(OpCode::eq) << m_lexpr->bytecode(var_name_map) << m_rexpr->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::eq);
+        m_lexpr->bytecode(bytecode, var_name_map);
+        m_rexpr->bytecode(bytecode, var_name_map);
     }
 
 
@@ -134,16 +151,24 @@ namespace creek
         }
     }
 
+    void ExprNE::resolve(VarResolver& resolver)
+    {
+        m_lexpr->resolve(resolver);
+        m_rexpr->resolve(resolver);
+    }
+
     Variable ExprNE::eval(Scope& scope)
     {
         Variable l(m_lexpr->eval(scope));
         Variable r(m_rexpr->eval(scope));
-        return Variable(new Boolean(l->cmp(*r) != 0));
+        return Variable::make_boolean(l.cmp(r) != 0);
     }
 
-    Bytecode ExprNE::bytecode(VarNameMap& var_name_map) const
+    void ExprNE::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() << static_cast<uint8_t>(OpCode::ne) << m_lexpr->bytecode(var_name_map) << m_rexpr->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::ne);
+        m_lexpr->bytecode(bytecode, var_name_map);
+        m_rexpr->bytecode(bytecode, var_name_map);
     }
 
 
@@ -180,16 +205,24 @@ namespace creek
         }
     }
 
+    void ExprLT::resolve(VarResolver& resolver)
+    {
+        m_lexpr->resolve(resolver);
+        m_rexpr->resolve(resolver);
+    }
+
     Variable ExprLT::eval(Scope& scope)
     {
         Variable l(m_lexpr->eval(scope));
         Variable r(m_rexpr->eval(scope));
-        return Variable(new Boolean(l->cmp(*r) < 0));
+        return Variable::make_boolean(l.cmp(r) < 0);
     }
 
-    Bytecode ExprLT::bytecode(VarNameMap& var_name_map) const
+    void ExprLT::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() << static_cast<uint8_t>(OpCode::lt) << m_lexpr->bytecode(var_name_map) << m_rexpr->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::lt);
+        m_lexpr->bytecode(bytecode, var_name_map);
+        m_rexpr->bytecode(bytecode, var_name_map);
     }
 
 
@@ -226,16 +259,24 @@ namespace creek
         }
     }
 
+    void ExprLE::resolve(VarResolver& resolver)
+    {
+        m_lexpr->resolve(resolver);
+        m_rexpr->resolve(resolver);
+    }
+
     Variable ExprLE::eval(Scope& scope)
     {
         Variable l(m_lexpr->eval(scope));
         Variable r(m_rexpr->eval(scope));
-        return Variable(new Boolean(l->cmp(*r) <= 0));
+        return Variable::make_boolean(l.cmp(r) <= 0);
     }
 
-    Bytecode ExprLE::bytecode(VarNameMap& var_name_map) const
+    void ExprLE::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() << static_cast<uint8_t>(OpCode::le) << m_lexpr->bytecode(var_name_map) << m_rexpr->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::le);
+        m_lexpr->bytecode(bytecode, var_name_map);
+        m_rexpr->bytecode(bytecode, var_name_map);
     }
 
 
@@ -272,16 +313,24 @@ namespace creek
         }
     }
 
+    void ExprGT::resolve(VarResolver& resolver)
+    {
+        m_lexpr->resolve(resolver);
+        m_rexpr->resolve(resolver);
+    }
+
     Variable ExprGT::eval(Scope& scope)
     {
         Variable l(m_lexpr->eval(scope));
         Variable r(m_rexpr->eval(scope));
-        return Variable(new Boolean(l->cmp(*r) > 0));
+        return Variable::make_boolean(l.cmp(r) > 0);
     }
 
-    Bytecode ExprGT::bytecode(VarNameMap& var_name_map) const
+    void ExprGT::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() << static_cast<uint8_t>(OpCode::gt) << m_lexpr->bytecode(var_name_map) << m_rexpr->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::gt);
+        m_lexpr->bytecode(bytecode, var_name_map);
+        m_rexpr->bytecode(bytecode, var_name_map);
     }
 
 
@@ -318,15 +367,23 @@ namespace creek
         }
     }
 
+    void ExprGE::resolve(VarResolver& resolver)
+    {
+        m_lexpr->resolve(resolver);
+        m_rexpr->resolve(resolver);
+    }
+
     Variable ExprGE::eval(Scope& scope)
     {
         Variable l(m_lexpr->eval(scope));
         Variable r(m_rexpr->eval(scope));
-        return Variable(new Boolean(l->cmp(*r) >= 0));
+        return Variable::make_boolean(l.cmp(r) >= 0);
     }
 
-    Bytecode ExprGE::bytecode(VarNameMap& var_name_map) const
+    void ExprGE::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() << static_cast<uint8_t>(OpCode::ge) << m_lexpr->bytecode(var_name_map) << m_rexpr->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::ge);
+        m_lexpr->bytecode(bytecode, var_name_map);
+        m_rexpr->bytecode(bytecode, var_name_map);
     }
 }
@@ -26,9 +26,10 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
         
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::unique_ptr<Expression> m_lexpr;
@@ -50,9 +51,10 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::unique_ptr<Expression> m_lexpr;
@@ -73,9 +75,10 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::unique_ptr<Expression> m_lexpr;
@@ -96,9 +99,10 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::unique_ptr<Expression> m_lexpr;
@@ -119,9 +123,10 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::unique_ptr<Expression> m_lexpr;
@@ -142,9 +147,10 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::unique_ptr<Expression> m_lexpr;
@@ -165,9 +171,10 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::unique_ptr<Expression> m_lexpr;
@@ -4,11 +4,31 @@
 #include <creek/Expression_DataTypes.hpp>
 #include <creek/Scope.hpp>
 #include <creek/Variable.hpp>
+#include <creek/VarResolver.hpp>
 #include <creek/Void.hpp>
 #include <iostream> // TODO: remove
 
 namespace creek
 {
+    namespace
+    {
+        // end a loop if its body completed with `break` or `return`;
+        // the break is consumed by the loop
+        inline bool ends_loop(Scope::Completion& completion)
+        {
+            if (completion == Scope::Completion::normal)
+            {
+                return false;
+            }
+            if (completion == Scope::Completion::breaking)
+            {
+                completion = Scope::Completion::normal;
+            }
+            return true;
+        }
+    }
+
+
     // @brief  `ExprBasicBlock` constructor.
     // @param  expressions  List of expressions to evaluate.
     ExprBasicBlock::ExprBasicBlock(const std::vector<Expression*>& expressions)
@@ -60,33 +80,39 @@ namespace creek
         }
     }
 
+    void ExprBasicBlock::resolve(VarResolver& resolver)
+    {
+        for (auto& e : m_expressions)
+        {
+            e->resolve(resolver);
+        }
+    }
+
     Variable ExprBasicBlock::eval(Scope& scope)
     {
         // TODO: Verify which constructor is called for `result` in each three steps.
         Variable result;
+        Scope::Completion& completion = scope.completion();
         for (auto& expression : m_expressions)
         {
-            if (scope.is_breaking())
-                break;
-
             result = expression->eval(scope);
+            if (completion != Scope::Completion::normal)
+                break;
         }
         if (!result) // will return void if no expression was run
         {
-            result.data(new Void());
+            result = Variable::make_void();
         }
         return result;
     }
 
-    Bytecode ExprBasicBlock::bytecode(VarNameMap& var_name_map) const
+    void ExprBasicBlock::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        Bytecode b;
-        b << static_cast<uint8_t>(OpCode::control_block) << static_cast<uint32_t>(m_expressions.size());
+        bytecode << static_cast<uint8_t>(OpCode::control_block) << static_cast<uint32_t>(m_expressions.size());
         for (auto& expr : m_expressions)
         {
-            b << expr->bytecode(var_name_map);
+            expr->bytecode(bytecode, var_name_map);
         }
-        return b;
     }
 
 
@@ -120,15 +146,23 @@ namespace creek
         }
     }
 
+    void ExprDo::resolve(VarResolver& resolver)
+    {
+        resolver.begin_scope();
+        m_value->resolve(resolver);
+        resolver.end_scope();
+    }
+
     Variable ExprDo::eval(Scope& scope)
     {
         Scope new_scope(scope);
         return m_value->eval(new_scope);
     }
 
-    Bytecode ExprDo::bytecode(VarNameMap& var_name_map) const
+    void ExprDo::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() << static_cast<uint8_t>(OpCode::control_do) << m_value->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::control_do);
+        m_value->bytecode(bytecode, var_name_map);
     }
 
 
@@ -155,7 +189,7 @@ namespace creek
         {
             Scope scope;
             Variable c = m_condition->eval(scope);
-            if (c->bool_value() == true)
+            if (c.bool_value() == true)
             {
                 return m_true_branch->is_const();
             }
@@ -176,7 +210,7 @@ namespace creek
         {
             Scope scope;
             Variable c = m_condition->eval(scope);
-            if (c->bool_value() == true)
+            if (c.bool_value() == true)
             {
                 return m_true_branch->const_optimize();
             }
@@ -190,28 +224,39 @@ namespace creek
                                m_false_branch->const_optimize());
     }
 
+    void ExprIf::resolve(VarResolver& resolver)
+    {
+        resolver.begin_scope();
+        m_condition->resolve(resolver);
+        m_true_branch->resolve(resolver);
+        if (m_false_branch)
+        {
+            m_false_branch->resolve(resolver);
+        }
+        resolver.end_scope();
+    }
+
     Variable ExprIf::eval(Scope& scope)
     {
         Scope new_scope(scope);
 
         Variable condition_result(m_condition->eval(new_scope));
-        if (condition_result->bool_value())
+        if (condition_result.bool_value())
         {
-            return m_true_branch ? m_true_branch->eval(new_scope) : Variable(new Void());
+            return m_true_branch ? m_true_branch->eval(new_scope) : Variable::make_void();
         }
         else
         {
-            return m_false_branch ? m_false_branch->eval(new_scope) : Variable(new Void());
+            return m_false_branch ? m_false_branch->eval(new_scope) : Variable::make_void();
         }
     }
 
-    Bytecode ExprIf::bytecode(VarNameMap& var_name_map) const
+    void ExprIf::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() <<
-            static_cast<uint8_t>(OpCode::control_if) <<
-            m_condition->bytecode(var_name_map) <<
-            m_true_branch->bytecode(var_name_map) <<
-            m_false_branch->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::control_if);
+        m_condition->bytecode(bytecode, var_name_map);
+        m_true_branch->bytecode(bytecode, var_name_map);
+        m_false_branch->bytecode(bytecode, var_name_map);
     }
 
 
@@ -309,6 +354,25 @@ namespace creek
         }
     }
 
+    void ExprSwitch::resolve(VarResolver& resolver)
+    {
+        resolver.begin_scope();
+        m_condition->resolve(resolver);
+        for (auto& b : m_case_branches)
+        {
+            for (auto& v : b.values)
+            {
+                v->resolve(resolver);
+            }
+            b.body->resolve(resolver);
+        }
+        if (m_default_branch)
+        {
+            m_default_branch->resolve(resolver);
+        }
+        resolver.end_scope();
+    }
+
     Variable ExprSwitch::eval(Scope& scope)
     {
         Scope new_scope(scope);
@@ -326,29 +390,26 @@ namespace creek
             }
         }
 
-        return m_default_branch ? m_default_branch->eval(new_scope) : Variable(new Void());
+        return m_default_branch ? m_default_branch->eval(new_scope) : Variable::make_void();
     }
 
-    Bytecode ExprSwitch::bytecode(VarNameMap& var_name_map) const
+    void ExprSwitch::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        Bytecode b;
-        b << static_cast<uint8_t>(OpCode::control_switch);
-        b << m_condition->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::control_switch);
+        m_condition->bytecode(bytecode, var_name_map);
 
-        b << static_cast<uint32_t>(m_case_branches.size());
+        bytecode << static_cast<uint32_t>(m_case_branches.size());
         for (auto& case_branch : m_case_branches)
         {
-            b << static_cast<uint32_t>(case_branch.values.size());
+            bytecode << static_cast<uint32_t>(case_branch.values.size());
             for (auto& value : case_branch.values)
             {
-                b << value->bytecode(var_name_map);
+                value->bytecode(bytecode, var_name_map);
             }
-            b << case_branch.body->bytecode(var_name_map);
+            case_branch.body->bytecode(bytecode, var_name_map);
         }
 
-        b << m_default_branch->bytecode(var_name_map);
-
-        return b;
+        m_default_branch->bytecode(bytecode, var_name_map);
     }
 
 
@@ -374,16 +435,27 @@ namespace creek
         return new ExprLoop(m_body->const_optimize());
     }
 
+    void ExprLoop::resolve(VarResolver& resolver)
+    {
+        resolver.begin_scope();
+        resolver.begin_scope();
+        m_body->resolve(resolver);
+        resolver.end_scope();
+        resolver.end_scope();
+    }
+
     Variable ExprLoop::eval(Scope& scope)
     {
         Variable result;
 
-        Scope outer_scope(scope, scope.return_point(), std::make_shared<Scope::BreakPoint>());
+        Scope outer_scope(scope);
+        Scope::Completion& completion = outer_scope.completion();
+        Scope inner_scope(outer_scope);
         while (true)
         {
-            Scope inner_scope(outer_scope);
             result = m_body->eval(inner_scope);
-            if (outer_scope.is_breaking())
+            inner_scope.clear();
+            if (ends_loop(completion))
             {
                 break;
             }
@@ -391,14 +463,15 @@ namespace creek
 
         if (!result)
         {
-            result = new Void();
+            result = Variable::make_void();
         }
         return result;
     }
 
-    Bytecode ExprLoop::bytecode(VarNameMap& var_name_map) const
+    void ExprLoop::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() << static_cast<uint8_t>(OpCode::control_loop) << m_body->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::control_loop);
+        m_body->bytecode(bytecode, var_name_map);
     }
 
 
@@ -423,7 +496,7 @@ namespace creek
         {
             Scope scope;
             Variable c(m_condition->eval(scope));
-            if (c->bool_value() == false)
+            if (c.bool_value() == false)
             {
                 return true;
             }
@@ -437,32 +510,40 @@ namespace creek
         {
             Scope scope;
             Variable c(m_condition->eval(scope));
-            if (c->bool_value() == false)
+            if (c.bool_value() == false)
             {
                 return new ExprVoid();
             }
         }
-        else
-        {
-            return new ExprWhile(m_condition->const_optimize(), m_body->const_optimize());
-        }
+        return new ExprWhile(m_condition->const_optimize(), m_body->const_optimize());
+    }
+
+    void ExprWhile::resolve(VarResolver& resolver)
+    {
+        resolver.begin_scope();
+        resolver.begin_scope();
+        m_condition->resolve(resolver);
+        m_body->resolve(resolver);
+        resolver.end_scope();
+        resolver.end_scope();
     }
 
     Variable ExprWhile::eval(Scope& scope)
     {
         Variable result;
 
-        Scope outer_scope(scope, scope.return_point(), std::make_shared<Scope::BreakPoint>());
+        Scope outer_scope(scope);
+        Scope::Completion& completion = outer_scope.completion();
+        Scope inner_scope(outer_scope);
         while (true)
         {
-            Scope inner_scope(outer_scope);
-
             Variable condition_result(m_condition->eval(inner_scope));
-            if (condition_result->bool_value())
+            if (condition_result.bool_value())
             {
                 result = m_body->eval(inner_scope);
+                inner_scope.clear();
 
-                if (outer_scope.is_breaking())
+                if (ends_loop(completion))
                 {
                     break;
                 }
@@ -473,15 +554,14 @@ namespace creek
             }
         }
 
-        return result ? result : new Void();
+        return result ? result : Variable::make_void();
     }
 
-    Bytecode ExprWhile::bytecode(VarNameMap& var_name_map) const
+    void ExprWhile::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() <<
-            static_cast<uint8_t>(OpCode::control_while) <<
-            m_condition->bytecode(var_name_map) <<
-            m_body->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::control_while);
+        m_condition->bytecode(bytecode, var_name_map);
+        m_body->bytecode(bytecode, var_name_map);
     }
 
 
@@ -494,10 +574,13 @@ namespace creek
     ExprFor::ExprFor(VarName var_name, Expression* initial_value, Expression* max_value,
                      Expression* step_value, Expression* body) :
         m_var_name(var_name),
+        m_var_slot(Scope::no_slot),
+        m_var_captured(false),
         m_initial_value(initial_value),
         m_max_value(max_value),
         m_step_value(step_value),
-        m_body(body)
+        m_body(body),
+        m_const_bounds(m_max_value->is_const() && m_step_value->is_const())
     {
 
     }
@@ -529,53 +612,100 @@ namespace creek
         );
     }
 
+    void ExprFor::resolve(VarResolver& resolver)
+    {
+        resolver.begin_scope();
+        m_initial_value->resolve(resolver);
+        m_var_slot = resolver.declare(m_var_name, m_var_captured);
+        m_max_value->resolve(resolver);
+        m_step_value->resolve(resolver);
+        resolver.begin_scope();
+        m_body->resolve(resolver);
+        resolver.end_scope();
+        resolver.end_scope();
+    }
+
     Variable ExprFor::eval(Scope& scope)
     {
         Variable result;
 
-        Scope outer_scope(scope, scope.return_point(), std::make_shared<Scope::BreakPoint>());
+        Scope outer_scope(scope);
+        Scope::Completion& completion = outer_scope.completion();
         // variable with initial value
-        auto& i = outer_scope.create_local_var(m_var_name, m_initial_value->eval(outer_scope).release());
+        Variable initial_value = m_initial_value->eval(outer_scope);
+        auto& i = outer_scope.create_local_var(m_var_name, nullptr, m_var_slot, m_var_captured);
+        i = initial_value;
+
+        Variable max;
+        Variable step;
+        if (m_const_bounds)
+        {
+            max = m_max_value->eval(outer_scope);
+            step = m_step_value->eval(outer_scope);
+        }
+
+        // numbers count natively, until the body stores something else
+        bool is_numeric = m_const_bounds && max.is_number() && step.is_number();
+        float max_number = is_numeric ? max.number() : 0;   // same precision as `Variable::cmp`
+        double step_number = is_numeric ? step.number() : 0;
+
+        Scope inner_scope(outer_scope);
         while (true)
         {
             // check maximum
+            is_numeric = is_numeric && i.is_number();
+            if (is_numeric)
             {
-                Variable max = m_max_value->eval(outer_scope);
-                if (i.cmp(max) >= 0)    // ge
+                if (!(static_cast<float>(i.number()) < max_number))
                 {
                     break;
                 }
             }
-
-            // execute body block
+            else
             {
-                Scope inner_scope(outer_scope);
-                result = m_body->eval(inner_scope);
-                if (inner_scope.is_breaking())
+                if (!m_const_bounds)
+                {
+                    max = m_max_value->eval(outer_scope);
+                }
+                if (i.cmp(max) >= 0)    // ge
                 {
                     break;
                 }
             }
 
+            // execute body block
+            result = m_body->eval(inner_scope);
+            inner_scope.clear();
+            if (ends_loop(completion))
+            {
+                break;
+            }
+
             // add step
+            if (is_numeric && i.is_number())
             {
-                Variable step = m_step_value->eval(outer_scope);
+                i = Variable::make_number(i.number() + step_number);
+            }
+            else
+            {
+                if (!m_const_bounds)
+                {
+                    step = m_step_value->eval(outer_scope);
+                }
                 i = i + step;
             }
         }
 
-        return result ? result : new Void();
+        return result ? result : Variable::make_void();
     }
 
-    Bytecode ExprFor::bytecode(VarNameMap& var_name_map) const
+    void ExprFor::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() <<
-            static_cast<uint8_t>(OpCode::control_for) <<
-            var_name_map.id_from_name(m_var_name.name()) <<
-            m_initial_value->bytecode(var_name_map) <<
-            m_max_value->bytecode(var_name_map) <<
-            m_step_value->bytecode(var_name_map) <<
-            m_body->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::control_for) << var_name_map.id_from_name(m_var_name.name());
+        m_initial_value->bytecode(bytecode, var_name_map);
+        m_max_value->bytecode(bytecode, var_name_map);
+        m_step_value->bytecode(bytecode, var_name_map);
+        m_body->bytecode(bytecode, var_name_map);
     }
 
 
@@ -585,6 +715,8 @@ namespace creek
     // @param  body            Expression to execute in each loop.
     ExprForIn::ExprForIn(VarName var_name, Expression* range, Expression* body) :
         m_var_name(var_name),
+        m_var_slot(Scope::no_slot),
+        m_var_captured(false),
         m_range(range),
         m_body(body)
     {
@@ -610,32 +742,45 @@ namespace creek
         );
     }
 
+    void ExprForIn::resolve(VarResolver& resolver)
+    {
+        m_range->resolve(resolver);
+        resolver.begin_scope();
+        m_var_slot = resolver.declare(m_var_name, m_var_captured);
+        resolver.begin_scope();
+        m_body->resolve(resolver);
+        resolver.end_scope();
+        resolver.end_scope();
+    }
+
     Variable ExprForIn::eval(Scope& scope)
     {
         Variable result;
         Variable range(m_range->eval(scope));
-        Variable keys(range->call_method("keys", {}));
+        Variable iterator(range->iter());
 
         Scope outer_scope(scope);
-        auto& item = outer_scope.create_local_var(m_var_name, nullptr);
-        for (auto& key : keys->vector_value())
+        Scope::Completion& completion = outer_scope.completion();
+        auto& item = outer_scope.create_local_var(m_var_name, nullptr, m_var_slot, m_var_captured);
+        Scope inner_scope(outer_scope);
+        while (iterator->next(item))
         {
-            item = range.index(key);
-
-            Scope inner_scope(outer_scope);
             result = m_body->eval(inner_scope);
+            inner_scope.clear();
+            if (ends_loop(completion))
+            {
+                break;
+            }
         }
 
-        return result ? result : new Void();
+        return result ? result : Variable::make_void();
     }
 
-    Bytecode ExprForIn::bytecode(VarNameMap& var_name_map) const
+    void ExprForIn::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() <<
-            static_cast<uint8_t>(OpCode::control_for_in) <<
-            var_name_map.id_from_name(m_var_name.name()) <<
-            m_range->bytecode(var_name_map) <<
-            m_body->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::control_for_in) << var_name_map.id_from_name(m_var_name.name());
+        m_range->bytecode(bytecode, var_name_map);
+        m_body->bytecode(bytecode, var_name_map);
     }
 
 
@@ -646,6 +791,8 @@ namespace creek
     ExprTry::ExprTry(Expression* try_body, VarName id, Expression* catch_body) :
         m_try_body(try_body),
         m_id(id),
+        m_id_slot(Scope::no_slot),
+        m_id_captured(false),
         m_catch_body(catch_body)
     {
 
@@ -666,6 +813,15 @@ namespace creek
         return new ExprTry(m_try_body->const_optimize(), m_id, m_catch_body->const_optimize());
     }
 
+    void ExprTry::resolve(VarResolver& resolver)
+    {
+        m_try_body->resolve(resolver);
+        resolver.begin_scope();
+        m_id_slot = resolver.declare(m_id, m_id_captured);
+        m_catch_body->resolve(resolver);
+        resolver.end_scope();
+    }
+
     Variable ExprTry::eval(Scope& scope)
     {
         try
@@ -675,30 +831,29 @@ namespace creek
         catch (const Exception& e)
         {
             Scope inner(scope);
-            inner.create_local_var(m_id, new Null());
+            inner.create_local_var(m_id, nullptr, m_id_slot, m_id_captured) = Variable::make_null();
             return m_catch_body->eval(inner);
         }
         catch (const std::exception& e)
         {
             Scope inner(scope);
-            inner.create_local_var(m_id, new Null());
-            return m_catch_body->eval(scope);
+            inner.create_local_var(m_id, nullptr, m_id_slot, m_id_captured) = Variable::make_null();
+            return m_catch_body->eval(inner);
         }
         catch (...)
         {
             Scope inner(scope);
-            inner.create_local_var(m_id, new Null());
-            return m_catch_body->eval(scope);
+            inner.create_local_var(m_id, nullptr, m_id_slot, m_id_captured) = Variable::make_null();
+            return m_catch_body->eval(inner);
         }
     }
 
-    Bytecode ExprTry::bytecode(VarNameMap& var_name_map) const
+    void ExprTry::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode()
-            << static_cast<uint8_t>(OpCode::control_try)
-            << m_try_body->bytecode(var_name_map)
-            << var_name_map.id_from_name(m_id.name())
-            << m_catch_body->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::control_try);
+        m_try_body->bytecode(bytecode, var_name_map);
+        bytecode << var_name_map.id_from_name(m_id.name());
+        m_catch_body->bytecode(bytecode, var_name_map);
     }
 
 
@@ -724,15 +879,21 @@ namespace creek
         return new ExprThrow(m_value->const_optimize());
     }
 
+    void ExprThrow::resolve(VarResolver& resolver)
+    {
+        m_value->resolve(resolver);
+    }
+
     Variable ExprThrow::eval(Scope& scope)
     {
         throw m_value->eval(scope);
-        return new Void(); // just in case
+        return Variable::make_void(); // just in case
     }
 
-    Bytecode ExprThrow::bytecode(VarNameMap& var_name_map) const
+    void ExprThrow::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() << static_cast<uint8_t>(OpCode::control_throw) << m_value->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::control_throw);
+        m_value->bytecode(bytecode, var_name_map);
     }
 
 
@@ -758,16 +919,22 @@ namespace creek
         return new ExprReturn(m_value->const_optimize());
     }
 
+    void ExprReturn::resolve(VarResolver& resolver)
+    {
+        m_value->resolve(resolver);
+    }
+
     Variable ExprReturn::eval(Scope& scope)
     {
         Variable v = m_value->eval(scope);
-        scope.return_point()->is_returning = true;
+        scope.completion() = Scope::Completion::returning;
         return v.release();
     }
 
-    Bytecode ExprReturn::bytecode(VarNameMap& var_name_map) const
+    void ExprReturn::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() << static_cast<uint8_t>(OpCode::control_return) << m_value->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::control_return);
+        m_value->bytecode(bytecode, var_name_map);
     }
 
 
@@ -793,15 +960,21 @@ namespace creek
         return new ExprBreak(m_value->const_optimize());
     }
 
+    void ExprBreak::resolve(VarResolver& resolver)
+    {
+        m_value->resolve(resolver);
+    }
+
     Variable ExprBreak::eval(Scope& scope)
     {
         Variable v = m_value->eval(scope);
-        scope.break_point()->is_breaking = true;
+        scope.completion() = Scope::Completion::breaking;
         return v.release();
     }
 
-    Bytecode ExprBreak::bytecode(VarNameMap& var_name_map) const
+    void ExprBreak::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() << static_cast<uint8_t>(OpCode::control_break) << m_value->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::control_break);
+        m_value->bytecode(bytecode, var_name_map);
     }
 }
@@ -27,9 +27,10 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::vector< std::unique_ptr<Expression> > m_expressions;
@@ -47,9 +48,10 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::unique_ptr<Expression> m_value;
@@ -70,9 +72,10 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::unique_ptr<Expression> m_condition;
@@ -111,9 +114,10 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::unique_ptr<Expression> m_condition;
@@ -134,9 +138,10 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::unique_ptr<Expression> m_body;
@@ -156,9 +161,10 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::unique_ptr<Expression> m_condition;
@@ -183,16 +189,20 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         VarName m_var_name;
+        unsigned m_var_slot;
+        bool m_var_captured;
         std::unique_ptr<Expression> m_initial_value;
         std::unique_ptr<Expression> m_max_value;
         std::unique_ptr<Expression> m_step_value;
         std::unique_ptr<Expression> m_body;
+        bool m_const_bounds; ///< Are maximum and step constant? They are evaluated once.
     };
 
 
@@ -210,12 +220,15 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         VarName m_var_name;
+        unsigned m_var_slot;
+        bool m_var_captured;
         std::unique_ptr<Expression> m_range;
         std::unique_ptr<Expression> m_body;
     };
@@ -236,13 +249,16 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::unique_ptr<Expression> m_try_body;
         VarName m_id;
+        unsigned m_id_slot;
+        bool m_id_captured;
         std::unique_ptr<Expression> m_catch_body;
     };
 
@@ -259,9 +275,10 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::unique_ptr<Expression> m_value;
@@ -280,9 +297,10 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::unique_ptr<Expression> m_value;
@@ -302,9 +320,10 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
         
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::unique_ptr<Expression> m_value;
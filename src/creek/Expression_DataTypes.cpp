@@ -3,10 +3,65 @@
 #include <creek/GlobalScope.hpp>
 #include <creek/Scope.hpp>
 #include <creek/Variable.hpp>
+#include <creek/VarResolver.hpp>
 
 
 namespace creek
 {
+    namespace
+    {
+        // Create the definition of a function declared in a scope.
+        // Closures get an environment with the variables they capture; the
+        // other resolved functions are declared in the root scope.
+        Function::Value make_definition(Scope& scope, const std::vector<VarName>& arg_names, bool is_variadic,
+                                        const std::shared_ptr<Expression>& body, const std::shared_ptr<FunctionVars>& vars)
+        {
+            if (!vars)
+            {
+                return std::make_shared<Function::Definition>(scope, arg_names, is_variadic, body);
+            }
+
+            std::shared_ptr<Scope> environment;
+            for (size_t i = 0; i < vars->captures.size(); ++i)
+            {
+                auto& capture = vars->captures[i];
+                std::shared_ptr<Variable> variable;
+                if (capture.slot != Scope::no_slot)
+                {
+                    variable = scope.capture_var(capture.var_name, capture.depth, capture.slot);
+                }
+                // else looked up in the root scope when called
+
+                if (variable)
+                {
+                    if (!environment)
+                    {
+                        environment = std::make_shared<Scope>(scope.root_scope(), Scope::Frame::closure, vars->captures.size());
+                    }
+                    environment->bind_var(capture.var_name, variable, i);
+                }
+            }
+
+            if (environment)
+            {
+                return std::make_shared<Function::Definition>(environment, arg_names, is_variadic, body, vars);
+            }
+            return std::make_shared<Function::Definition>(scope.root_scope(), arg_names, is_variadic, body, vars);
+        }
+
+        // IDs of the names of the captured variables, for the function table
+        std::vector<uint32_t> capture_ids(const FunctionVars& vars, VarNameMap& var_name_map)
+        {
+            std::vector<uint32_t> ids;
+            for (auto& capture : vars.captures)
+            {
+                ids.push_back(var_name_map.id_from_name(capture.var_name.name()));
+            }
+            return ids;
+        }
+    }
+
+
     // `ExprVoid` constructor.
     ExprVoid::ExprVoid()
     {
@@ -25,12 +80,12 @@ namespace creek
 
     Variable ExprVoid::eval(Scope& scope)
     {
-        return Variable(new Void());
+        return Variable::make_void();
     }
 
-    Bytecode ExprVoid::bytecode(VarNameMap& var_name_map) const
+    void ExprVoid::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() << static_cast<uint8_t>(OpCode::data_void);
+        bytecode << static_cast<uint8_t>(OpCode::data_void);
     }
 
 
@@ -52,12 +107,12 @@ namespace creek
 
     Variable ExprNull::eval(Scope& scope)
     {
-        return Variable(new Null());
+        return Variable::make_null();
     }
 
-    Bytecode ExprNull::bytecode(VarNameMap& var_name_map) const
+    void ExprNull::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() << static_cast<uint8_t>(OpCode::data_null);
+        bytecode << static_cast<uint8_t>(OpCode::data_null);
     }
 
 
@@ -80,15 +135,13 @@ namespace creek
 
     Variable ExprBoolean::eval(Scope& scope)
     {
-        return Variable(new Boolean(m_value));
+        return Variable::make_boolean(m_value);
     }
 
-    Bytecode ExprBoolean::bytecode(VarNameMap& var_name_map) const
+    void ExprBoolean::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        Bytecode b;
-        b << static_cast<uint8_t>(OpCode::data_boolean);
-        b << m_value;
-        return b;
+        bytecode << static_cast<uint8_t>(OpCode::data_boolean);
+        bytecode << m_value;
     }
 
 
@@ -111,12 +164,12 @@ namespace creek
 
     Variable ExprNumber::eval(Scope& scope)
     {
-        return Variable(new Number(m_value));
+        return Variable::make_number(m_value);
     }
 
-    Bytecode ExprNumber::bytecode(VarNameMap& var_name_map) const
+    void ExprNumber::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() << static_cast<uint8_t>(OpCode::data_number) << m_value;
+        bytecode << static_cast<uint8_t>(OpCode::data_number) << var_name_map.id_from_number(m_value);
     }
 
 
@@ -142,9 +195,9 @@ namespace creek
         return Variable(new String(m_value));
     }
 
-    Bytecode ExprString::bytecode(VarNameMap& var_name_map) const
+    void ExprString::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() << static_cast<uint8_t>(OpCode::data_string) << m_value;
+        bytecode << static_cast<uint8_t>(OpCode::data_string) << var_name_map.id_from_string(m_value);
     }
 
 
@@ -170,9 +223,9 @@ namespace creek
         return Variable(new Identifier(m_value));
     }
 
-    Bytecode ExprIdentifier::bytecode(VarNameMap& var_name_map) const
+    void ExprIdentifier::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() << static_cast<uint8_t>(OpCode::data_identifier) << var_name_map.id_from_name(m_value.name());
+        bytecode << static_cast<uint8_t>(OpCode::data_identifier) << var_name_map.id_from_name(m_value.name());
     }
 
 
@@ -216,6 +269,14 @@ namespace creek
         return new ExprVector(new_values);
     }
 
+    void ExprVector::resolve(VarResolver& resolver)
+    {
+        for (auto& v : m_values)
+        {
+            v->resolve(resolver);
+        }
+    }
+
     Variable ExprVector::eval(Scope& scope)
     {
         Vector::Value new_value = std::make_shared< std::vector<Variable> >();
@@ -226,16 +287,14 @@ namespace creek
         return Variable(new Vector(new_value));
     }
 
-    Bytecode ExprVector::bytecode(VarNameMap& var_name_map) const
+    void ExprVector::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        Bytecode b;
-        b << static_cast<uint8_t>(OpCode::data_vector);
-        b << static_cast<uint32_t>(m_values.size());
+        bytecode << static_cast<uint8_t>(OpCode::data_vector);
+        bytecode << static_cast<uint32_t>(m_values.size());
         for (auto& value : m_values)
         {
-            b << value->bytecode(var_name_map);
+            value->bytecode(bytecode, var_name_map);
         }
-        return b;
     }
 
 
@@ -278,6 +337,15 @@ namespace creek
         return new ExprMap(new_pairs);
     }
 
+    void ExprMap::resolve(VarResolver& resolver)
+    {
+        for (auto& p : m_pairs)
+        {
+            p.key->resolve(resolver);
+            p.value->resolve(resolver);
+        }
+    }
+
     Variable ExprMap::eval(Scope& scope)
     {
         Map::Value new_value = std::make_shared<Map::Definition>();
@@ -285,22 +353,20 @@ namespace creek
         {
             Variable key = p.key->eval(scope);
             Variable value = p.value->eval(scope);
-            (*new_value)[Map::Key(key.release())] = value;
+            new_value->get_or_add(*key) = value;
         }
         return Variable(new Map(new_value));
     }
 
-    Bytecode ExprMap::bytecode(VarNameMap& var_name_map) const
+    void ExprMap::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        Bytecode b;
-        b << static_cast<uint8_t>(OpCode::data_map);
-        b << static_cast<uint32_t>(m_pairs.size());
+        bytecode << static_cast<uint8_t>(OpCode::data_map);
+        bytecode << static_cast<uint32_t>(m_pairs.size());
         for (auto& p : m_pairs)
         {
-            b << p.key->bytecode(var_name_map);
-            b << p.value->bytecode(var_name_map);
+            p.key->bytecode(bytecode, var_name_map);
+            p.value->bytecode(bytecode, var_name_map);
         }
-        return b;
     }
 
 
@@ -320,17 +386,19 @@ namespace creek
     // @param  arg_names   Names of arguments.
     // @param  variadic    Create a variadic function.
     // @param  body        Function body block.
-    ExprFunction::ExprFunction(const std::vector<VarName>& arg_names, bool variadic, std::shared_ptr<Expression> body) :
+    // @param  vars        Variables of the body, if already resolved.
+    ExprFunction::ExprFunction(const std::vector<VarName>& arg_names, bool variadic, std::shared_ptr<Expression> body, const std::shared_ptr<FunctionVars>& vars) :
         m_arg_names(arg_names),
         m_variadic(variadic),
-        m_body(body)
+        m_body(body),
+        m_vars(vars)
     {
 
     }
 
     Expression* ExprFunction::clone() const
     {
-        return new ExprFunction(m_arg_names, m_variadic, m_body);
+        return new ExprFunction(m_arg_names, m_variadic, m_body, m_vars);
     }
 
     bool ExprFunction::is_const() const
@@ -343,25 +411,51 @@ namespace creek
         return new ExprFunction(m_arg_names, m_variadic, m_body->const_optimize());
     }
 
+    void ExprFunction::resolve(VarResolver& resolver)
+    {
+        m_vars = std::make_shared<FunctionVars>();
+        m_definition.reset();
+        resolver.begin_function(*m_vars);
+        for (auto& arg_name : m_arg_names)
+        {
+            resolver.declare(arg_name);
+        }
+        m_body->resolve(resolver);
+        resolver.end_function();
+    }
+
     Variable ExprFunction::eval(Scope& scope)
     {
-        Function::Definition* def = new Function::Definition(scope, m_arg_names, m_variadic, m_body);
-        Function::Value new_value(def);
+        // without captured variables, the definition doesn't change
+        if (m_definition && &m_definition->parent == &scope.root_scope())
+        {
+            return Variable(new Function(m_definition));
+        }
+
+        Function::Value new_value = make_definition(scope, m_arg_names, m_variadic, m_body, m_vars);
+        if (!new_value->environment && m_vars)
+        {
+            m_definition = new_value;
+        }
         return Variable(new Function(new_value));
     }
 
-    Bytecode ExprFunction::bytecode(VarNameMap& var_name_map) const
+    void ExprFunction::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        Bytecode b;
-        b << static_cast<uint8_t>(OpCode::data_function);
-        b << static_cast<uint32_t>(m_arg_names.size());
+        bytecode << static_cast<uint8_t>(OpCode::data_function);
+        bytecode << static_cast<uint32_t>(m_arg_names.size());
         for (auto& arg_name : m_arg_names)
         {
-            b << var_name_map.id_from_name(arg_name.name());
+            bytecode << var_name_map.id_from_name(arg_name.name());
+        }
+        bytecode << m_variadic;
+
+        size_t begin = bytecode.size();
+        m_body->bytecode(bytecode, var_name_map);
+        if (m_vars)
+        {
+            bytecode.add_function(begin, bytecode.size(), capture_ids(*m_vars, var_name_map));
         }
-        b << m_variadic;
-        b << m_body->bytecode(var_name_map);
-        return b;
     }
 
 
@@ -409,7 +503,7 @@ namespace creek
         std::vector<MethodDef> new_method_defs;
         for (auto& d : m_method_defs)
         {
-            new_method_defs.emplace_back(d.id, d.arg_names, d.is_variadic, d.body);
+            new_method_defs.push_back(d);
         }
         std::vector<StaticDef> new_static_defs;
         for (auto& d : m_static_defs)
@@ -441,6 +535,22 @@ namespace creek
         return new ExprClass(m_id, m_super_class->const_optimize(), new_method_defs, new_static_defs);
     }
 
+    void ExprClass::resolve(VarResolver& resolver)
+    {
+        m_super_class->resolve(resolver);
+        for (auto& d : m_method_defs)
+        {
+            d.vars = std::make_shared<FunctionVars>();
+            resolver.begin_function(*d.vars);
+            for (auto& arg_name : d.arg_names)
+            {
+                resolver.declare(arg_name);
+            }
+            d.body->resolve(resolver);
+            resolver.end_function();
+        }
+    }
+
     Variable ExprClass::eval(Scope& scope)
     {
         Variable new_class;
@@ -452,14 +562,13 @@ namespace creek
             args.emplace_back(super_class->copy());
             args.emplace_back(new Identifier(m_id));
 
-            Variable func_derive = GlobalScope::class_Class.attr("derive");
+            Variable func_derive = GlobalScope::current().class_Class.attr(VarName::vn_derive);
             new_class = func_derive->call(args);
         }
 
         for (auto& method_def : m_method_defs)
         {
-            Function::Definition* def = new Function::Definition(scope, method_def.arg_names, method_def.is_variadic, method_def.body);
-            Function::Value new_value(def);
+            Function::Value new_value = make_definition(scope, method_def.arg_names, method_def.is_variadic, method_def.body, method_def.vars);
             Variable method = new Function(new_value);
             new_class.attr(method_def.id, method.release());
         }
@@ -475,26 +584,29 @@ namespace creek
         return new_class;
     }
 
-    Bytecode ExprClass::bytecode(VarNameMap& var_name_map) const
+    void ExprClass::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        Bytecode b;
-        b << static_cast<uint8_t>(OpCode::data_class);
-        b << var_name_map.id_from_name(m_id.name());
-        b << m_super_class->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::data_class);
+        bytecode << var_name_map.id_from_name(m_id.name());
+        m_super_class->bytecode(bytecode, var_name_map);
         
-        b << static_cast<uint32_t>(m_method_defs.size());
+        bytecode << static_cast<uint32_t>(m_method_defs.size());
         for (auto& method_def : m_method_defs)
         {
-            b << var_name_map.id_from_name(method_def.id.name());
-            b << static_cast<uint32_t>(method_def.arg_names.size());
+            bytecode << var_name_map.id_from_name(method_def.id.name());
+            bytecode << static_cast<uint32_t>(method_def.arg_names.size());
             for (auto& arg_name : method_def.arg_names)
             {
-                b << var_name_map.id_from_name(arg_name.name());
+                bytecode << var_name_map.id_from_name(arg_name.name());
             }
-            b << method_def.is_variadic;
-            b << method_def.body->bytecode(var_name_map);
-        }
+            bytecode << method_def.is_variadic;
 
-        return b;
+            size_t begin = bytecode.size();
+            method_def.body->bytecode(bytecode, var_name_map);
+            if (method_def.vars)
+            {
+                bytecode.add_function(begin, bytecode.size(), capture_ids(*method_def.vars, var_name_map));
+            }
+        }
     }
 }
@@ -33,7 +33,7 @@ namespace creek
         bool is_const() const override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
     };
 
 
@@ -49,7 +49,7 @@ namespace creek
         bool is_const() const override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
     };
 
 
@@ -66,7 +66,7 @@ namespace creek
         bool is_const() const override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         Boolean::Value m_value;
@@ -86,7 +86,7 @@ namespace creek
         bool is_const() const override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         Number::Value m_value;
@@ -106,7 +106,7 @@ namespace creek
         bool is_const() const override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         String::Value m_value;
@@ -126,7 +126,7 @@ namespace creek
         bool is_const() const override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         Identifier::Value m_value;
@@ -145,9 +145,10 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::vector< std::unique_ptr<Expression> > m_values;
@@ -179,9 +180,10 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::vector<Pair> m_pairs;
@@ -203,8 +205,10 @@ namespace creek
         /// @param  arg_names   Names of arguments.
         /// @param  variadic    Create a variadic function.
         /// @param  body        Function body block.
+        /// @param  vars        Variables of the body, if already resolved.
         ExprFunction(const std::vector<VarName>& arg_names, bool variadic,
-                     std::shared_ptr<Expression> body);
+                     std::shared_ptr<Expression> body,
+                     const std::shared_ptr<FunctionVars>& vars = nullptr);
 
         /// @brief  Get a copy.
         /// The cloned expression shares the body expression.
@@ -215,14 +219,17 @@ namespace creek
         /// @brief  Get an optimized copy.
         /// The cloned expression has an optimized body expression.
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::vector<VarName> m_arg_names;
         bool m_variadic;
         std::shared_ptr<Expression> m_body;
+        std::shared_ptr<FunctionVars> m_vars;   ///< Variables of the body, given by `VarResolver`.
+        Function::Value m_definition;           ///< Definition shared while nothing is captured.
     };
 
 
@@ -279,6 +286,7 @@ namespace creek
             std::vector<VarName> arg_names; ///< Argument names.
             bool is_variadic; ///< Is this method variadic?
             std::shared_ptr<Expression> body; ///< Expression evaluated when called.
+            std::shared_ptr<FunctionVars> vars; ///< Variables of the body, given by `VarResolver`.
         };
 
         /// @brief  Class static member definition.
@@ -310,9 +318,10 @@ namespace creek
         /// @brief  Get an optimized copy.
         /// The cloned expression has an optimized body expression.
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         VarName m_id;
@@ -4,6 +4,7 @@
 
 #include <creek/Scope.hpp>
 #include <creek/Variable.hpp>
+#include <creek/VarResolver.hpp>
 
 
 namespace creek
@@ -30,6 +31,11 @@ namespace creek
         return new ExprPrint(m_expression->const_optimize());
     }
 
+    void ExprPrint::resolve(VarResolver& resolver)
+    {
+        m_expression->resolve(resolver);
+    }
+
     Variable ExprPrint::eval(Scope& scope)
     {
         // Data* data = m_expression->eval(scope);
@@ -40,8 +46,9 @@ namespace creek
         return v;
     }
 
-    Bytecode ExprPrint::bytecode(VarNameMap& var_name_map) const
+    void ExprPrint::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() << static_cast<uint8_t>(OpCode::print) << m_expression->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::print);
+        m_expression->bytecode(bytecode, var_name_map);
     }
 }
\ No newline at end of file
@@ -26,9 +26,10 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
         
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::unique_ptr<Expression> m_expression;
@@ -33,19 +33,17 @@ namespace creek
         return Variable(new DynCFunction(scope, m_arg_names, m_is_variadic, m_library_path, m_func_name));
     }
 
-    Bytecode ExprDynFunc::bytecode(VarNameMap& var_name_map) const
+    void ExprDynFunc::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        Bytecode b;
-        b << static_cast<uint8_t>(OpCode::dyn_func);
-        b << static_cast<uint32_t>(m_arg_names.size());
+        bytecode << static_cast<uint8_t>(OpCode::dyn_func);
+        bytecode << static_cast<uint32_t>(m_arg_names.size());
         for (auto& arg_name : m_arg_names)
         {
-            b << var_name_map.id_from_name(arg_name.name());
+            bytecode << var_name_map.id_from_name(arg_name.name());
         }
-        b << m_is_variadic;
-        b << m_library_path;
-        b << m_func_name;
-        return b;
+        bytecode << m_is_variadic;
+        bytecode << var_name_map.id_from_string(m_library_path);
+        bytecode << var_name_map.id_from_string(m_func_name);
     }
 
 
@@ -100,13 +98,13 @@ namespace creek
         Variable new_class;
 
         {
-            Variable super_class = GlobalScope::class_UserData;
+            Variable super_class = GlobalScope::current().class_UserData;
 
             std::vector< std::unique_ptr<Data> > args;
             args.emplace_back(super_class->copy());
             args.emplace_back(new Identifier(m_id));
 
-            Variable func_derive = GlobalScope::class_Class.attr("derive");
+            Variable func_derive = GlobalScope::current().class_Class.attr(VarName::vn_derive);
             new_class = func_derive->call(args);
         }
 
@@ -136,31 +134,29 @@ namespace creek
         return new_class;
     }
 
-    Bytecode ExprDynClass::bytecode(VarNameMap& var_name_map) const
+    void ExprDynClass::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        Bytecode b;
-        b << static_cast<uint8_t>(OpCode::dyn_class);
-        b << var_name_map.id_from_name(m_id.name());
+        bytecode << static_cast<uint8_t>(OpCode::dyn_class);
+        bytecode << var_name_map.id_from_name(m_id.name());
 
-        b << static_cast<uint32_t>(m_method_defs.size());
+        bytecode << static_cast<uint32_t>(m_method_defs.size());
         for (auto& method_def : m_method_defs)
         {
-            b << var_name_map.id_from_name(method_def.id.name());
-            b << static_cast<uint32_t>(method_def.arg_names.size());
+            bytecode << var_name_map.id_from_name(method_def.id.name());
+            bytecode << static_cast<uint32_t>(method_def.arg_names.size());
             for (auto& arg_name : method_def.arg_names)
             {
-                b << var_name_map.id_from_name(arg_name.name());
+                bytecode << var_name_map.id_from_name(arg_name.name());
             }
-            b << method_def.is_variadic;
+            bytecode << method_def.is_variadic;
         }
 
-        b << static_cast<uint32_t>(m_static_defs.size());
+        bytecode << static_cast<uint32_t>(m_static_defs.size());
         for (auto& static_def : m_static_defs)
         {
-            b << var_name_map.id_from_name(static_def.id.name());
+            bytecode << var_name_map.id_from_name(static_def.id.name());
         }
 
-        b << m_library_path;
-        return b;
+        bytecode << var_name_map.id_from_string(m_library_path);
     }
 }
@@ -30,7 +30,7 @@ namespace creek
         Expression* clone() const override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::vector<VarName> m_arg_names;
@@ -84,7 +84,7 @@ namespace creek
         Expression* clone() const override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         VarName m_id;
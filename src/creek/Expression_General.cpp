@@ -2,17 +2,18 @@
 
 #include <creek/Scope.hpp>
 #include <creek/Variable.hpp>
+#include <creek/VarResolver.hpp>
 #include <creek/Void.hpp>
 
 
 namespace creek
 {
     // @brief  `ExprConst` constructor.
-    // @param  data    Constant data to be copied.
+    // @param  data    Constant data, shared with the evaluated values.
     ExprConst::ExprConst(Data* data) :
         m_data(data)
     {
-
+        m_data.unbox();
     }
 
     Expression* ExprConst::clone() const
@@ -27,13 +28,13 @@ namespace creek
 
     Variable ExprConst::eval(Scope& scope)
     {
-        return m_data->copy();
+        return m_data;
     }
 
-    Bytecode ExprConst::bytecode(VarNameMap& var_name_map) const
+    void ExprConst::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
         std::unique_ptr<Expression> e(m_data->to_expression());
-        return e->bytecode(var_name_map);
+        e->bytecode(bytecode, var_name_map);
     }
 
 
@@ -74,30 +75,40 @@ namespace creek
         return new ExprCall(m_function->const_optimize(), new_args);
     }
 
+    void ExprCall::resolve(VarResolver& resolver)
+    {
+        m_function->resolve(resolver);
+        for (auto& a : m_args)
+        {
+            a->resolve(resolver);
+        }
+    }
+
     Variable ExprCall::eval(Scope& scope)
     {
         Variable function = m_function->eval(scope);
 
         std::vector< std::unique_ptr<Data> > args;
+        args.reserve(m_args.size());
         for (auto& a : m_args)
         {
             args.emplace_back(a->eval(scope).release());
         }
 
-        return function->call(args);
+        Variable result(function->call(args));
+        result.unbox();
+        return result;
     }
 
-    Bytecode ExprCall::bytecode(VarNameMap& var_name_map) const
+    void ExprCall::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        Bytecode b;
-        b << static_cast<uint8_t>(OpCode::call);
-        b << m_function->bytecode(var_name_map);
-        b << static_cast<uint32_t>(m_args.size());
+        bytecode << static_cast<uint8_t>(OpCode::call);
+        m_function->bytecode(bytecode, var_name_map);
+        bytecode << static_cast<uint32_t>(m_args.size());
         for (auto& arg : m_args)
         {
-            b << arg->bytecode(var_name_map);
+            arg->bytecode(bytecode, var_name_map);
         }
-        return b;
     }
 
 
@@ -140,10 +151,21 @@ namespace creek
         return new ExprVariadicCall(m_function->const_optimize(), new_args, m_vararg->const_optimize());
     }
 
+    void ExprVariadicCall::resolve(VarResolver& resolver)
+    {
+        for (auto& a : m_args)
+        {
+            a->resolve(resolver);
+        }
+        m_vararg->resolve(resolver);
+        m_function->resolve(resolver);
+    }
+
     Variable ExprVariadicCall::eval(Scope& scope)
     {
         // normal arguments
         std::vector< std::unique_ptr<Data> > args;
+        args.reserve(m_args.size());
         for (auto& a : m_args)
         {
             args.emplace_back(a->eval(scope).release());
@@ -161,18 +183,16 @@ namespace creek
         return function->call(args);
     }
 
-    Bytecode ExprVariadicCall::bytecode(VarNameMap& var_name_map) const
+    void ExprVariadicCall::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        Bytecode b;
-        b << static_cast<uint8_t>(OpCode::variadic_call);
-        b << m_function->bytecode(var_name_map);
-        b << static_cast<uint32_t>(m_args.size());
+        bytecode << static_cast<uint8_t>(OpCode::variadic_call);
+        m_function->bytecode(bytecode, var_name_map);
+        bytecode << static_cast<uint32_t>(m_args.size());
         for (auto& arg : m_args)
         {
-            b << arg->bytecode(var_name_map);
+            arg->bytecode(bytecode, var_name_map);
         }
-        b << m_vararg->bytecode(var_name_map);
-        return b;
+        m_vararg->bytecode(bytecode, var_name_map);
     }
 
 
@@ -215,34 +235,43 @@ namespace creek
         return new ExprCallMethod(m_object->const_optimize(), m_method_name, new_args);
     }
 
+    void ExprCallMethod::resolve(VarResolver& resolver)
+    {
+        m_object->resolve(resolver);
+        for (auto& a : m_args)
+        {
+            a->resolve(resolver);
+        }
+    }
+
     Variable ExprCallMethod::eval(Scope& scope)
     {
         Variable object = m_object->eval(scope);
-        Variable class_obj = object->get_class();
-        Variable method = class_obj->attr(m_method_name);
+        Variable method = m_method_cache.method(object, m_method_name);
 
         std::vector< std::unique_ptr<Data> > args;
+        args.reserve(m_args.size() + 1);
         args.emplace_back(object->copy());
         for (auto& a : m_args)
         {
             args.emplace_back(a->eval(scope).release());
         }
 
-        return method->call(args);
+        Variable result(method->call(args));
+        result.unbox();
+        return result;
     }
 
-    Bytecode ExprCallMethod::bytecode(VarNameMap& var_name_map) const
+    void ExprCallMethod::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        Bytecode b;
-        b << static_cast<uint8_t>(OpCode::call_method);
-        b << m_object->bytecode(var_name_map);
-        b << var_name_map.id_from_name(m_method_name.name());
-        b << static_cast<uint32_t>(m_args.size());
+        bytecode << static_cast<uint8_t>(OpCode::call_method);
+        m_object->bytecode(bytecode, var_name_map);
+        bytecode << var_name_map.id_from_name(m_method_name.name());
+        bytecode << static_cast<uint32_t>(m_args.size());
         for (auto& arg : m_args)
         {
-            b << arg->bytecode(var_name_map);
+            arg->bytecode(bytecode, var_name_map);
         }
-        return b;
     }
 
 
@@ -287,10 +316,21 @@ namespace creek
         return new ExprVariadicCallMethod(m_object->const_optimize(), m_method_name, new_args, m_vararg->const_optimize());
     }
 
+    void ExprVariadicCallMethod::resolve(VarResolver& resolver)
+    {
+        for (auto& a : m_args)
+        {
+            a->resolve(resolver);
+        }
+        m_vararg->resolve(resolver);
+        m_object->resolve(resolver);
+    }
+
     Variable ExprVariadicCallMethod::eval(Scope& scope)
     {
         // normal arguments
         std::vector< std::unique_ptr<Data> > args;
+        args.reserve(m_args.size());
         for (auto& a : m_args)
         {
             args.emplace_back(a->eval(scope).release());
@@ -305,24 +345,21 @@ namespace creek
 
         // call method
         Variable object = m_object->eval(scope);
-        Variable class_obj = object->get_class();
-        Variable method = class_obj->attr(m_method_name);
+        Variable method = m_method_cache.method(object, m_method_name);
         return method->call(args);
     }
 
-    Bytecode ExprVariadicCallMethod::bytecode(VarNameMap& var_name_map) const
+    void ExprVariadicCallMethod::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        Bytecode b;
-        b << static_cast<uint8_t>(OpCode::variadic_call_method);
-        b << m_object->bytecode(var_name_map);
-        b << var_name_map.id_from_name(m_method_name.name());
-        b << static_cast<uint32_t>(m_args.size());
+        bytecode << static_cast<uint8_t>(OpCode::variadic_call_method);
+        m_object->bytecode(bytecode, var_name_map);
+        bytecode << var_name_map.id_from_name(m_method_name.name());
+        bytecode << static_cast<uint32_t>(m_args.size());
         for (auto& arg : m_args)
         {
-            b << arg->bytecode(var_name_map);
+            arg->bytecode(bytecode, var_name_map);
         }
-        b << m_vararg->bytecode(var_name_map);
-        return b;
+        m_vararg->bytecode(bytecode, var_name_map);
     }
 
 
@@ -351,6 +388,12 @@ namespace creek
         return new ExprIndexGet(m_array->const_optimize(), m_index->const_optimize());
     }
 
+    void ExprIndexGet::resolve(VarResolver& resolver)
+    {
+        m_array->resolve(resolver);
+        m_index->resolve(resolver);
+    }
+
     Variable ExprIndexGet::eval(Scope& scope)
     {
         Variable a = m_array->eval(scope);
@@ -358,9 +401,11 @@ namespace creek
         return a.index(i);
     }
 
-    Bytecode ExprIndexGet::bytecode(VarNameMap& var_name_map) const
+    void ExprIndexGet::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() << static_cast<uint8_t>(OpCode::index_get) << m_array->bytecode(var_name_map) << m_index->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::index_get);
+        m_array->bytecode(bytecode, var_name_map);
+        m_index->bytecode(bytecode, var_name_map);
     }
 
 
@@ -391,6 +436,13 @@ namespace creek
         return new ExprIndexSet(m_array->const_optimize(), m_index->const_optimize(), m_value->const_optimize());
     }
 
+    void ExprIndexSet::resolve(VarResolver& resolver)
+    {
+        m_array->resolve(resolver);
+        m_index->resolve(resolver);
+        m_value->resolve(resolver);
+    }
+
     Variable ExprIndexSet::eval(Scope& scope)
     {
         Variable a = m_array->eval(scope);
@@ -399,9 +451,12 @@ namespace creek
         return a.index(i, v);
     }
 
-    Bytecode ExprIndexSet::bytecode(VarNameMap& var_name_map) const
+    void ExprIndexSet::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() << static_cast<uint8_t>(OpCode::index_set) << m_array->bytecode(var_name_map) << m_index->bytecode(var_name_map) << m_value->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::index_set);
+        m_array->bytecode(bytecode, var_name_map);
+        m_index->bytecode(bytecode, var_name_map);
+        m_value->bytecode(bytecode, var_name_map);
     }
 
 
@@ -439,15 +494,22 @@ namespace creek
         }
     }
 
+    void ExprAttrGet::resolve(VarResolver& resolver)
+    {
+        m_object->resolve(resolver);
+    }
+
     Variable ExprAttrGet::eval(Scope& scope)
     {
         Variable o = m_object->eval(scope);
-        return o.attr(m_attr);
+        return m_attr_cache.attr(o, m_attr);
     }
 
-    Bytecode ExprAttrGet::bytecode(VarNameMap& var_name_map) const
+    void ExprAttrGet::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() << static_cast<uint8_t>(OpCode::attr_get) << m_object->bytecode(var_name_map) << var_name_map.id_from_name(m_attr.name());
+        bytecode << static_cast<uint8_t>(OpCode::attr_get);
+        m_object->bytecode(bytecode, var_name_map);
+        bytecode << var_name_map.id_from_name(m_attr.name());
     }
 
 
@@ -478,6 +540,12 @@ namespace creek
         return new ExprAttrSet(m_object->const_optimize(), m_attr, m_value->const_optimize());
     }
 
+    void ExprAttrSet::resolve(VarResolver& resolver)
+    {
+        m_object->resolve(resolver);
+        m_value->resolve(resolver);
+    }
+
     Variable ExprAttrSet::eval(Scope& scope)
     {
         Variable o = m_object->eval(scope);
@@ -485,13 +553,12 @@ namespace creek
         return o.attr(m_attr, v);
     }
 
-    Bytecode ExprAttrSet::bytecode(VarNameMap& var_name_map) const
+    void ExprAttrSet::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() <<
-            static_cast<uint8_t>(OpCode::attr_set) <<
-            m_object->bytecode(var_name_map) <<
-            var_name_map.id_from_name(m_attr.name()) <<
-            m_value->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::attr_set);
+        m_object->bytecode(bytecode, var_name_map);
+        bytecode << var_name_map.id_from_name(m_attr.name());
+        m_value->bytecode(bytecode, var_name_map);
     }
 }
 
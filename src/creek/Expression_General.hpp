@@ -6,6 +6,7 @@
 #include <vector>
 
 #include <creek/api_mode.hpp>
+#include <creek/AttrCache.hpp>
 #include <creek/Data.hpp>
 #include <creek/Variable.hpp>
 
@@ -20,25 +21,25 @@ namespace creek
     {
     public:
         /// @brief  `ExprConst` constructor.
-        /// @param  data    Constant data to be copied.
+        /// @param  data    Constant data, shared with the evaluated values.
         ExprConst(Data* data);
 
         Expression* clone() const override;
         bool is_const() const override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
-        std::unique_ptr<Data> m_data;
+        Variable m_data;
     };
 
 
     /// @brief  Unary operation of an expression.
     /// @param  op_code     Operation code.
-    /// @param  method      Data method to call.
+    /// @param  method      Variable method to call.
     /// Returns the result of calling `method` of `expr`.
-    template<OpCode op_code, Data*(Data::*method)()>
+    template<OpCode op_code, Variable(Variable::*method)()>
     class CREEK_API ExprUnary : public Expression
     {
     public:
@@ -49,9 +50,10 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::unique_ptr<Expression> m_expr;
@@ -60,9 +62,9 @@ namespace creek
 
     /// @brief  Binary operation of expressions.
     /// @param  op_code     Operation code.
-    /// @param  method      Data method to call.
+    /// @param  method      Variable method to call.
     /// Returns the result of calling `method` of `lexpr` with `rexpr`.
-    template<OpCode op_code, Data*(Data::*method)(Data*)>
+    template<OpCode op_code, Variable(Variable::*method)(Variable&)>
     class CREEK_API ExprBinary : public Expression
     {
     public:
@@ -74,9 +76,10 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::unique_ptr<Expression> m_lexpr;
@@ -97,9 +100,10 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::unique_ptr<Expression> m_function;
@@ -121,9 +125,10 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::unique_ptr<Expression> m_function;
@@ -145,13 +150,15 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::unique_ptr<Expression> m_object;
         VarName m_method_name;
+        AttrCache m_method_cache;
         std::vector< std::unique_ptr<Expression> > m_args;
     };
 
@@ -171,13 +178,15 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::unique_ptr<Expression> m_object;
         VarName m_method_name;
+        AttrCache m_method_cache;
         std::vector< std::unique_ptr<Expression> > m_args;
         std::unique_ptr<Expression> m_vararg;
     };
@@ -196,9 +205,10 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::unique_ptr<Expression> m_array;
@@ -220,9 +230,10 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::unique_ptr<Expression> m_array;
@@ -244,13 +255,15 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::unique_ptr<Expression> m_object;
         VarName m_attr;
+        AttrCache m_attr_cache;
     };
 
 
@@ -268,9 +281,10 @@ namespace creek
         Expression* clone() const override;
         bool is_const() const override;
         Expression* const_optimize() const override;
+        void resolve(VarResolver& resolver) override;
 
         Variable eval(Scope& scope) override;
-        Bytecode bytecode(VarNameMap& var_name_map) const override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
 
     private:
         std::unique_ptr<Expression> m_object;
@@ -284,45 +298,45 @@ namespace creek
 
 // template implementation
 #include <creek/Scope.hpp>
+#include <creek/VarResolver.hpp>
 
 namespace creek
 {
-    template<OpCode op_code, Data*(Data::*method)()>
+    template<OpCode op_code, Variable(Variable::*method)()>
     ExprUnary<op_code, method>::ExprUnary(Expression* expr) :
         m_expr(expr)
     {
 
     }
 
-    template<OpCode op_code, Data*(Data::*method)()>
+    template<OpCode op_code, Variable(Variable::*method)()>
     Expression* ExprUnary<op_code, method>::clone() const
     {
         return new ExprUnary<op_code, method>(m_expr->clone());
     }
 
-    template<OpCode op_code, Data*(Data::*method)()>
+    template<OpCode op_code, Variable(Variable::*method)()>
     Variable ExprUnary<op_code, method>::eval(Scope& scope)
     {
         Variable v = m_expr->eval(scope);
-        Data* d = ((*v)->*method)();
-        return Variable(d);
+        return (v.*method)();
     }
 
-    template<OpCode op_code, Data*(Data::*method)()>
+    template<OpCode op_code, Variable(Variable::*method)()>
     bool ExprUnary<op_code, method>::is_const() const
     {
         return m_expr->is_const();
     }
 
-    template<OpCode op_code, Data*(Data::*method)()>
+    template<OpCode op_code, Variable(Variable::*method)()>
     Expression* ExprUnary<op_code, method>::const_optimize() const
     {
         if (is_const())
         {
             Scope scope;
             Variable v = m_expr->eval(scope);
-            Data* d = ((*v)->*method)();
-            return new ExprConst(d);
+            Variable d = (v.*method)();
+            return new ExprConst(d.release());
         }
         else
         {
@@ -330,15 +344,22 @@ namespace creek
         }
     }
 
-    template<OpCode op_code, Data*(Data::*method)()>
-    Bytecode ExprUnary<op_code, method>::bytecode(VarNameMap& var_name_map) const
+    template<OpCode op_code, Variable(Variable::*method)()>
+    void ExprUnary<op_code, method>::resolve(VarResolver& resolver)
     {
-        return Bytecode() << static_cast<uint8_t>(op_code) << m_expr->bytecode(var_name_map);
+        m_expr->resolve(resolver);
+    }
+
+    template<OpCode op_code, Variable(Variable::*method)()>
+    void ExprUnary<op_code, method>::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
+    {
+        bytecode << static_cast<uint8_t>(op_code);
+        m_expr->bytecode(bytecode, var_name_map);
     }
 
 
 
-    template<OpCode op_code, Data*(Data::*method)(Data*)>
+    template<OpCode op_code, Variable(Variable::*method)(Variable&)>
     ExprBinary<op_code, method>::ExprBinary(Expression* lexpr, Expression* rexpr) :
         m_lexpr(lexpr),
         m_rexpr(rexpr)
@@ -346,28 +367,27 @@ namespace creek
 
     }
 
-    template<OpCode op_code, Data*(Data::*method)(Data*)>
+    template<OpCode op_code, Variable(Variable::*method)(Variable&)>
     Expression* ExprBinary<op_code, method>::clone() const
     {
         return new ExprBinary<op_code, method>(m_lexpr->clone(), m_rexpr->clone());
     }
 
-    template<OpCode op_code, Data*(Data::*method)(Data*)>
+    template<OpCode op_code, Variable(Variable::*method)(Variable&)>
     Variable ExprBinary<op_code, method>::eval(Scope& scope)
     {
         Variable l = m_lexpr->eval(scope);
         Variable r = m_rexpr->eval(scope);
-        Data* d = ((*l)->*method)(*r);
-        return Variable(d);
+        return (l.*method)(r);
     }
 
-    template<OpCode op_code, Data*(Data::*method)(Data*)>
+    template<OpCode op_code, Variable(Variable::*method)(Variable&)>
     bool ExprBinary<op_code, method>::is_const() const
     {
         return m_lexpr->is_const() && m_rexpr->is_const();
     }
 
-    template<OpCode op_code, Data*(Data::*method)(Data*)>
+    template<OpCode op_code, Variable(Variable::*method)(Variable&)>
     Expression* ExprBinary<op_code, method>::const_optimize() const
     {
         if (is_const())
@@ -375,8 +395,8 @@ namespace creek
             Scope scope;
             Variable l = m_lexpr->eval(scope);
             Variable r = m_rexpr->eval(scope);
-            Data* d = ((*l)->*method)(*r);
-            return new ExprConst(d);
+            Variable d = (l.*method)(r);
+            return new ExprConst(d.release());
         }
         else
         {
@@ -384,9 +404,18 @@ namespace creek
         }
     }
 
-    template<OpCode op_code, Data*(Data::*method)(Data*)>
-    Bytecode ExprBinary<op_code, method>::bytecode(VarNameMap& var_name_map) const
+    template<OpCode op_code, Variable(Variable::*method)(Variable&)>
+    void ExprBinary<op_code, method>::resolve(VarResolver& resolver)
+    {
+        m_lexpr->resolve(resolver);
+        m_rexpr->resolve(resolver);
+    }
+
+    template<OpCode op_code, Variable(Variable::*method)(Variable&)>
+    void ExprBinary<op_code, method>::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() << static_cast<uint8_t>(op_code) << m_lexpr->bytecode(var_name_map) << m_rexpr->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(op_code);
+        m_lexpr->bytecode(bytecode, var_name_map);
+        m_rexpr->bytecode(bytecode, var_name_map);
     }
 }
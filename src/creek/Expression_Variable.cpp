@@ -3,6 +3,7 @@
 #include <creek/GlobalScope.hpp>
 #include <creek/Scope.hpp>
 #include <creek/Variable.hpp>
+#include <creek/VarResolver.hpp>
 
 
 namespace creek
@@ -12,6 +13,8 @@ namespace creek
     // @param  expression  Expression to get value.
     ExprCreateLocal::ExprCreateLocal(VarName var_name, Expression* expression) :
         m_var_name(var_name),
+        m_slot(Scope::no_slot),
+        m_is_captured(false),
         m_expression(expression)
     {
 
@@ -32,26 +35,32 @@ namespace creek
         return new ExprCreateLocal(m_var_name, m_expression->const_optimize());
     }
 
+    void ExprCreateLocal::resolve(VarResolver& resolver)
+    {
+        m_expression->resolve(resolver);
+        m_slot = resolver.declare(m_var_name, m_is_captured);
+    }
+
     Variable ExprCreateLocal::eval(Scope& scope)
     {
         Variable new_value(m_expression->eval(scope));
-        scope.create_local_var(m_var_name, new_value->copy());
+        scope.create_local_var(m_var_name, nullptr, m_slot, m_is_captured) = new_value;
         return new_value;
     }
 
-    Bytecode ExprCreateLocal::bytecode(VarNameMap& var_name_map) const
+    void ExprCreateLocal::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() <<
-            static_cast<uint8_t>(OpCode::var_create_local) <<
-            var_name_map.id_from_name(m_var_name.name()) <<
-            m_expression->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::var_create_local) << var_name_map.id_from_name(m_var_name.name());
+        m_expression->bytecode(bytecode, var_name_map);
     }
 
 
     // @brief  `ExprLoadLocal` constructor.
     // @param  var_name    Variable name.
     ExprLoadLocal::ExprLoadLocal(VarName var_name) :
-        m_var_name(var_name)
+        m_var_name(var_name),
+        m_depth(0),
+        m_slot(Scope::no_slot)
     {
 
     }
@@ -71,16 +80,19 @@ namespace creek
         return new ExprLoadLocal(m_var_name);
     }
 
+    void ExprLoadLocal::resolve(VarResolver& resolver)
+    {
+        resolver.find(m_var_name, m_depth, m_slot);
+    }
+
     Variable ExprLoadLocal::eval(Scope& scope)
     {
-        return Variable(scope.find_var(m_var_name)->copy());
+        return scope.find_var(m_var_name, m_depth, m_slot);
     }
 
-    Bytecode ExprLoadLocal::bytecode(VarNameMap& var_name_map) const
+    void ExprLoadLocal::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() <<
-            static_cast<uint8_t>(OpCode::var_load_local) <<
-            var_name_map.id_from_name(m_var_name.name());
+        bytecode << static_cast<uint8_t>(OpCode::var_load_local) << var_name_map.id_from_name(m_var_name.name());
     }
 
 
@@ -89,6 +101,8 @@ namespace creek
     // @param  expression  Expression to get value.
     ExprStoreLocal::ExprStoreLocal(VarName var_name, Expression* expression) :
         m_var_name(var_name),
+        m_depth(0),
+        m_slot(Scope::no_slot),
         m_expression(expression)
     {
 
@@ -109,20 +123,24 @@ namespace creek
         return new ExprStoreLocal(m_var_name, m_expression->const_optimize());
     }
 
+    void ExprStoreLocal::resolve(VarResolver& resolver)
+    {
+        m_expression->resolve(resolver);
+        resolver.find(m_var_name, m_depth, m_slot);
+    }
+
     Variable ExprStoreLocal::eval(Scope& scope)
     {
         Variable new_value(m_expression->eval(scope));
-        Variable& var = scope.find_var(m_var_name);
-        var.data(new_value->copy());
+        Variable& var = scope.find_var(m_var_name, m_depth, m_slot);
+        var = new_value;
         return new_value;
     }
 
-    Bytecode ExprStoreLocal::bytecode(VarNameMap& var_name_map) const
+    void ExprStoreLocal::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() <<
-            static_cast<uint8_t>(OpCode::var_store_local) <<
-            var_name_map.id_from_name(m_var_name.name()) <<
-            m_expression->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::var_store_local) << var_name_map.id_from_name(m_var_name.name());
+        m_expression->bytecode(bytecode, var_name_map);
     }
 
 
@@ -151,19 +169,22 @@ namespace creek
         return new ExprCreateGlobal(m_var_name, m_expression->const_optimize());
     }
 
+    void ExprCreateGlobal::resolve(VarResolver& resolver)
+    {
+        m_expression->resolve(resolver);
+    }
+
     Variable ExprCreateGlobal::eval(Scope& scope)
     {
         Variable new_value(m_expression->eval(scope));
-        GlobalScope::instance.create_local_var(m_var_name, new_value->copy());
+        GlobalScope::current().create_local_var(m_var_name, nullptr) = new_value;
         return new_value;
     }
 
-    Bytecode ExprCreateGlobal::bytecode(VarNameMap& var_name_map) const
+    void ExprCreateGlobal::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() <<
-            static_cast<uint8_t>(OpCode::var_create_global) <<
-            var_name_map.id_from_name(m_var_name.name()) <<
-            m_expression->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::var_create_global) << var_name_map.id_from_name(m_var_name.name());
+        m_expression->bytecode(bytecode, var_name_map);
     }
 
 
@@ -192,14 +213,12 @@ namespace creek
 
     Variable ExprLoadGlobal::eval(Scope& scope)
     {
-        return Variable(GlobalScope::instance.find_var(m_var_name)->copy());
+        return GlobalScope::current().find_var(m_var_name);
     }
 
-    Bytecode ExprLoadGlobal::bytecode(VarNameMap& var_name_map) const
+    void ExprLoadGlobal::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() <<
-            static_cast<uint8_t>(OpCode::var_load_global) <<
-            var_name_map.id_from_name(m_var_name.name());
+        bytecode << static_cast<uint8_t>(OpCode::var_load_global) << var_name_map.id_from_name(m_var_name.name());
     }
 
 
@@ -228,19 +247,22 @@ namespace creek
         return new ExprStoreGlobal(m_var_name, m_expression->const_optimize());
     }
 
+    void ExprStoreGlobal::resolve(VarResolver& resolver)
+    {
+        m_expression->resolve(resolver);
+    }
+
     Variable ExprStoreGlobal::eval(Scope& scope)
     {
         Variable new_value(m_expression->eval(scope));
-        Variable& var = GlobalScope::instance.find_var(m_var_name);
-        var.data(new_value->copy());
+        Variable& var = GlobalScope::current().find_var(m_var_name);
+        var = new_value;
         return new_value;
     }
 
-    Bytecode ExprStoreGlobal::bytecode(VarNameMap& var_name_map) const
+    void ExprStoreGlobal::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
     {
-        return Bytecode() <<
-            static_cast<uint8_t>(OpCode::var_store_global) <<
-            var_name_map.id_from_name(m_var_name.name()) <<
-            m_expression->bytecode(var_name_map);
+        bytecode << static_cast<uint8_t>(OpCode::var_store_global) << var_name_map.id_from_name(m_var_name.name());
+        m_expression->bytecode(bytecode, var_name_map);
     }
 }
@@ -3,6 +3,7 @@
 #include <creek/Expression.hpp>
 #include <creek/Expression_DataTypes.hpp>
 #include <creek/Scope.hpp>
+#include <creek/VarResolver.hpp>
 #include <creek/Vector.hpp>
 #include <creek/utility.hpp>
 
@@ -11,7 +12,7 @@ namespace creek
 {
     // `Function` constructor.
     // @param  value   Function value.
-    Function::Function(const Value& value) : m_value(value)
+    Function::Function(const Value& value) : Data(DataType::function), m_value(value)
     {
 
     }
@@ -47,8 +48,9 @@ namespace creek
 
     int Function::cmp(Data* other)
     {
-        if (auto other_function = dynamic_cast<Function*>(other))
+        if (other->type() == DataType::function)
         {
+            auto other_function = static_cast<Function*>(other);
             return m_value == other_function->m_value;
         }
         else
@@ -66,6 +68,10 @@ namespace creek
         if (m_value->is_variadic)
         {
             Vector::Value vararg_vec = std::make_shared< std::vector<Variable> >();
+            if (args.size() >= arg_names.size())
+            {
+                vararg_vec->reserve(args.size() - arg_names.size() + 1);
+            }
             for (size_t i = arg_names.size() - 1; i < args.size(); ++i)
             {
                 vararg_vec->emplace_back(args[i].release());
@@ -80,13 +86,14 @@ namespace creek
             throw WrongArgNumber(arg_names.size(), args.size());
         }
 
-        // TODO: break point in function?
-        Scope new_scope(m_value->parent,
-                        std::make_shared<Scope::ReturnPoint>(),
-                        std::make_shared<Scope::BreakPoint>());
+        // `return`, and `break` out of any loop, end in the function scope
+        auto& vars = m_value->vars;
+        Scope new_scope(m_value->parent, Scope::Frame::function, vars ? vars->slot_count : 0);
+        // arguments take the first slots, as declared by `VarResolver`
         for (size_t i = 0; i < arg_names.size(); ++i)
         {
-            new_scope.create_local_var(arg_names[i], args[i].release());
+            bool is_captured = vars && i < vars->captured_slots.size() && vars->captured_slots[i];
+            new_scope.create_local_var(arg_names[i], args[i].release(), i, is_captured).unbox();
         }
         Variable result = m_value->body->eval(new_scope);
 
@@ -14,6 +14,7 @@ namespace creek
 {
     class Scope;
     class Expression;
+    struct FunctionVars;
 
 
     /// Data type: function.
@@ -23,12 +24,19 @@ namespace creek
         /// Shared function definition.
         struct Definition
         {
+            /// @param  parent      Scope where the function is declared.
+            /// @param  arg_names   Names of arguments.
+            /// @param  is_variadic Is variadic function.
+            /// @param  body        Function body block.
+            /// @param  vars        Variables found by `VarResolver`, if resolved.
             Definition(Scope& parent, const std::vector<VarName>& arg_names,
-                       bool is_variadic, const std::shared_ptr<Expression>& body) :
+                       bool is_variadic, const std::shared_ptr<Expression>& body,
+                       const std::shared_ptr<const FunctionVars>& vars = nullptr) :
                 parent(parent),
                 arg_names(arg_names),
                 is_variadic(is_variadic),
-                body(body)
+                body(body),
+                vars(vars)
             {
                 if (is_variadic && arg_names.size() == 0)
                 {
@@ -36,10 +44,25 @@ namespace creek
                 }
             }
 
-            Scope& parent; ///< Scope where the function was declared.
+            /// @param  environment Captured variables, parent of the function scope.
+            /// @param  arg_names   Names of arguments.
+            /// @param  is_variadic Is variadic function.
+            /// @param  body        Function body block.
+            /// @param  vars        Variables found by `VarResolver`.
+            Definition(const std::shared_ptr<Scope>& environment, const std::vector<VarName>& arg_names,
+                       bool is_variadic, const std::shared_ptr<Expression>& body,
+                       const std::shared_ptr<const FunctionVars>& vars) :
+                Definition(*environment, arg_names, is_variadic, body, vars)
+            {
+                this->environment = environment;
+            }
+
+            Scope& parent; ///< Scope where the function was declared, or its environment.
             std::vector<VarName> arg_names; ///< Arguments name.
             bool is_variadic; ///< Is variadic function.
             std::shared_ptr<Expression> body; ///< Function body block.
+            std::shared_ptr<const FunctionVars> vars; ///< Variables found by `VarResolver`, if resolved.
+            std::shared_ptr<Scope> environment; ///< Owned environment of a closure, if any.
         };
 
         /// Stored value type.
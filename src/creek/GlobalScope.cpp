@@ -3,6 +3,7 @@
 #include <creek/CFunction.hpp>
 #include <creek/Exception.hpp>
 #include <creek/Identifier.hpp>
+#include <creek/Isolate.hpp>
 #include <creek/Map.hpp>
 #include <creek/Null.hpp>
 #include <creek/Object.hpp>
@@ -12,47 +13,6 @@
 
 namespace creek
 {
-    // @brief  Global class: Boolean.
-    Variable GlobalScope::class_Boolean;
-
-    // @brief  Global class: Class.
-    Variable GlobalScope::class_Class;
-
-    // @brief  Global class: Data.
-    Variable GlobalScope::class_Data;
-
-    // @brief  Global class: Identifier.
-    Variable GlobalScope::class_Identifier;
-
-    // @brief  Global class: Map.
-    Variable GlobalScope::class_Map;
-
-    // @brief  Global class: Null.
-    Variable GlobalScope::class_Null;
-
-    // @brief  Global class: Number.
-    Variable GlobalScope::class_Number;
-
-    // @brief  Global class: Object.
-    Variable GlobalScope::class_Object;
-
-    // @brief  Global class: UserData.
-    Variable GlobalScope::class_UserData;
-
-    // @brief  Global class: String.
-    Variable GlobalScope::class_String;
-
-    // @brief  Global class: Vector.
-    Variable GlobalScope::class_Vector;
-
-    // @brief  Global class: Void.
-    Variable GlobalScope::class_Void;
-
-
-    // @brief  `GlobalScope` instance.
-    GlobalScope GlobalScope::instance;
-
-
     // class methods; args = {self} where not specified; args = {self, other} for operations
 
     // class Data
@@ -221,6 +181,18 @@ namespace creek
 
     // @brief  `GlobalScope` constructor.
     GlobalScope::GlobalScope()
+    {
+
+    }
+
+    // Get the global scope of the current isolate.
+    GlobalScope& GlobalScope::current()
+    {
+        return Isolate::current().global_scope();
+    }
+
+    // Create the built-in classes.
+    void GlobalScope::load_classes()
     {
         // manually created classes
         {
@@ -437,6 +409,24 @@ namespace creek
         create_local_var(VarName("Void"),       class_Void->copy());
     }
 
+    // Get the class of a data without copying it.
+    const Variable* GlobalScope::class_of(Data* data)
+    {
+        switch (data->type())
+        {
+            case DataType::object:      return &static_cast<Object*>(data)->value()->class_obj;
+            case DataType::void_data:   return &class_Void;
+            case DataType::null:        return &class_Null;
+            case DataType::boolean:     return &class_Boolean;
+            case DataType::number:      return &class_Number;
+            case DataType::string:      return &class_String;
+            case DataType::identifier:  return &class_Identifier;
+            case DataType::vector:      return &class_Vector;
+            case DataType::map:         return &class_Map;
+            default:                    return nullptr;
+        }
+    }
+
 
 
     // class Data
@@ -449,13 +439,13 @@ namespace creek
     Data* func_Data_class_id(Scope& scope, std::vector< std::unique_ptr<Data> >& args)
     {
         Variable class_obj(args[0]->get_class());
-        return class_obj->attr(VarName("id"));
+        return class_obj->attr(VarName::vn_id);
     }
 
     Data* func_Data_class_name(Scope& scope, std::vector< std::unique_ptr<Data> >& args)
     {
         Variable class_obj(args[0]->get_class());
-        Variable id(class_obj->attr(VarName("id")));
+        Variable id(class_obj->attr(VarName::vn_id));
         return new String(id->string_value());
     }
 
@@ -608,7 +598,7 @@ namespace creek
     {
         Variable c(args[0].release());
         Variable instance = new Object(c->copy(), {});
-        Variable func_init = c.attr(VarName("init"));
+        Variable func_init = c.attr(VarName::vn_init);
 
         std::vector< std::unique_ptr<Data> > init_args;
         init_args.emplace_back(instance->copy());
@@ -630,9 +620,9 @@ namespace creek
         if (Object* self = dynamic_cast<Object*>(args[0].get()))
         {
             Vector::Value new_value = std::make_shared< std::vector<Variable> >();
-            for (auto& attr : self->value()->attrs)
+            for (auto& key : self->value()->shape->keys())
             {
-                new_value->emplace_back(new Identifier(attr.first));
+                new_value->emplace_back(new Identifier(key));
             }
             return new Vector(new_value);
         }
@@ -781,18 +771,15 @@ namespace creek
     Data* func_Class_init(Scope& scope, std::vector< std::unique_ptr<Data> >& args)
     {
         Variable self(args[0].release());
-        self.attr(VarName("super_class"),   args[1].release());
-        self.attr(VarName("id"),            args[2].release());
+        self.attr(VarName::vn_super_class,   args[1].release());
+        self.attr(VarName::vn_id,            args[2].release());
         return new Void();
     }
 
     // args = {self, init_args...}
     Data* func_Class_new(Scope& scope, std::vector< std::unique_ptr<Data> >& args)
     {
-        // TODO: make other static identifiers.
-        static VarName vn_instantiate = VarName("instantiate");
-
-        Variable instantiate = args[0]->attr(vn_instantiate);
+        Variable instantiate = args[0]->attr(VarName::vn_instantiate);
         std::vector< std::unique_ptr<Data> > instantiate_args;
         instantiate_args.emplace_back(args[0]->copy());
         for (auto& i : args[1]->vector_value())
@@ -947,7 +934,7 @@ namespace creek
     // args = {self, init_args...}
     Data* func_UserData_instantiate(Scope& scope, std::vector< std::unique_ptr<Data> >& args)
     {
-        Variable func_new = args[0]->attr(VarName("new"));
+        Variable func_new = args[0]->attr(VarName::vn_new);
         std::vector< std::unique_ptr<Data> > init_args;
         for (auto& i : args[1]->vector_value())
         {
@@ -1074,7 +1061,7 @@ namespace creek
     Data* func_Map_has_key(Scope& scope, std::vector< std::unique_ptr<Data> >& args)
     {
         auto map = args[0]->assert_cast<Map>();
-        return new Boolean(map->value()->count(Map::Key(args[1].release())) >= 1);
+        return new Boolean(map->value()->find(args[1].get()) != nullptr);
     }
 
     Data* func_Map_size(Scope& scope, std::vector< std::unique_ptr<Data> >& args)
@@ -1087,25 +1074,22 @@ namespace creek
     Data* func_Map_at(Scope& scope, std::vector< std::unique_ptr<Data> >& args)
     {
         auto map = args[0]->assert_cast<Map>();
-        return map->value()->at(Map::Key(args[1].release()))->copy();
+        return map->index(args[1].get());
     }
 
     // args = {self, key, new_val}
     Data* func_Map_insert(Scope& scope, std::vector< std::unique_ptr<Data> >& args)
     {
         auto map = args[0]->assert_cast<Map>();
-        auto r = map->value()->insert(std::make_pair(
-            Map::Key(args[1].release()),
-            Variable(args[2].release())
-        ));
-        return new Boolean(r.second);
+        bool r = map->value()->insert(args[1].get(), Variable(args[2].release()));
+        return new Boolean(r);
     }
 
     // args = {self, key}
     Data* func_Map_erase(Scope& scope, std::vector< std::unique_ptr<Data> >& args)
     {
         auto map = args[0]->assert_cast<Map>();
-        auto r = map->value()->erase(Map::Key(args[1].release()));
+        auto r = map->value()->erase(args[1].get());
         return new Number(r);
     }
 
@@ -8,54 +8,65 @@
 namespace creek
 {
     /// @brief  Global scope.
-    /// Has shortcuts to fundamental classes.
+    /// Has shortcuts to fundamental classes. Each `Isolate` has its own.
     class CREEK_API GlobalScope : public Scope
     {
     public:
         /// @brief  Global class: Boolean.
-        static Variable class_Boolean;
+        Variable class_Boolean;
 
         /// @brief  Global class: Class.
-        static Variable class_Class;
+        Variable class_Class;
 
         /// @brief  Global class: Data.
-        static Variable class_Data;
+        Variable class_Data;
 
         /// @brief  Global class: Identifier.
-        static Variable class_Identifier;
+        Variable class_Identifier;
 
         /// @brief  Global class: Map.
-        static Variable class_Map;
+        Variable class_Map;
 
         /// @brief  Global class: Null.
-        static Variable class_Null;
+        Variable class_Null;
 
         /// @brief  Global class: Number.
-        static Variable class_Number;
+        Variable class_Number;
 
         /// @brief  Global class: Object.
-        static Variable class_Object;
+        Variable class_Object;
 
         /// @brief  Global class: String.
-        static Variable class_String;
+        Variable class_String;
 
         /// @brief  Global class: UserData.
-        static Variable class_UserData;
+        Variable class_UserData;
 
         /// @brief  Global class: Vector.
-        static Variable class_Vector;
+        Variable class_Vector;
 
         /// @brief  Global class: Void.
-        static Variable class_Void;
+        Variable class_Void;
 
-        /// @brief  `GlobalScope` instance.
-        static GlobalScope instance;
+
+        /// @brief  Get the global scope of the current isolate.
+        static GlobalScope& current();
+
+
+        /// @brief  Get the class of a data without copying it.
+        /// @return Null if the data doesn't have a built-in class.
+        const Variable* class_of(Data* data);
 
 
     private:
+        friend class Isolate;
+
         /// @brief  `GlobalScope` constructor.
         GlobalScope();
 
+        /// @brief  Create the built-in classes.
+        void load_classes();
+
         GlobalScope(const GlobalScope& other) = delete;
         GlobalScope(GlobalScope&& other) = delete;
     };
@@ -7,7 +7,7 @@ namespace creek
 {
     // `Identifier` constructor.
     // @param  value        Identifier value.
-    Identifier::Identifier(Value value) : m_value(value)
+    Identifier::Identifier(Value value) : Data(DataType::identifier), m_value(value)
     {
 
     }
@@ -106,10 +106,15 @@ namespace creek
             return 0;
         }
     }
+
+    size_t Identifier::hash() const
+    {
+        return m_value.id();
+    }
     // @}
 
     Data* Identifier::get_class() const
     {
-        return GlobalScope::class_Identifier->copy();
+        return GlobalScope::current().class_Identifier->copy();
     }
 }
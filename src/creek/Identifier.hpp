@@ -121,6 +121,7 @@ namespace creek
         /// This special operation must return an integer.
         /// @return -1 if less-than, 0 if equal, +1 if greater-than.
         int cmp(Data* other) override;
+        size_t hash() const override;
         /// @}
 
         Data* get_class() const override;
@@ -1,8 +1,12 @@
 #include <creek/Interpreter.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <thread>
 
 #include <creek/Exception.hpp>
 #include <creek/Expression.hpp>
@@ -17,6 +21,7 @@
 #include <creek/Expression_General.hpp>
 #include <creek/Expression_Variable.hpp>
 #include <creek/utility.hpp>
+#include <creek/VarResolver.hpp>
 
 namespace creek
 {
@@ -26,6 +31,253 @@ namespace creek
     }
 
 
+    namespace
+    {
+        bool is_digit(char c)
+        {
+            return '0' <= c && c <= '9';
+        }
+
+        bool is_hex_digit(char c)
+        {
+            return is_digit(c) || ('a' <= c && c <= 'f') || ('A' <= c && c <= 'F');
+        }
+
+        bool is_binary_digit(char c)
+        {
+            return c == '0' || c == '1';
+        }
+
+        bool is_identifier_start(char c)
+        {
+            return c == '_' || ('a' <= c && c <= 'z') || is_uppercase(c);
+        }
+
+        bool is_identifier_char(char c)
+        {
+            return is_identifier_start(c) || is_digit(c);
+        }
+
+        bool is_space(char c)
+        {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+        }
+
+        bool is_line_end(char c)
+        {
+            return c == '\n' || c == '\r';
+        }
+
+        // Count the characters from `begin` that pass `test`.
+        template<class Test>
+        size_t count_while(const char* begin, const char* end, Test test)
+        {
+            const char* iter = begin;
+            while (iter < end && test(*iter))
+            {
+                ++iter;
+            }
+            return iter - begin;
+        }
+
+        // Match an integer or floating-point literal.
+        // Integers: `0x1F`, `0b101`, `123`.
+        // Floating-point: `0x1.8`, `1.5`.
+        size_t match_number(const char* begin, const char* end, TokenType& type)
+        {
+            size_t length = end - begin;
+            bool hex = length > 2 && begin[0] == '0' && (begin[1] == 'x' || begin[1] == 'X') && is_hex_digit(begin[2]);
+            bool binary = length > 2 && begin[0] == '0' && (begin[1] == 'b' || begin[1] == 'B') && is_binary_digit(begin[2]);
+
+            // integer part
+            size_t integer;
+            if (hex)
+            {
+                integer = 2 + count_while(begin + 2, end, is_hex_digit);
+            }
+            else if (binary)
+            {
+                integer = 2 + count_while(begin + 2, end, is_binary_digit);
+            }
+            else
+            {
+                integer = count_while(begin, end, is_digit);
+            }
+
+            // fractional part
+            size_t whole = hex ? integer : count_while(begin, end, is_digit);
+            if (whole < length && begin[whole] == '.')
+            {
+                size_t fraction = count_while(begin + whole + 1, end, hex ? is_hex_digit : is_digit);
+                if (fraction > 0)
+                {
+                    type = TokenType::floatnum;
+                    return whole + 1 + fraction;
+                }
+            }
+
+            type = TokenType::integer;
+            return integer;
+        }
+
+        // Match a character literal: `'a'` or `'\n'`.
+        size_t match_character(const char* begin, const char* end)
+        {
+            size_t length = end - begin;
+            if (length >= 3 && begin[1] != '\'' && begin[1] != '\\' && begin[2] == '\'')
+            {
+                return 3;
+            }
+            if (length >= 4 && begin[1] == '\\' && !is_line_end(begin[2]) && begin[3] == '\'')
+            {
+                return 4;
+            }
+            return 0;
+        }
+
+        // Match a string literal: `"text"`, with escaped characters.
+        size_t match_string(const char* begin, const char* end)
+        {
+            const char* iter = begin + 1;
+            while (iter < end)
+            {
+                if (*iter == '"')
+                {
+                    return iter + 1 - begin;
+                }
+                else if (*iter == '\\')
+                {
+                    if (iter + 1 >= end || is_line_end(iter[1]))
+                    {
+                        return 0;
+                    }
+                    iter += 2;
+                }
+                else
+                {
+                    iter += 1;
+                }
+            }
+            return 0;
+        }
+
+        // Match the longest token at the beginning of the code.
+        // @param  begin   First character; must be less than `end`.
+        // @param  type    Returns the type of the token.
+        // @return Token length, or 0 if no token matches.
+        size_t match_token(const char* begin, const char* end, TokenType& type)
+        {
+            size_t length = end - begin;
+            char next = length > 1 ? begin[1] : '\0';
+            char c = begin[0];
+
+            if (is_space(c))
+            {
+                type = TokenType::space;
+                return count_while(begin, end, is_space);
+            }
+            if (is_identifier_start(c))
+            {
+                type = TokenType::identifier;
+                return count_while(begin, end, is_identifier_char);
+            }
+            if (is_digit(c))
+            {
+                return match_number(begin, end, type);
+            }
+
+            type = TokenType::operation_sign;
+            switch (c)
+            {
+                case '/':
+                    if (next == '/')
+                    {
+                        type = TokenType::commentary;
+                        return count_while(begin, end, [](char x) { return x != '\n'; });
+                    }
+                    return 1;
+
+                case '\'':
+                    type = TokenType::character;
+                    return match_character(begin, end);
+
+                case '"':
+                    type = TokenType::string;
+                    return match_string(begin, end);
+
+                case '=':
+                    if (next == '>')
+                    {
+                        type = TokenType::then;
+                        return 2;
+                    }
+                    if (next == '=')
+                    {
+                        return 2;
+                    }
+                    type = TokenType::assign;
+                    return 1;
+
+                case '.':
+                    if (next == '.')
+                    {
+                        if (length > 2 && begin[2] == '.')
+                        {
+                            type = TokenType::ellipsis_3;
+                            return 3;
+                        }
+                        type = TokenType::ellipsis_2;
+                        return 2;
+                    }
+                    type = TokenType::dot;
+                    return 1;
+
+                case ':':
+                    if (next == ':')
+                    {
+                        type = TokenType::double_colon;
+                        return 2;
+                    }
+                    type = TokenType::colon;
+                    return 1;
+
+                case '-':
+                    if (next == '>')
+                    {
+                        type = TokenType::arrow;
+                        return 2;
+                    }
+                    return 1;
+
+                case '+': case '%': case '^': case '~':
+                    return 1;
+
+                case '*':   return next == '*' ? 2 : 1;
+                case '&':   return next == '&' ? 2 : 1;
+                case '|':   return next == '|' ? 2 : 1;
+                case '<':   return next == '<' || next == '=' ? 2 : 1;
+                case '>':   return next == '>' || next == '=' ? 2 : 1;
+                case '!':   return next == '=' || next == '!' ? 2 : 1;
+
+                case ',':   type = TokenType::comma;          return 1;
+                case ';':   type = TokenType::semicolon;      return 1;
+                case '@':   type = TokenType::at;             return 1;
+                case '#':   type = TokenType::hash;           return 1;
+                case '$':   type = TokenType::dollar;         return 1;
+                case '(':   type = TokenType::open_round;     return 1;
+                case ')':   type = TokenType::close_round;    return 1;
+                case '[':   type = TokenType::open_square;    return 1;
+                case ']':   type = TokenType::close_square;   return 1;
+                case '{':   type = TokenType::open_brace;     return 1;
+                case '}':   type = TokenType::close_brace;    return 1;
+
+                default:
+                    return 0;
+            }
+        }
+    }
+
+
     // `InterpreterOperator` constructor.
     // @param  string      Operator string.
     // @param  precedence  Operator precedence (the more, the faster).
@@ -92,44 +344,6 @@ namespace creek
         InterpreterOperator("||", 1),
     };
 
-    // Regular expressions for tokens.
-    const std::map<TokenType, std::regex> Interpreter::token_regexes
-    {
-        { TokenType::space,             std::regex(R"__(\s+)__") },
-
-        { TokenType::commentary,        std::regex(R"__(//[^\n]*)__") },
-
-        { TokenType::integer,           std::regex(R"__((0[xX][0-9a-fA-F]+)|(0[bB][01]+)|([0-9]+))__") },
-        { TokenType::floatnum,          std::regex(R"__((0[xX][0-9a-fA-F]+\.[0-9a-fA-F]+)|([0-9]+\.[0-9]+))__") },
-        { TokenType::character,         std::regex(R"__('([^'\\]|\\.)')__") },
-        { TokenType::string,            std::regex(R"__("([^"\\]|\\.)*")__") },
-
-        { TokenType::identifier,        std::regex(R"__([_a-zA-Z][_a-zA-Z0-9]*)__") },
-        { TokenType::assign,            std::regex(R"__(=)__") },
-        { TokenType::dot,               std::regex(R"__(\.)__") },
-        { TokenType::ellipsis_2,        std::regex(R"__(\.\.)__") },
-        { TokenType::ellipsis_3,        std::regex(R"__(\.\.\.)__") },
-        { TokenType::colon,             std::regex(R"__(:)__") },
-        { TokenType::double_colon,      std::regex(R"__(::)__") },
-        { TokenType::comma,             std::regex(R"__(,)__") },
-        { TokenType::semicolon,         std::regex(R"__(;)__") },
-        { TokenType::at,                std::regex(R"__(\@)__") },
-        { TokenType::hash,              std::regex(R"__(\#)__") },
-        { TokenType::dollar,            std::regex(R"__(\$)__") },
-        { TokenType::arrow,             std::regex(R"__(\->)__") },
-        { TokenType::then,              std::regex(R"__(=>)__") },
-
-        { TokenType::operation_sign,    std::regex(R"__(\+|\-|/|%|\^|~|(\*\*?)|(&&?)|(\|\|?)|==|(<[<=]?)|(>[>=]?)|(![=!]?))__") },
-        // { TokenType::operation_sign,    std::regex(R"__(\+|\-|/|%|~|!|\*\*?|&&?|\|\|?|\^\^?|<(=>?)?|>=?|==|!=)__") },
-
-        { TokenType::open_round,        std::regex(R"__(\()__") },
-        { TokenType::close_round,       std::regex(R"__(\))__") },
-        { TokenType::open_square,       std::regex(R"__(\[)__") },
-        { TokenType::close_square,      std::regex(R"__(\])__") },
-        { TokenType::open_brace,        std::regex(R"__(\{)__") },
-        { TokenType::close_brace,       std::regex(R"__(\})__") },
-    };
-
     // Keywords.
     const std::map<std::string, std::pair<std::string, TokenType> > Interpreter::keywords
     {
@@ -191,7 +405,68 @@ namespace creek
 
         auto expressions = parse(tokens);
 
-        return new ExprBasicBlock(expressions);
+        auto program = new ExprBasicBlock(expressions);
+        VarResolver resolver;
+        resolver.resolve(program);
+        return program;
+    }
+
+    // Interpret many source files in parallel.
+    // @param  paths   Paths to the source files.
+    // @param  threads Number of worker threads; 0 to use one per hardware thread.
+    std::vector<Expression*> Interpreter::load_files(const std::vector<std::string>& paths, unsigned threads)
+    {
+        if (threads == 0)
+        {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        threads = std::min<size_t>(threads, paths.size());
+
+        std::vector<Expression*> programs(paths.size(), nullptr);
+        std::vector<std::exception_ptr> errors(paths.size());
+
+        // each worker takes the next file until there are no more
+        std::atomic<size_t> next(0);
+        auto work = [&]()
+        {
+            Interpreter interpreter;
+            for (size_t i = next++; i < paths.size(); i = next++)
+            {
+                try
+                {
+                    programs[i] = interpreter.load_file(paths[i]);
+                }
+                catch (...)
+                {
+                    errors[i] = std::current_exception();
+                }
+            }
+        };
+
+        // the calling thread is one of the workers
+        std::vector<std::thread> workers;
+        for (unsigned i = 1; i < threads; i += 1)
+        {
+            workers.emplace_back(work);
+        }
+        work();
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+
+        for (auto& error : errors)
+        {
+            if (error)
+            {
+                for (auto program : programs)
+                {
+                    delete program;
+                }
+                std::rethrow_exception(error);
+            }
+        }
+        return programs;
     }
 
     // Interpret a source code.
@@ -210,7 +485,10 @@ namespace creek
 
         auto expressions = parse(tokens);
 
-        return new ExprBasicBlock(expressions);
+        auto program = new ExprBasicBlock(expressions);
+        VarResolver resolver;
+        resolver.resolve(program);
+        return program;
     }
 
     std::string Interpreter::load(const std::string& path)
@@ -251,79 +529,42 @@ namespace creek
     {
         std::vector<Token> tokens;
 
-        // test every regex until source is deplected or an error occurs
+        // match the longest token until source is deplected or an error occurs
         unsigned current_line = 1;
         unsigned current_column = 1;
-        auto iter = code.cbegin();
-        while (iter < code.cend())
+        const char* iter = code.data();
+        const char* end = code.data() + code.size();
+        while (iter < end)
         {
-            std::vector<TokenType> matching_types;
-
-            // matchs regexes
-            unsigned largest = 0;
-            for (auto& regex : token_regexes)
-            {
-                std::smatch match;
-
-                auto r = std::regex_search(iter, code.cend(), match, regex.second, std::regex_constants::match_continuous);
-
-                if (r)
-                {
-                    // reset when longer
-                    if (largest < match.length())
-                    {
-                        largest = match.length();
-                        matching_types.clear();
-                        matching_types.push_back(regex.first);
-                    }
-                    // push when same length
-                    else if (largest == match.length())
-                    {
-                        matching_types.push_back(regex.first);
-                    }
-                }
-            }
+            TokenType type = TokenType::unknown;
+            size_t length = match_token(iter, end, type);
 
             // check results
-            if (matching_types.size() == 0) // no match
+            if (length == 0) // no match
             {
-                TokenType type = TokenType::unknown;
-                std::string text = std::string(iter, iter+1);
-                Token token(type, text, current_line, current_column);
-
+                Token token(TokenType::unknown, std::string(iter, iter+1), current_line, current_column);
                 throw UnexpectedCharacter(token);
             }
-            else
+            else if (type != TokenType::space && type != TokenType::commentary) // meaningful token
             {
-                TokenType type = matching_types.front();
-                std::string text = std::string(iter, iter+largest);
+                std::string text(iter, iter+length);
 
                 // keyword replacement
-                if (keywords.count(text))
+                if (type == TokenType::identifier)
                 {
-                    auto& replacement = keywords.at(text);
-                    text = replacement.first;
-                    type = replacement.second;
-                }
-
-                Token token(type, text, current_line, current_column);
-
-                // ambiguous token
-                if (matching_types.size() > 1)
-                {
-                    throw AmbiguousToken(token, matching_types);
+                    auto keyword = keywords.find(text);
+                    if (keyword != keywords.end())
+                    {
+                        text = keyword->second.first;
+                        type = keyword->second.second;
+                    }
                 }
 
-                // meaningful token
-                if (matching_types.front() != TokenType::space &&
-                    matching_types.front() != TokenType::commentary) // one match
-                {
-                    tokens.push_back(token);
-                }
+                tokens.emplace_back(type, text, current_line, current_column);
             }
 
             // update line & column
-            for(unsigned i = 0; i < largest; ++i)
+            for(size_t i = 0; i < length; ++i)
             {
                 char c = iter[i];
                 if(c == '\n')
@@ -338,7 +579,7 @@ namespace creek
             }
 
             // update iterator
-            iter += largest;
+            iter += length;
         }
 
         // add EOF token
@@ -1136,6 +1377,10 @@ namespace creek
                 false_block = parse_block_body(iter);
             }
         }
+        else
+        {
+            false_block = new ExprVoid();
+        }
 
         return new ExprIf(condition, true_block, false_block);
     }
@@ -1301,6 +1546,7 @@ namespace creek
 
         check_token_type(iter, {TokenType::identifier});
         auto id = iter->identifier();
+        iter += 1;
 
         auto catch_body = parse_block_body(iter);
 
@@ -1,9 +1,9 @@
 #pragma once
 
 #include <map>
-#include <regex>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <creek/api_mode.hpp>
 #include <creek/Exception.hpp>
@@ -46,9 +46,6 @@ namespace creek
         /// Operators.
         static const std::set<InterpreterOperator> operators;
 
-        /// Regular expressions for tokens.
-        static const std::map<TokenType, std::regex> token_regexes;
-
         /// Keywords.
         static const std::map<std::string, std::pair<std::string, TokenType> > keywords;
 
@@ -60,10 +57,30 @@ namespace creek
         /// @param  path    Path to the source file.
         Expression* load_file(const std::string& path);
 
+        /// Interpret many source files in parallel.
+        /// The files are scanned and parsed by a pool of worker threads.
+        /// If any file fails, its exception is thrown (the first one in
+        /// `paths` order) and no program is returned.
+        /// @param  paths   Paths to the source files.
+        /// @param  threads Number of worker threads; 0 to use one per
+        ///                 hardware thread.
+        /// @return         Programs, in the same order as `paths`.
+        std::vector<Expression*> load_files(const std::vector<std::string>& paths, unsigned threads = 0);
+
         /// Interpret a source code.
         /// @param  code    Source code.
         Expression* load_code(const std::string& code);
 
+        /// Split a source code into tokens.
+        /// The last token is always `TokenType::eof`.
+        /// @param  code    Source code.
+        std::vector<Token> scan(const std::string& code);
+
+        /// Parse the statements of a token list.
+        /// Variables are not resolved yet.
+        /// @param  tokens  Tokens, ending with `TokenType::eof`.
+        std::vector<Expression*> parse(const std::vector<Token>& tokens);
+
 
     private:
         struct ParseIterator
@@ -95,8 +112,6 @@ namespace creek
 
 
         std::string load(const std::string& path);
-        std::vector<Token> scan(const std::string& code);
-        std::vector<Expression*> parse(const std::vector<Token>& tokens);
 
         Expression* parse_statement(ParseIterator& iter);
         Expression* parse_operation(ParseIterator& iter);
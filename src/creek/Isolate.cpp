@@ -0,0 +1,69 @@
+#include <creek/Isolate.hpp>
+
+#include <creek/GlobalScope.hpp>
+#include <creek/Shape.hpp>
+
+
+namespace creek
+{
+    namespace
+    {
+        // isolate entered by the thread; null for the default one
+        thread_local Isolate* current_isolate = nullptr;
+    }
+
+
+    /// @brief  `Enter` constructor.
+    /// @param  isolate     Isolate to make current.
+    Isolate::Enter::Enter(Isolate& isolate) :
+        m_previous(current_isolate)
+    {
+        current_isolate = &isolate;
+    }
+
+    Isolate::Enter::~Enter()
+    {
+        current_isolate = m_previous;
+    }
+
+
+    /// @brief  `Isolate` constructor.
+    Isolate::Isolate() :
+        m_root_shape(new Shape())
+    {
+        // built-in classes are created in this isolate
+        Enter enter(*this);
+        m_global_scope.reset(new GlobalScope());
+        m_global_scope->load_classes();
+    }
+
+    Isolate::~Isolate()
+    {
+        // objects are destroyed in this isolate, before their shapes
+        Enter enter(*this);
+        m_global_scope.reset();
+    }
+
+
+    Isolate& Isolate::current()
+    {
+        return current_isolate ? *current_isolate : default_isolate();
+    }
+
+    Isolate& Isolate::default_isolate()
+    {
+        static Isolate isolate;
+        return isolate;
+    }
+
+
+    GlobalScope& Isolate::global_scope()
+    {
+        return *m_global_scope;
+    }
+
+    const Shape* Isolate::root_shape() const
+    {
+        return m_root_shape.get();
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <memory>
+
+#include <creek/api_mode.hpp>
+
+
+namespace creek
+{
+    class GlobalScope;
+    class Shape;
+
+
+    /// @brief  Independent instance of the interpreter.
+    /// Owns a global scope, with its own built-in classes, and the shapes of
+    /// its objects. Each thread has a current isolate, used by everything
+    /// that needs the global environment; threads that did not enter any
+    /// isolate use the default one.
+    /// Isolates share nothing but the var names, so each one can run in its
+    /// own thread at the same time as the others. Data, scopes and programs
+    /// must not be passed from an isolate to another.
+    class CREEK_API Isolate
+    {
+    public:
+        /// @brief  Make an isolate current in the calling thread.
+        /// The previous isolate is made current again on destruction.
+        class CREEK_API Enter
+        {
+        public:
+            /// @brief  `Enter` constructor.
+            /// @param  isolate     Isolate to make current.
+            Enter(Isolate& isolate);
+
+            Enter(const Enter& other) = delete;
+            Enter& operator= (const Enter& other) = delete;
+
+            ~Enter();
+
+        private:
+            Isolate* m_previous;
+        };
+
+
+        /// @brief  `Isolate` constructor.
+        /// Creates the global scope and the built-in classes.
+        Isolate();
+
+        Isolate(const Isolate& other) = delete;
+        Isolate& operator= (const Isolate& other) = delete;
+
+        ~Isolate();
+
+
+        /// @brief  Get the current isolate of the calling thread.
+        static Isolate& current();
+
+        /// @brief  Get the isolate used by threads that did not enter
+        /// another one.
+        /// It is created on first use.
+        static Isolate& default_isolate();
+
+
+        /// @brief  Get the global scope.
+        GlobalScope& global_scope();
+
+        /// @brief  Get the shape without attributes.
+        const Shape* root_shape() const;
+
+
+    private:
+        std::unique_ptr<Shape> m_root_shape;
+        std::unique_ptr<GlobalScope> m_global_scope;
+    };
+}
@@ -0,0 +1,47 @@
+#include <creek/Iterator.hpp>
+
+#include <sstream>
+
+
+namespace creek
+{
+    std::string Iterator::class_name() const
+    {
+        return "Iterator";
+    }
+
+    std::string Iterator::debug_text() const
+    {
+        std::stringstream stream;
+        stream << "Iterator(" << this << ")";
+        return stream.str();
+    }
+
+
+    // `KeysIterator` constructor.
+    // @param  range       Container.
+    // @param  keys        Vector of keys of the container.
+    KeysIterator::KeysIterator(const Variable& range, const Variable& keys) :
+        m_range(range),
+        m_keys(keys),
+        m_position(0)
+    {
+
+    }
+
+    Data* KeysIterator::copy() const
+    {
+        return new KeysIterator(*this);
+    }
+
+    bool KeysIterator::next(Variable& value)
+    {
+        auto& keys = m_keys->vector_value();
+        if (m_position >= keys.size())
+        {
+            return false;
+        }
+        value = m_range.index(keys[m_position++]);
+        return true;
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <creek/Data.hpp>
+
+#include <cstddef>
+
+#include <creek/api_mode.hpp>
+#include <creek/Variable.hpp>
+
+
+namespace creek
+{
+    /// @brief  Data type: iterator over the values of a container.
+    /// Given by `Data::iter`; `next` gives the values.
+    class CREEK_API Iterator : public Data
+    {
+    public:
+        /// Get data class name.
+        std::string class_name() const override;
+
+        /// Get debug text.
+        std::string debug_text() const override;
+
+        /// @brief  Get the next value.
+        /// @param  value       Set to the next value.
+        /// @return `false` if no values are left.
+        bool next(Variable& value) override = 0;
+    };
+
+
+    /// @brief  Iterator over the keys of a container.
+    /// Gets each value with `index`.
+    class CREEK_API KeysIterator : public Iterator
+    {
+    public:
+        /// @brief  `KeysIterator` constructor.
+        /// @param  range       Container.
+        /// @param  keys        Vector of keys of the container.
+        KeysIterator(const Variable& range, const Variable& keys);
+
+        /// Create a copy, at the same position.
+        Data* copy() const override;
+
+        bool next(Variable& value) override;
+
+    private:
+        Variable m_range;
+        Variable m_keys;
+        size_t m_position;
+    };
+}
@@ -1,16 +1,372 @@
 #include <creek/Map.hpp>
 
 #include <sstream>
+#include <utility>
 
 #include <creek/Expression_DataTypes.hpp>
 #include <creek/GlobalScope.hpp>
+#include <creek/Identifier.hpp>
+#include <creek/Iterator.hpp>
+#include <creek/Object.hpp>
 
 
 namespace creek
 {
+    namespace
+    {
+        // Get an identifier for a class object.
+        uintptr_t class_num_of_class(Data* class_obj)
+        {
+            if (class_obj && class_obj->type() == DataType::object)
+            {
+                return reinterpret_cast<uintptr_t>(static_cast<Object*>(class_obj)->value().get());
+            }
+            return 0;
+        }
+
+        // Spread the bits of a hash, to use the low bits as table position.
+        size_t mix(size_t hash)
+        {
+            uint64_t bits = hash;
+            bits ^= bits >> 33;
+            bits *= 0xff51afd7ed558ccdULL;
+            bits ^= bits >> 33;
+            return bits;
+        }
+
+        // Table size of a new map.
+        const size_t min_table_size = 8;
+
+
+        // Iterator over the values of a map, in insertion order.
+        // Items added while iterating are not visited, and erased ones are
+        // skipped; the items keep their positions until it is destroyed.
+        class MapIterator : public Iterator
+        {
+        public:
+            MapIterator(const Map::Value& map) :
+                m_map(map),
+                m_position(0),
+                m_end(map->positions())
+            {
+                m_map->hold_positions();
+            }
+
+            MapIterator(const MapIterator& other) :
+                Iterator(other),
+                m_map(other.m_map),
+                m_position(other.m_position),
+                m_end(other.m_end)
+            {
+                m_map->hold_positions();
+            }
+
+            ~MapIterator()
+            {
+                m_map->release_positions();
+            }
+
+            Data* copy() const override
+            {
+                return new MapIterator(*this);
+            }
+
+            bool next(Variable& value) override
+            {
+                while (m_position < m_end && m_position < m_map->positions())
+                {
+                    auto item = m_map->at_position(m_position++);
+                    if (item)
+                    {
+                        value = item->second;
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+        private:
+            Map::Value m_map;
+            size_t m_position;
+            size_t m_end;
+        };
+    }
+
+
+    // `Key` constructor.
+    // @param  key     Key data; takes ownership.
+    Map::Key::Key(Data* key) :
+        Key(key, class_num_of(key), key->hash())
+    {
+
+    }
+
+    // `Key` constructor.
+    // @param  key         Key data; takes ownership.
+    // @param  class_num   Identifier for class of key.
+    // @param  hash        Hash of key.
+    Map::Key::Key(Data* key, uintptr_t class_num, size_t hash) :
+        class_num(class_num), hash(hash), key(key)
+    {
+
+    }
+
+    // Check if equal to a key.
+    bool Map::Key::equals(uintptr_t other_class_num, size_t other_hash, Data* other) const
+    {
+        if (class_num != other_class_num || hash != other_hash)
+        {
+            return false;
+        }
+        // equivalent as in an ordered map: !(a < b) && !(b < a)
+        int order = key->cmp(other);
+        return order == 0 || (order > 0 && other->cmp(*key) >= 0);
+    }
+
+    // Get an identifier for the class of a key.
+    uintptr_t Map::Key::class_num_of(Data* key)
+    {
+        if (const Variable* class_obj = GlobalScope::current().class_of(key))
+        {
+            return class_num_of_class(**class_obj);
+        }
+        Variable class_obj = key->get_class();
+        return class_num_of_class(*class_obj);
+    }
+
+
+    // Item iterator.
+    Map::Definition::const_iterator::const_iterator(const Item* item, const Item* end) :
+        m_item(item), m_end(end)
+    {
+        skip_erased();
+    }
+
+    const Map::Definition::Item& Map::Definition::const_iterator::operator * () const
+    {
+        return *m_item;
+    }
+
+    const Map::Definition::Item* Map::Definition::const_iterator::operator -> () const
+    {
+        return m_item;
+    }
+
+    Map::Definition::const_iterator& Map::Definition::const_iterator::operator ++ ()
+    {
+        ++m_item;
+        skip_erased();
+        return *this;
+    }
+
+    bool Map::Definition::const_iterator::operator != (const const_iterator& other) const
+    {
+        return m_item != other.m_item;
+    }
+
+    void Map::Definition::const_iterator::skip_erased()
+    {
+        while (m_item != m_end && !m_item->first.key)
+        {
+            ++m_item;
+        }
+    }
+
+
+    const size_t Map::Definition::empty;
+
+    // `Definition` constructor.
+    Map::Definition::Definition() : m_table(min_table_size, empty), m_size(0), m_holds(0)
+    {
+
+    }
+
+    // Find the value of a key.
+    Variable* Map::Definition::find(Data* key)
+    {
+        size_t index = m_table[position(Key::class_num_of(key), key->hash(), key)];
+        return index == empty ? nullptr : &m_items[index].second;
+    }
+
+    // Get the value of a key, adding it if not found.
+    Variable& Map::Definition::get_or_add(Data* key)
+    {
+        uintptr_t class_num = Key::class_num_of(key);
+        size_t hash = key->hash();
+        size_t pos = position(class_num, hash, key);
+        if (m_table[pos] != empty)
+        {
+            return m_items[m_table[pos]].second;
+        }
+
+        if (reserve_one())
+        {
+            pos = position(class_num, hash, key);
+        }
+        m_table[pos] = m_items.size();
+        m_items.emplace_back(Key(key->copy(), class_num, hash), Variable());
+        m_size += 1;
+        return m_items.back().second;
+    }
+
+    // Add a key if not found.
+    bool Map::Definition::insert(Data* key, const Variable& value)
+    {
+        size_t size = m_size;
+        Variable& item = get_or_add(key);
+        if (m_size == size)
+        {
+            return false;
+        }
+        item = value;
+        return true;
+    }
+
+    // Remove a key.
+    size_t Map::Definition::erase(Data* key)
+    {
+        size_t index = m_table[position(Key::class_num_of(key), key->hash(), key)];
+        if (index == empty)
+        {
+            return 0;
+        }
+        // keep the item as a tombstone until the table is rebuilt
+        m_items[index].first.key = Variable();
+        m_items[index].second = Variable();
+        m_size -= 1;
+        return 1;
+    }
+
+    // Remove all items.
+    void Map::Definition::clear()
+    {
+        // held positions stay, as tombstones
+        if (m_holds > 0)
+        {
+            for (auto& item : m_items)
+            {
+                item.first.key = Variable();
+                item.second = Variable();
+            }
+            m_size = 0;
+            return;
+        }
+
+        m_items.clear();
+        m_table.assign(min_table_size, empty);
+        m_size = 0;
+    }
+
+    // Number of items.
+    size_t Map::Definition::size() const
+    {
+        return m_size;
+    }
+
+    // Number of item positions, counting erased items.
+    size_t Map::Definition::positions() const
+    {
+        return m_items.size();
+    }
+
+    // Keep the items at their positions while an iterator uses them.
+    void Map::Definition::hold_positions()
+    {
+        m_holds += 1;
+    }
+
+    // Release a hold of `hold_positions`.
+    void Map::Definition::release_positions()
+    {
+        m_holds -= 1;
+    }
+
+    // Get the item at a position, in insertion order.
+    const Map::Definition::Item* Map::Definition::at_position(size_t position) const
+    {
+        const Item& item = m_items[position];
+        return item.first.key ? &item : nullptr;
+    }
+
+    Map::Definition::const_iterator Map::Definition::begin() const
+    {
+        return const_iterator(m_items.data(), m_items.data() + m_items.size());
+    }
+
+    Map::Definition::const_iterator Map::Definition::end() const
+    {
+        return const_iterator(m_items.data() + m_items.size(), m_items.data() + m_items.size());
+    }
+
+    // Find the table position of a key.
+    size_t Map::Definition::position(uintptr_t class_num, size_t hash, Data* key) const
+    {
+        size_t mask = m_table.size() - 1;
+        size_t pos = mix(hash) & mask;
+        while (true)
+        {
+            size_t index = m_table[pos];
+            if (index == empty)
+            {
+                return pos;
+            }
+            const Key& item_key = m_items[index].first;
+            if (item_key.key && item_key.equals(class_num, hash, key))
+            {
+                return pos;
+            }
+            pos = (pos + 1) & mask;
+        }
+    }
+
+    // Make room for one more item.
+    bool Map::Definition::reserve_one()
+    {
+        // keep the table at most 2/3 full, counting erased items
+        if ((m_items.size() + 1) * 3 <= m_table.size() * 2)
+        {
+            return false;
+        }
+
+        // remove the erased items, unless their positions are held
+        if (m_size != m_items.size() && m_holds == 0)
+        {
+            std::vector<Item> items;
+            items.reserve(m_size);
+            for (auto& item : m_items)
+            {
+                if (item.first.key)
+                {
+                    items.push_back(std::move(item));
+                }
+            }
+            m_items.swap(items);
+        }
+
+        size_t table_size = min_table_size;
+        while (table_size < (m_items.size() + 1) * 2)
+        {
+            table_size *= 2;
+        }
+        m_table.assign(table_size, empty);
+
+        size_t mask = table_size - 1;
+        for (size_t index = 0; index < m_items.size(); ++index)
+        {
+            size_t pos = mix(m_items[index].first.hash) & mask;
+            while (m_table[pos] != empty)
+            {
+                pos = (pos + 1) & mask;
+            }
+            m_table[pos] = index;
+        }
+        return true;
+    }
+
+
     // @brief  `Map` constructor.
     // @param  value   Map value.
-    Map::Map(const Value& value) : m_value(value)
+    Map::Map(const Value& value) : Data(DataType::map), m_value(value)
     {
 
     }
@@ -78,21 +434,26 @@ namespace creek
 
     Data* Map::index(Data* key)
     {
-        auto iter = m_value->find(Key(key->copy()));
-        if (iter == m_value->end())
+        Variable* value = m_value->find(key);
+        if (!value)
         {
             auto key_text = key->debug_text();
             throw Exception(std::string("Key not found: ") + key_text);
         }
-        return iter->second->copy();
+        return (*value)->copy();
     }
 
     Data* Map::index(Data* key, Data* new_value)
     {
-        (*m_value)[Key(key->copy())] = Variable(new_value->copy());
+        m_value->get_or_add(key) = Variable(new_value->copy());
         return new_value;
     }
 
+    Data* Map::iter()
+    {
+        return new MapIterator(m_value);
+    }
+
     Data* Map::attr(VarName key)
     {
         Variable i = new Identifier(key);
@@ -120,6 +481,6 @@ namespace creek
 
     Data* Map::get_class() const
     {
-        return GlobalScope::class_Map->copy();
+        return GlobalScope::current().class_Map->copy();
     }
 }
@@ -2,11 +2,13 @@
 
 #include <creek/Data.hpp>
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
-#include <map>
+#include <utility>
+#include <vector>
 
 #include <creek/api_mode.hpp>
-#include <creek/Object.hpp>
 #include <creek/Variable.hpp>
 
 
@@ -17,33 +19,123 @@ namespace creek
     {
     public:
         /// @brief  Map key.
-        struct Key {
-            Key(Data* key) : class_num(0), key(key) {
-                if (key) {
-                    Variable v = key->get_class();
-                    if (auto o = dynamic_cast<Object*>(*v))
-                    {
-                        class_num = reinterpret_cast<uintptr_t>(o->value().get());
-                    }
-                }
-            }
-
-            bool operator < (const Key& other) const {
-                if (class_num == other.class_num) {
-                    return key.cmp(other.key) < 0;
-                } else {
-                    return class_num < other.class_num;
-                }
-            }
+        struct CREEK_API Key
+        {
+            /// @brief  `Key` constructor.
+            /// @param  key     Key data; takes ownership.
+            Key(Data* key);
+
+            /// @brief  `Key` constructor.
+            /// @param  key         Key data; takes ownership.
+            /// @param  class_num   Identifier for class of key.
+            /// @param  hash        Hash of key.
+            Key(Data* key, uintptr_t class_num, size_t hash);
+
+            /// @brief  Check if equal to a key.
+            bool equals(uintptr_t other_class_num, size_t other_hash, Data* other) const;
+
+            /// @brief  Get an identifier for the class of a key.
+            static uintptr_t class_num_of(Data* key);
 
             Data* operator -> () const { return *key; }
 
             uintptr_t class_num; ///< Identifier for class of key.
+            size_t hash; ///< Hash of key.
             Variable key; ///< Key.
         };
 
         /// @brief  Map shared definition.
-        using Definition = std::map<Key, Variable>;
+        /// Hash table with open addressing. Items are kept in insertion
+        /// order; the table stores their positions.
+        class CREEK_API Definition
+        {
+        public:
+            /// @brief  Key and value.
+            using Item = std::pair<Key, Variable>;
+
+            /// @brief  Item iterator; skips erased items.
+            class CREEK_API const_iterator
+            {
+            public:
+                const_iterator(const Item* item, const Item* end);
+                const Item& operator * () const;
+                const Item* operator -> () const;
+                const_iterator& operator ++ ();
+                bool operator != (const const_iterator& other) const;
+
+            private:
+                void skip_erased();
+
+                const Item* m_item;
+                const Item* m_end;
+            };
+
+
+            /// @brief  `Definition` constructor.
+            Definition();
+
+            /// @brief  Find the value of a key.
+            /// @return Null if not found.
+            Variable* find(Data* key);
+
+            /// @brief  Get the value of a key, adding it if not found.
+            /// @param  key     Key; copied if added.
+            Variable& get_or_add(Data* key);
+
+            /// @brief  Add a key if not found.
+            /// @param  key     Key; copied if added.
+            /// @return True if added.
+            bool insert(Data* key, const Variable& value);
+
+            /// @brief  Remove a key.
+            /// @return Number of items removed.
+            size_t erase(Data* key);
+
+            /// @brief  Remove all items.
+            void clear();
+
+            /// @brief  Number of items.
+            size_t size() const;
+
+            /// @brief  Number of item positions, counting erased items.
+            /// Items are added at the last position; adding an item after
+            /// erasing others may move them to lower positions, unless the
+            /// positions are held.
+            size_t positions() const;
+
+            /// @brief  Keep the items at their positions while an iterator
+            /// uses them.
+            /// Erased items are not removed until every hold is released.
+            void hold_positions();
+
+            /// @brief  Release a hold of `hold_positions`.
+            void release_positions();
+
+            /// @brief  Get the item at a position, in insertion order.
+            /// @return Null if erased.
+            const Item* at_position(size_t position) const;
+
+            const_iterator begin() const;
+            const_iterator end() const;
+
+        private:
+            /// @brief  Empty table position.
+            static const size_t empty = ~size_t(0);
+
+            /// @brief  Find the table position of a key.
+            /// @return Position with the key, or the empty position where it
+            ///         would be added.
+            size_t position(uintptr_t class_num, size_t hash, Data* key) const;
+
+            /// @brief  Make room for one more item.
+            /// @return True if the table was rebuilt.
+            bool reserve_one();
+
+            std::vector<Item> m_items; ///< Items, in insertion order; erased ones have null key.
+            std::vector<size_t> m_table; ///< Item index, or `empty`.
+            size_t m_size; ///< Number of items not erased.
+            size_t m_holds; ///< Number of holds of the item positions.
+        };
 
         /// @brief  Stored value type.
         using Value = std::shared_ptr<Definition>;
@@ -77,6 +169,8 @@ namespace creek
         Data* index(Data* key) override;
         Data* index(Data* key, Data* new_value) override;
 
+        Data* iter() override;
+
         Data* attr(VarName key) override;
         Data* attr(VarName key, Data* new_value) override;
 
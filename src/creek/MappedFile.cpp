@@ -0,0 +1,115 @@
+#include <creek/MappedFile.hpp>
+
+#ifdef CREEK_WINDOWS
+# include <windows.h>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+
+namespace creek
+{
+    /// @brief  `MappedFile` constructor.
+    /// @param  path    Path to the file.
+    MappedFile::MappedFile(const std::string& path) :
+        m_data(""),
+        m_size(0),
+        m_open(false),
+        m_handle(nullptr)
+    {
+        #ifdef CREEK_WINDOWS
+            HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+            {
+                return;
+            }
+
+            LARGE_INTEGER size;
+            if (GetFileSizeEx(file, &size))
+            {
+                if (size.QuadPart > 0)
+                {
+                    m_handle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                    void* view = m_handle ? MapViewOfFile(reinterpret_cast<HANDLE>(m_handle), FILE_MAP_READ, 0, 0, 0) : nullptr;
+                    if (view)
+                    {
+                        m_data = static_cast<const char*>(view);
+                        m_size = static_cast<size_t>(size.QuadPart);
+                        m_open = true;
+                    }
+                }
+                else
+                {
+                    m_open = true;
+                }
+            }
+            CloseHandle(file);
+        #else
+            int file = open(path.c_str(), O_RDONLY);
+            if (file < 0)
+            {
+                return;
+            }
+
+            struct stat status;
+            if (fstat(file, &status) == 0)
+            {
+                if (status.st_size > 0)
+                {
+                    void* view = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+                    if (view != MAP_FAILED)
+                    {
+                        m_data = static_cast<const char*>(view);
+                        m_size = static_cast<size_t>(status.st_size);
+                        m_open = true;
+                    }
+                }
+                else
+                {
+                    m_open = true;
+                }
+            }
+            close(file);
+        #endif
+    }
+
+    MappedFile::~MappedFile()
+    {
+        if (m_size > 0)
+        {
+            #ifdef CREEK_WINDOWS
+                UnmapViewOfFile(m_data);
+            #else
+                munmap(const_cast<char*>(m_data), m_size);
+            #endif
+        }
+        #ifdef CREEK_WINDOWS
+            if (m_handle)
+            {
+                CloseHandle(reinterpret_cast<HANDLE>(m_handle));
+            }
+        #endif
+    }
+
+
+    /// @brief  Check if the file was opened and mapped.
+    bool MappedFile::is_open() const
+    {
+        return m_open;
+    }
+
+    /// @brief  Get the first byte.
+    const char* MappedFile::data() const
+    {
+        return m_data;
+    }
+
+    /// @brief  Get the number of bytes.
+    size_t MappedFile::size() const
+    {
+        return m_size;
+    }
+}
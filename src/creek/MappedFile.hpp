@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include <creek/api_mode.hpp>
+
+
+namespace creek
+{
+    /// @brief  Read-only file mapped in memory.
+    /// Pages are read from disk when first accessed, so the parts of the
+    /// file that are never read cost neither time nor memory.
+    class CREEK_API MappedFile
+    {
+    public:
+        /// @brief  `MappedFile` constructor.
+        /// @param  path    Path to the file.
+        MappedFile(const std::string& path);
+
+        MappedFile(const MappedFile& other) = delete;
+        MappedFile& operator= (const MappedFile& other) = delete;
+
+        ~MappedFile();
+
+
+        /// @brief  Check if the file was opened and mapped.
+        bool is_open() const;
+
+        /// @brief  Get the first byte.
+        const char* data() const;
+
+        /// @brief  Get the number of bytes.
+        size_t size() const;
+
+
+    private:
+        const char* m_data;
+        size_t m_size;
+        bool m_open;
+        void* m_handle;     ///< Mapping object; only used in Windows.
+    };
+}
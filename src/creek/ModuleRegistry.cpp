@@ -0,0 +1,206 @@
+#include <creek/ModuleRegistry.hpp>
+
+#include <cstdlib>
+#include <fstream>
+
+#include <creek/Expression.hpp>
+#include <creek/Scope.hpp>
+
+#ifdef CREEK_WINDOWS
+# include <windows.h>
+#endif
+
+
+namespace creek
+{
+    const std::string ModuleRegistry::path_variable = "CREEK_PATH";
+
+    const std::vector<std::string> ModuleRegistry::default_search_paths =
+    {
+        "./?.txt",
+    };
+
+
+    namespace
+    {
+        // absolute path without `.`, `..` or links, so a file reached from
+        // different search paths is loaded once; the same path if it can't
+        // be resolved
+        std::string canonical_path(const std::string& path)
+        {
+            #ifdef CREEK_WINDOWS
+                char buffer[MAX_PATH];
+                DWORD size = GetFullPathNameA(path.c_str(), MAX_PATH, buffer, nullptr);
+                if (size > 0 && size < MAX_PATH)
+                {
+                    return std::string(buffer, size);
+                }
+            #else
+                char* resolved = realpath(path.c_str(), nullptr);
+                if (resolved)
+                {
+                    std::string result = resolved;
+                    std::free(resolved);
+                    return result;
+                }
+            #endif
+            return path;
+        }
+    }
+
+
+    /// @brief  `ModuleRegistry` constructor.
+    ModuleRegistry::ModuleRegistry()
+    {
+        const char* paths = std::getenv(path_variable.c_str());
+        if (paths)
+        {
+            std::string path_list = paths;
+            size_t begin = 0;
+            while (begin <= path_list.size())
+            {
+                size_t end = path_list.find(';', begin);
+                if (end == std::string::npos)
+                {
+                    end = path_list.size();
+                }
+                if (end > begin)
+                {
+                    add_search_path(path_list.substr(begin, end - begin));
+                }
+                begin = end + 1;
+            }
+        }
+
+        for (auto& search_path : default_search_paths)
+        {
+            add_search_path(search_path);
+        }
+    }
+
+    /// @brief  `ModuleRegistry` constructor.
+    /// @param  search_paths    Search paths.
+    ModuleRegistry::ModuleRegistry(const std::vector<std::string>& search_paths) :
+        m_search_paths(search_paths)
+    {
+
+    }
+
+    ModuleRegistry::~ModuleRegistry()
+    {
+
+    }
+
+
+    const std::vector<std::string>& ModuleRegistry::search_paths() const
+    {
+        return m_search_paths;
+    }
+
+    void ModuleRegistry::search_paths(const std::vector<std::string>& search_paths)
+    {
+        m_search_paths = search_paths;
+        m_paths.clear();
+    }
+
+    void ModuleRegistry::add_search_path(const std::string& search_path)
+    {
+        m_search_paths.push_back(search_path);
+        m_paths.clear();
+    }
+
+    BytecodeCache& ModuleRegistry::cache()
+    {
+        return m_cache;
+    }
+
+
+    std::string ModuleRegistry::find(const std::string& module_name) const
+    {
+        for (auto& search_path : m_search_paths)
+        {
+            // resolve path template
+            std::string path = search_path;
+            size_t pos = 0;
+            while (true)
+            {
+                pos = path.find_first_of('?', pos);
+                if (pos == std::string::npos)
+                    break;
+                path.replace(pos, 1, module_name);
+                pos += module_name.size();
+            }
+
+            // test file existence
+            std::ifstream test_file(path);
+            if (!test_file.fail())
+            {
+                return path;
+            }
+        }
+        return std::string();
+    }
+
+    Variable ModuleRegistry::require(Scope& scope, const std::string& module_name)
+    {
+        // a name loaded before is not searched again
+        std::string path;
+        auto name = m_paths.find(module_name);
+        if (name != m_paths.end())
+        {
+            path = name->second;
+        }
+        else
+        {
+            path = find(module_name);
+            if (path.empty())
+            {
+                throw Exception(std::string("Can't find module file ") + module_name);
+            }
+            path = canonical_path(path);
+        }
+
+        // already loaded
+        auto i = m_modules.find(path);
+        if (i != m_modules.end())
+        {
+            if (i->second.is_loading)
+            {
+                throw CircularRequire(path);
+            }
+            m_paths[module_name] = path;
+            return i->second.result;
+        }
+
+        // run the module; it can be required again if it fails
+        Module& module = m_modules[path];
+        module.is_loading = true;
+        try
+        {
+            module.program.reset(m_cache.load_file(path));
+            module.result = module.program->eval(scope);
+        }
+        catch (...)
+        {
+            m_modules.erase(path);
+            throw;
+        }
+        module.is_loading = false;
+        m_paths[module_name] = path;
+        return module.result;
+    }
+
+    bool ModuleRegistry::is_loaded(const std::string& path) const
+    {
+        auto i = m_modules.find(canonical_path(path));
+        return i != m_modules.end() && !i->second.is_loading;
+    }
+
+
+    /// @brief  `CircularRequire` constructor.
+    /// @param  path    Path to the module file.
+    CircularRequire::CircularRequire(const std::string& path)
+    {
+        stream() << "Module " << path << " requires itself";
+    }
+}
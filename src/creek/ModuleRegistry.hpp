@@ -0,0 +1,107 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <creek/api_mode.hpp>
+#include <creek/BytecodeCache.hpp>
+#include <creek/Exception.hpp>
+#include <creek/Variable.hpp>
+
+
+namespace creek
+{
+    class Expression;
+    class Scope;
+
+
+    /// @brief  Modules loaded by `require`.
+    /// A module is found by replacing each `?` of the search paths with its
+    /// name; the first existing file is used. Each file is run only once,
+    /// in the scope where `require` was created, and its result is
+    /// returned again by the next calls that find the same file, whatever
+    /// the path used to reach it. A name found once is not searched again
+    /// until the search paths change.
+    class CREEK_API ModuleRegistry
+    {
+    public:
+        /// @brief  Environment variable with search paths, separated by `;`.
+        /// They are searched before the default ones.
+        static const std::string path_variable;
+
+        /// @brief  Search paths used if no other is given.
+        static const std::vector<std::string> default_search_paths;
+
+
+        /// @brief  `ModuleRegistry` constructor.
+        /// Search paths are read from `path_variable`, followed by
+        /// `default_search_paths`.
+        ModuleRegistry();
+
+        /// @brief  `ModuleRegistry` constructor.
+        /// @param  search_paths    Search paths.
+        ModuleRegistry(const std::vector<std::string>& search_paths);
+
+        ModuleRegistry(const ModuleRegistry& other) = delete;
+        ModuleRegistry& operator= (const ModuleRegistry& other) = delete;
+
+        ~ModuleRegistry();
+
+
+        /// @brief  Get the search paths.
+        const std::vector<std::string>& search_paths() const;
+
+        /// @brief  Set the search paths.
+        void search_paths(const std::vector<std::string>& search_paths);
+
+        /// @brief  Add a search path after the others.
+        /// @param  search_path     Path with `?` in place of the module name.
+        void add_search_path(const std::string& search_path);
+
+        /// @brief  Get the bytecode cache used to load modules.
+        BytecodeCache& cache();
+
+
+        /// @brief  Find the file of a module.
+        /// @param  module_name     Module name.
+        /// @return Path to the file, or an empty string if not found.
+        std::string find(const std::string& module_name) const;
+
+        /// @brief  Load a module, or get it if already loaded.
+        /// @param  scope           Scope where the module is run.
+        /// @param  module_name     Module name.
+        /// @return Result of the module.
+        Variable require(Scope& scope, const std::string& module_name);
+
+        /// @brief  Check if the module in a path was loaded.
+        /// @param  path            Path to the module file.
+        bool is_loaded(const std::string& path) const;
+
+
+    private:
+        /// @brief  Loaded module.
+        struct Module
+        {
+            std::unique_ptr<Expression> program;    ///< Kept alive for the functions defined by the module.
+            Variable result;                        ///< Value returned by `require`.
+            bool is_loading = false;                ///< Is the module being run?
+        };
+
+        std::vector<std::string> m_search_paths;
+        BytecodeCache m_cache;
+        std::map<std::string, Module> m_modules;        ///< Modules, by canonical path.
+        std::map<std::string, std::string> m_paths;     ///< Canonical path of the modules loaded, by name.
+    };
+
+
+    /// A module requires itself, directly or through other modules.
+    class CREEK_API CircularRequire : public Exception
+    {
+    public:
+        /// @brief  `CircularRequire` constructor.
+        /// @param  path    Path to the module file.
+        CircularRequire(const std::string& path);
+    };
+}
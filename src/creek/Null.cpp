@@ -7,7 +7,7 @@
 namespace creek
 {
     /// @brief  `Null` Constructor.
-    Null::Null()
+    Null::Null() : Data(DataType::null)
     {
 
     }
@@ -58,7 +58,7 @@ namespace creek
 
     int Null::cmp(Data* other)
     {
-        if (Null* other_null = dynamic_cast<Null*>(other))
+        if (other->type() == DataType::null)
         {
             return true;
         }
@@ -67,6 +67,6 @@ namespace creek
 
     Data* Null::get_class() const
     {
-        return GlobalScope::class_Null->copy();
+        return GlobalScope::current().class_Null->copy();
     }
 }
@@ -1,6 +1,8 @@
 #include <creek/Number.hpp>
 
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 
 #include <creek/Expression_DataTypes.hpp>
 #include <creek/GlobalScope.hpp>
@@ -9,11 +11,29 @@
 
 namespace creek
 {
-    Number::Number(Value value) : m_value(value)
+    Number::Number(Value value) : Data(DataType::number), m_value(value)
     {
 
     }
 
+    Number::Value Number::value() const
+    {
+        return m_value;
+    }
+
+    size_t Number::hash(Value value)
+    {
+        // `cmp` compares in float precision, so hash the float bits
+        float float_value = value;
+        if (float_value == 0)
+        {
+            float_value = 0; // -0 == +0
+        }
+        uint32_t bits;
+        std::memcpy(&bits, &float_value, sizeof(bits));
+        return bits;
+    }
+
     Data* Number::copy() const
     {
         return new Number(m_value);
@@ -169,8 +189,13 @@ namespace creek
         }
     }
 
+    size_t Number::hash() const
+    {
+        return hash(m_value);
+    }
+
     Data* Number::get_class() const
     {
-        return GlobalScope::class_Number->copy();
+        return GlobalScope::current().class_Number->copy();
     }
 }
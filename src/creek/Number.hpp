@@ -19,6 +19,13 @@ namespace creek
         /// @param  value   Floating point value.
         Number(Value value);
 
+        /// Get the value.
+        Value value() const;
+
+        /// Hash of a number value.
+        /// Same as `Number(value).hash()`.
+        static size_t hash(Value value);
+
 
         Data* copy() const override;
         std::string class_name() const override;
@@ -51,6 +58,7 @@ namespace creek
         Data* bit_left_shift(Data* other) override;
         Data* bit_right_shift(Data* other) override;
         int cmp(Data* other) override;
+        size_t hash() const override;
 
         Data* get_class() const override;
 
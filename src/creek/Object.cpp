@@ -7,9 +7,43 @@
 
 namespace creek
 {
+    // `Definition` constructor.
+    // @param  class_obj   Class object.
+    // @param  attrs       Attributes, added in key order.
+    Object::Definition::Definition(Data* class_obj, const AttrList& attrs) :
+        class_obj(class_obj),
+        shape(Shape::root())
+    {
+        slots.reserve(attrs.size());
+        for (auto& attr : attrs)
+        {
+            get_or_add(attr.first) = attr.second;
+        }
+    }
+
+    // Find an attribute.
+    Variable* Object::Definition::find(VarName key)
+    {
+        size_t slot = shape->find(key);
+        return slot == Shape::no_slot ? nullptr : &slots[slot];
+    }
+
+    // Get an attribute, adding it if not found.
+    Variable& Object::Definition::get_or_add(VarName key)
+    {
+        if (Variable* attr = find(key))
+        {
+            return *attr;
+        }
+        shape = shape->add(key);
+        slots.emplace_back();
+        return slots.back();
+    }
+
+
     // `Object` constructor.
     // @param  value   Object value.
-    Object::Object(const Value& value) : m_value(value)
+    Object::Object(const Value& value) : Data(DataType::object), m_value(value)
     {
 
     }
@@ -18,7 +52,7 @@ namespace creek
     // @param  class_obj   Class object.
     // @param  attrs       Object attributes.
     Object::Object(Data* class_obj, const Definition::AttrList& attrs) :
-        Object(std::make_shared<Definition>(Definition(class_obj, attrs)))
+        Object(std::make_shared<Definition>(class_obj, attrs))
     {
 
     }
@@ -56,7 +90,7 @@ namespace creek
     // Get a reference to a shallow copy of this object.
     Data* Object::clone() const
     {
-        return new Object(m_value->class_obj->copy(), m_value->attrs);
+        return new Object(std::make_shared<Definition>(*m_value));
     }
 
     // Get data class name.
@@ -79,7 +113,7 @@ namespace creek
     // Get the bool value of this data.
     bool Object::bool_value() const
     {
-        Variable v = call_method("to_boolean", {});
+        Variable v = call_method(VarName::vn_to_boolean, {});
         return v->bool_value();
         // Variable class_obj = m_value->class_obj;
         // Variable method = class_obj.index(new Identifier("to_boolean"));
@@ -92,7 +126,7 @@ namespace creek
     // Get the char value of this data.
     char Object::char_value() const
     {
-        Variable v = call_method("to_string", {});
+        Variable v = call_method(VarName::vn_to_string, {});
         return v->char_value();
         // Variable class_obj = m_value->class_obj;
         // Variable method = class_obj.index(new Identifier("to_string"));
@@ -105,7 +139,7 @@ namespace creek
     // Get the int value of this data.
     int Object::int_value() const
     {
-        Variable v = call_method("to_number", {});
+        Variable v = call_method(VarName::vn_to_number, {});
         return v->int_value();
         // Variable class_obj = m_value->class_obj;
         // Variable method = class_obj.index(new Identifier("to_number"));
@@ -118,7 +152,7 @@ namespace creek
     // Get the float value of this data.
     double Object::double_value() const
     {
-        Variable v = call_method("to_number", {});
+        Variable v = call_method(VarName::vn_to_number, {});
         return v->double_value();
         // Variable class_obj = m_value->class_obj;
         // Variable method = class_obj.index(new Identifier("to_number"));
@@ -131,7 +165,7 @@ namespace creek
     // // Get the string value of this data.
     // std::string Object::string_value() const
     // {
-    //     Variable v = call_method("to_string", {});
+    //     Variable v = call_method(VarName::vn_to_string, {});
     //     return v->string_value();
     //     // Variable class_obj = m_value->class_obj;
     //     // Variable method = class_obj.index(new Identifier("to_string"));
@@ -165,7 +199,7 @@ namespace creek
         // throw Exception(std::string("Index not found: ") + key->debug_text());
 
         // return attr(key->identifier_value());
-        return call_method("index_get", {key->copy()});
+        return call_method(VarName::vn_index_get, {key->copy()});
     }
 
     // Set the data at index.
@@ -185,7 +219,36 @@ namespace creek
         // return new_data->copy();
 
         // return attr(key->identifier_value(), new_data);
-        return call_method("index_set", {key->copy(), new_data->copy()});
+        return call_method(VarName::vn_index_set, {key->copy(), new_data->copy()});
+    }
+    // @}
+
+
+    // @name   Iteration
+    // @{
+    // Get an iterator over the values of this object.
+    Data* Object::iter()
+    {
+        Variable class_obj(get_class());
+        if (class_obj && class_obj->type() == DataType::object &&
+            static_cast<Object*>(*class_obj)->value()->find(VarName::vn_iter))
+        {
+            return call_method(VarName::vn_iter, {});
+        }
+        return Data::iter();
+    }
+
+    // Get the next value of this iterator.
+    bool Object::next(Variable& value)
+    {
+        Variable next_value(call_method(VarName::vn_next, {}));
+        if (next_value->type() == DataType::void_data)
+        {
+            return false;
+        }
+        next_value.unbox();
+        value = std::move(next_value);
+        return true;
     }
     // @}
 
@@ -196,12 +259,12 @@ namespace creek
     /// @brief  key         Attribute key.
     Data* Object::attr(VarName key)
     {
-        auto iter = m_value->attrs.find(key);
-        if (iter == m_value->attrs.end())
+        Variable* attr = m_value->find(key);
+        if (!attr)
         {
             throw Exception(std::string("Attribute not found: ") + key.name());
         }
-        return iter->second->copy();
+        return (*attr)->copy();
     }
 
     /// @brief  Set the attribute.
@@ -209,7 +272,7 @@ namespace creek
     /// @brief  new_data    New data to save in attribute.
     Data* Object::attr(VarName key, Data* new_data)
     {
-        m_value->attrs[key].reset(new_data);
+        m_value->get_or_add(key).reset(new_data);
         return new_data->copy();
     }
     /// @}
@@ -220,43 +283,43 @@ namespace creek
     // Addition.
     Data* Object::add(Data* other)
     {
-        return call_method("add", {other->copy()});
+        return call_method(VarName::vn_add, {other->copy()});
     }
 
     // Subtraction.
     Data* Object::sub(Data* other)
     {
-        return call_method("sub", {other->copy()});
+        return call_method(VarName::vn_sub, {other->copy()});
     }
 
     // Multiplication.
     Data* Object::mul(Data* other)
     {
-        return call_method("mul", {other->copy()});
+        return call_method(VarName::vn_mul, {other->copy()});
     }
 
     // Divison.
     Data* Object::div(Data* other)
     {
-        return call_method("div", {other->copy()});
+        return call_method(VarName::vn_div, {other->copy()});
     }
 
     // Modulo.
     Data* Object::mod(Data* other)
     {
-        return call_method("mod", {other->copy()});
+        return call_method(VarName::vn_mod, {other->copy()});
     }
 
     // Exponentiation.
     Data* Object::exp(Data* other)
     {
-        return call_method("exp", {other->copy()});
+        return call_method(VarName::vn_exp, {other->copy()});
     }
 
     // Unary minus.
     Data* Object::unm()
     {
-        return call_method("unm", {});
+        return call_method(VarName::vn_unm, {});
     }
     // @}
 
@@ -266,37 +329,37 @@ namespace creek
     // Bitwise AND.
     Data* Object::bit_and(Data* other)
     {
-        return call_method("bit_and", {other->copy()});
+        return call_method(VarName::vn_bit_and, {other->copy()});
     }
 
     // Bitwise OR.
     Data* Object::bit_or(Data* other)
     {
-        return call_method("bit_or", {other->copy()});
+        return call_method(VarName::vn_bit_or, {other->copy()});
     }
 
     // Bitwise XOR.
     Data* Object::bit_xor(Data* other)
     {
-        return call_method("bit_xor", {other->copy()});
+        return call_method(VarName::vn_bit_xor, {other->copy()});
     }
 
     // Bitwise NOT.
     Data* Object::bit_not()
     {
-        return call_method("bit_not", {});
+        return call_method(VarName::vn_bit_not, {});
     }
 
     // Bitwise left shift.
     Data* Object::bit_left_shift(Data* other)
     {
-        return call_method("bit_left_shift", {other->copy()});
+        return call_method(VarName::vn_bit_left_shift, {other->copy()});
     }
 
     // Bitwise right shift.
     Data* Object::bit_right_shift(Data* other)
     {
-        return call_method("bit_right_shift", {other->copy()});
+        return call_method(VarName::vn_bit_right_shift, {other->copy()});
     }
     // @}
 
@@ -309,7 +372,7 @@ namespace creek
     // @return -1 if less-than, 0 if equal, +1 if greater-than.
     int Object::cmp(Data* other)
     {
-        Variable v(call_method("cmp", {other->copy()}));
+        Variable v(call_method(VarName::vn_cmp, {other->copy()}));
         return v->int_value();
     }
     // @}
@@ -328,7 +391,7 @@ namespace creek
         {
             new_args.emplace_back(arg.release());
         }
-        return call_method("call", new_args);
+        return call_method(VarName::vn_call, new_args);
     }
     // @}
 
@@ -9,6 +9,7 @@
 
 #include <creek/api_mode.hpp>
 #include <creek/Exception.hpp>
+#include <creek/Shape.hpp>
 #include <creek/Variable.hpp>
 #include <creek/VarName.hpp>
 
@@ -20,24 +21,28 @@ namespace creek
     {
     public:
         /// @brief  Shared object definition.
-        struct Definition
+        /// Attribute values are stored in slots, given by the shape.
+        struct CREEK_API Definition
         {
             /// @brief  Type alias: attribute list.
             // using AttrList = std::vector< std::tuple<Variable, Variable> >;
             using AttrList = std::map<VarName, Variable>;
 
-            Definition(Data* class_obj, const AttrList& attrs) :
-                class_obj(class_obj)
-//                attrs(attrs)
-            {
-                for (auto& attr : attrs)
-                {
-                    this->attrs[attr.first] = attr.second->copy();
-                }
-            }
+            /// @brief  `Definition` constructor.
+            /// @param  class_obj   Class object.
+            /// @param  attrs       Attributes, added in key order.
+            Definition(Data* class_obj, const AttrList& attrs);
+
+            /// @brief  Find an attribute.
+            /// @return Null if not found.
+            Variable* find(VarName key);
+
+            /// @brief  Get an attribute, adding it if not found.
+            Variable& get_or_add(VarName key);
 
             Variable class_obj; ///< Class object.
-            AttrList attrs; ///< Object attributes.
+            const Shape* shape; ///< Attribute layout.
+            std::vector<Variable> slots; ///< Attribute values, by slot.
         };
 
         /// @brief  Stored value type.
@@ -108,6 +113,20 @@ namespace creek
         /// @}
 
 
+        /// @name   Iteration
+        /// @{
+        /// @brief  Get an iterator over the values of this object.
+        /// Calls the `iter` method of the class, if any; otherwise iterates
+        /// over the keys given by the `keys` method.
+        Data* iter() override;
+
+        /// @brief  Get the next value of this iterator.
+        /// Calls the `next` method of the class, which returns void when no
+        /// values are left.
+        bool next(Variable& value) override;
+        /// @}
+
+
         /// @name   Object attribute
         /// @{
         /// @brief  Get the attribute.
@@ -86,5 +86,28 @@ namespace creek
         // dynamic load
         { OpCode::dyn_func,                 "dyn_func" },
         { OpCode::dyn_class,                "dyn_class" },
+
+        // virtual machine
+        { OpCode::vm_pop,                   "vm_pop" },
+        { OpCode::vm_drop,                  "vm_drop" },
+        { OpCode::vm_const,                 "vm_const" },
+        { OpCode::vm_eval,                  "vm_eval" },
+        { OpCode::vm_jump,                  "vm_jump" },
+        { OpCode::vm_jump_if_false,         "vm_jump_if_false" },
+        { OpCode::vm_jump_if_false_keep,    "vm_jump_if_false_keep" },
+        { OpCode::vm_jump_if_true_keep,     "vm_jump_if_true_keep" },
+        { OpCode::vm_jump_if_case,          "vm_jump_if_case" },
+        { OpCode::vm_push_scope,            "vm_push_scope" },
+        { OpCode::vm_pop_scope,             "vm_pop_scope" },
+        { OpCode::vm_loop_begin,            "vm_loop_begin" },
+        { OpCode::vm_loop_set,              "vm_loop_set" },
+        { OpCode::vm_loop_end,              "vm_loop_end" },
+        { OpCode::vm_for_in_begin,          "vm_for_in_begin" },
+        { OpCode::vm_for_in_next,           "vm_for_in_next" },
+        { OpCode::vm_try_begin,             "vm_try_begin" },
+        { OpCode::vm_try_end,               "vm_try_end" },
+        { OpCode::vm_clear_scope,           "vm_clear_scope" },
+        { OpCode::vm_for_check,             "vm_for_check" },
+        { OpCode::vm_for_step,              "vm_for_step" },
     };
 }
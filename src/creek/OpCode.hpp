@@ -1,7 +1,9 @@
 #pragma once
 
+#include <cstdint>
 #include <cstdio>
 #include <map>
+#include <string>
 
 #include <creek/api_mode.hpp>
 
@@ -94,6 +96,29 @@ namespace creek
         // dynamic load
         dyn_func                = 0x70,
         dyn_class               = 0x71,
+
+        // virtual machine
+        vm_pop                  = 0x80,
+        vm_drop                 = 0x81,
+        vm_const                = 0x82,
+        vm_eval                 = 0x83,
+        vm_jump                 = 0x84,
+        vm_jump_if_false        = 0x85,
+        vm_jump_if_false_keep   = 0x86,
+        vm_jump_if_true_keep    = 0x87,
+        vm_jump_if_case         = 0x88,
+        vm_push_scope           = 0x89,
+        vm_pop_scope            = 0x8A,
+        vm_loop_begin           = 0x8B,
+        vm_loop_set             = 0x8C,
+        vm_loop_end             = 0x8D,
+        vm_for_in_begin         = 0x8E,
+        vm_for_in_next          = 0x8F,
+        vm_try_begin            = 0x90,
+        vm_try_end              = 0x91,
+        vm_clear_scope          = 0x92,
+        vm_for_check            = 0x93,
+        vm_for_step             = 0x94,
     };
 
 
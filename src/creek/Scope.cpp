@@ -1,15 +1,106 @@
 #include <creek/Scope.hpp>
 
+#include <memory>
+
 #include <creek/Exception.hpp>
 
 
 namespace creek
 {
+    /// @brief  Stack of slots of the scopes of a thread.
+    /// Slots are kept in chunks, so they never move while their scope lives.
+    class Scope::FrameStack
+    {
+    public:
+        /// @brief  Number of slots of each chunk.
+        static const size_t chunk_size = 1024;
+
+        /// @brief  Get the stack of the calling thread.
+        static FrameStack& current()
+        {
+            static thread_local FrameStack frames;
+            return frames;
+        }
+
+        /// @brief  Take slots from the top.
+        /// @param  count   Number of slots.
+        /// @param  begin   Position of the first slot.
+        /// @param  mark    Top before the slots are taken.
+        /// @return First slot, or `nullptr` if they don't fit in a chunk.
+        Slot* push(size_t count, size_t& begin, size_t& mark)
+        {
+            if (count > chunk_size)
+            {
+                return nullptr;
+            }
+
+            // slots of a scope don't cross chunks
+            mark = m_top;
+            begin = m_top;
+            if (begin % chunk_size + count > chunk_size)
+            {
+                begin += chunk_size - begin % chunk_size;
+            }
+            size_t chunk = begin / chunk_size;
+            if (chunk == m_chunks.size())
+            {
+                m_chunks.emplace_back(new Slot[chunk_size]);
+            }
+            m_top = begin + count;
+            return &m_chunks[chunk][begin % chunk_size];
+        }
+
+        /// @brief  Add slots after the last ones, if they are on the top.
+        /// @param  begin       Position of the first slot.
+        /// @param  count       Number of slots.
+        /// @param  new_count   New number of slots.
+        /// @return `true` if the slots were added.
+        bool grow(size_t begin, size_t count, size_t new_count)
+        {
+            if (m_top != begin + count || begin % chunk_size + new_count > chunk_size)
+            {
+                return false;
+            }
+            m_top = begin + new_count;
+            return true;
+        }
+
+        /// @brief  Give slots back.
+        /// @param  slots   First slot.
+        /// @param  count   Number of slots.
+        /// @param  begin   Position of the first slot.
+        /// @param  mark    Top before the slots were taken.
+        void pop(Slot* slots, size_t count, size_t begin, size_t mark)
+        {
+            for (size_t i = count; i > 0; --i)
+            {
+                slots[i - 1].clear();
+            }
+            // slots of other scopes may still be above
+            if (m_top == begin + count)
+            {
+                m_top = mark;
+            }
+        }
+
+    private:
+        std::vector< std::unique_ptr<Slot[]> > m_chunks;
+        size_t m_top = 0;
+    };
+
+
     // `Scope` constructor.
     Scope::Scope() :
         m_parent(nullptr),
-        m_return_point(new ReturnPoint()),
-        m_break_point(new BreakPoint())
+        m_root(this),
+        m_frame(Frame::block),
+        m_slots(nullptr),
+        m_slot_count(0),
+        m_frames(nullptr),
+        m_frames_begin(0),
+        m_frames_mark(0),
+        m_own_completion(Completion::normal),
+        m_completion(&m_own_completion)
     {
 
     }
@@ -17,23 +108,43 @@ namespace creek
     // `Scope` constructor.
     // @param  parent  Parent scope.
     Scope::Scope(Scope& parent) :
-        Scope(parent, parent.m_return_point, parent.m_break_point)
+        Scope(parent, Frame::block)
     {
 
     }
 
     /// @brief  `Scope` constructor.
     /// @param  parent      Parent scope (can be the global scope).
-    /// @param  return_pt   Return point.
-    /// @param  break_pt    Break point.
-    Scope::Scope(Scope& parent,
-                 const std::shared_ptr<ReturnPoint>& return_pt,
-                 const std::shared_ptr<BreakPoint>& break_pt) :
+    /// @param  frame       Control flow started by the scope.
+    /// @param  slot_count  Number of slots to reserve.
+    Scope::Scope(Scope& parent, Frame frame, unsigned slot_count) :
         m_parent(&parent),
-        m_return_point(return_pt),
-        m_break_point(break_pt)
+        m_root(parent.m_root),
+        m_frame(frame),
+        m_slots(nullptr),
+        m_slot_count(0),
+        m_frames(nullptr),
+        m_frames_begin(0),
+        m_frames_mark(0),
+        m_own_completion(Completion::normal),
+        m_completion(frame == Frame::block ? parent.m_completion : &m_own_completion)
     {
+        if (slot_count > 0)
+        {
+            reserve_slot(slot_count - 1);
+        }
+    }
 
+    Scope::~Scope()
+    {
+        if (m_frames)
+        {
+            m_frames->pop(m_slots, m_slot_count, m_frames_begin, m_frames_mark);
+        }
+        else
+        {
+            delete[] m_slots;
+        }
     }
 
     // Create a new variable in local scope.
@@ -41,63 +152,230 @@ namespace creek
     // @param  data        Initial value.
     Variable& Scope::create_local_var(VarName var_name, Data* data)
     {
+        return create_local_var(var_name, data, no_slot);
+    }
+
+    // Create a new variable in local scope.
+    // @param  var_name    Variable name.
+    // @param  data        Initial value.
+    // @param  slot        Slot given by `VarResolver`, or `no_slot`.
+    // @param  is_captured Is the variable captured by a closure?
+    Variable& Scope::create_local_var(VarName var_name, Data* data, unsigned slot, bool is_captured)
+    {
+        // the slot may be taken by another program run in the same scope
+        if (slot != no_slot && reserve_slot(slot))
+        {
+            Slot& s = m_slots[slot];
+            if (!s.variable)
+            {
+                // a closure created before may already share the variable
+                if (s.box && s.var_name != var_name)
+                {
+                    s.box.reset();
+                }
+                s.var_name = var_name;
+                if (is_captured || s.box)
+                {
+                    if (!s.box)
+                    {
+                        s.box = std::make_shared<Variable>();
+                    }
+                    s.variable = s.box.get();
+                }
+                else
+                {
+                    s.variable = &s.value;
+                }
+                s.variable->reset(data);
+                return *s.variable;
+            }
+
+            // `VarResolver` gives the same slot to a name declared twice
+            if (s.var_name == var_name)
+            {
+                throw Exception(std::string("Variable ") + var_name.name() + std::string(" already exists"));
+            }
+        }
+
         // check if name is in scope
-        if (m_vars.count(var_name) != 0)
+        auto it = m_vars.lower_bound(var_name);
+        bool is_named = it != m_vars.end() && it->first == var_name;
+        if (is_named && it->second.variable)
         {
             throw Exception(std::string("Variable ") + var_name.name() + std::string(" already exists"));
         }
 
-        // insert new variable
-        auto emplaceo = m_vars.emplace(var_name, Variable(data));
-        if (!emplaceo.second)   // not inserted
+        // insert new variable; a closure created before may already share it
+        if (!is_named)
         {
-            throw Exception(std::string("Can't insert variable ") + var_name.name());
+            it = m_vars.emplace_hint(it, var_name, Slot());
         }
-        return emplaceo.first->second;
+        Slot& s = it->second;
+        s.var_name = var_name;
+        s.variable = s.box ? s.box.get() : &s.value;
+        s.variable->reset(data);
+        return *s.variable;
     }
 
     // Find a variable accessible from this scope.
     // @param  var_name    Variable name.
     Variable& Scope::find_var(VarName var_name)
     {
-        // check if name is in scope
-        auto it = m_vars.find(var_name);
-        if (it == m_vars.end())
+        if (Slot* s = find_named(var_name))
         {
-            if (m_parent)
+            return *s->variable;
+        }
+        throw Exception(std::string("Can't find variable ") + var_name.name());
+    }
+
+    // Find a variable accessible from this scope.
+    // @param  var_name    Variable name.
+    // @param  depth       Number of scopes to go up.
+    // @param  slot        Slot given by `VarResolver`, or `no_slot`.
+    Variable& Scope::find_var(VarName var_name, unsigned depth, unsigned slot)
+    {
+        Scope* scope = this;
+        for (unsigned i = 0; i < depth && scope; ++i)
+        {
+            scope = scope->m_parent;
+        }
+
+        // the slot may be empty or reused by another program run in the
+        // same scope, so check the name
+        if (scope && slot < scope->m_slot_count)
+        {
+            Slot& s = scope->m_slots[slot];
+            if (s.holds(var_name))
             {
-                // find var in parent scope
-                return m_parent->find_var(var_name);
+                return *s.variable;
             }
-            else
+        }
+
+        return find_var(var_name);
+    }
+
+    // Get a variable to share with a closure.
+    // @param  var_name    Variable name.
+    // @param  depth       Number of scopes to go up.
+    // @param  slot        Slot given by `VarResolver`, or `no_slot`.
+    std::shared_ptr<Variable> Scope::capture_var(VarName var_name, unsigned depth, unsigned slot)
+    {
+        Scope* scope = this;
+        for (unsigned i = 0; i < depth && scope; ++i)
+        {
+            scope = scope->m_parent;
+        }
+
+        if (scope && slot != no_slot && scope->reserve_slot(slot))
+        {
+            Slot& s = scope->m_slots[slot];
+            if (!s.variable)
+            {
+                // not created yet; it will be created in the shared variable
+                if (!s.box || s.var_name != var_name)
+                {
+                    s.var_name = var_name;
+                    s.box = std::make_shared<Variable>();
+                }
+                return s.box;
+            }
+            if (s.var_name == var_name)
             {
-                throw Exception(std::string("Can't find variable ") + var_name.name());
+                return s.share();
             }
         }
-        return it->second;
+
+        // not resolved
+        if (Slot* s = find_named(var_name))
+        {
+            return s->share();
+        }
+        return nullptr;
     }
 
-    // @brief  Is the function returning?
-    bool Scope::is_returning() const
+    // Add a variable shared by another scope.
+    // @param  var_name    Variable name.
+    // @param  variable    Variable given by `capture_var`.
+    // @param  slot        Slot given by `VarResolver`.
+    void Scope::bind_var(VarName var_name, const std::shared_ptr<Variable>& variable, unsigned slot)
     {
-        return m_return_point->is_returning;
+        if (variable && slot != no_slot && reserve_slot(slot) && !m_slots[slot].variable)
+        {
+            Slot& s = m_slots[slot];
+            s.var_name = var_name;
+            s.box = variable;
+            s.variable = s.box.get();
+        }
     }
 
-    // @brief  Is the loop breaking?
-    bool Scope::is_breaking() const
+    // Destroy the variables of the scope.
+    void Scope::clear()
     {
-        return m_break_point->is_breaking || m_return_point->is_returning;
+        for (unsigned i = m_slot_count; i > 0; --i)
+        {
+            m_slots[i - 1].clear();
+        }
+        if (!m_vars.empty())
+        {
+            m_vars.clear();
+        }
     }
 
-    // @brief  Get the return point.
-    const std::shared_ptr<Scope::ReturnPoint>& Scope::return_point() const
+    // @brief  Get the root scope.
+    Scope& Scope::root_scope() const
     {
-        return m_return_point;
+        return *m_root;
+    }
+
+
+    // Find a variable stored by name, in this scope or above.
+    // @param  var_name    Variable name.
+    Scope::Slot* Scope::find_named(VarName var_name)
+    {
+        for (Scope* scope = this; scope; scope = scope->m_parent)
+        {
+            auto it = scope->m_vars.find(var_name);
+            if (it != scope->m_vars.end() && it->second.variable)
+            {
+                return &it->second;
+            }
+        }
+        return nullptr;
     }
 
-    // @brief  Get the break point.
-    const std::shared_ptr<Scope::BreakPoint>& Scope::break_point() const
+    // Make room for a slot, if the scope can grow.
+    // @param  slot    Slot given by `VarResolver`.
+    bool Scope::reserve_slot(unsigned slot)
     {
-        return m_break_point;
+        if (slot < m_slot_count)
+        {
+            return true;
+        }
+
+        if (m_frame == Frame::closure)
+        {
+            // closure environments outlive the scopes created after them
+            if (m_slots)
+            {
+                return false;
+            }
+            m_slots = new Slot[slot + 1];
+        }
+        else if (!m_frames)
+        {
+            FrameStack& frames = FrameStack::current();
+            m_slots = frames.push(slot + 1, m_frames_begin, m_frames_mark);
+            if (!m_slots)
+            {
+                return false;
+            }
+            m_frames = &frames;
+        }
+        else if (!m_frames->grow(m_frames_begin, m_slot_count, slot + 1))
+        {
+            return false;
+        }
+        m_slot_count = slot + 1;
+        return true;
     }
 }
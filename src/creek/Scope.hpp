@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cstdint>
 #include <map>
+#include <memory>
+#include <vector>
 
 #include <creek/api_mode.hpp>
 #include <creek/VarName.hpp>
@@ -10,25 +13,37 @@
 namespace creek
 {
     /// @brief  Space for variable names.
+    /// Variables resolved by `VarResolver` are stored in slots, contiguous in
+    /// a stack of the calling thread, and are only found by slot; the others
+    /// are stored and found by name.
+    /// Scopes must be destroyed in the reverse order of creation, like they
+    /// are by the evaluation of nested expressions; only closure
+    /// environments can outlive the scopes created after them.
     class CREEK_API Scope
     {
     public:
-        /// @brief  Return marker shared between scopes of a function.
-        /// When `is_returning` is `true`, blocks sharing this struct will end
-        /// and yield the last evaluated expression.
-        struct ReturnPoint
+        /// @brief  Control flow started by a scope.
+        enum class Frame
         {
-            bool is_returning = false; ///< Is the function returning?
+            block,      ///< Shares the completion of its parent.
+            function,   ///< Has its own completion.
+            closure,    ///< Environment of a closure, with the captured variables.
         };
 
-        /// @brief  Break marker shared between scopes of a loop.
-        /// When `is_breaking` is `true`, blocks sharing this struct will end
-        /// and yield the last evaluated expression.
-        struct BreakPoint
+        /// @brief  How the statements of a function completed.
+        /// Set by `return` and `break`, and shared by all the scopes of a
+        /// function: blocks end while it is not `normal`, and the innermost
+        /// loop consumes a `breaking` completion.
+        enum class Completion : uint8_t
         {
-            bool is_breaking = false; ///< Is the loop breaking?
+            normal,     ///< Keep evaluating statements.
+            breaking,   ///< The innermost loop is breaking.
+            returning,  ///< The function is returning.
         };
 
+        /// @brief  Slot index of variables not resolved by `VarResolver`.
+        static const unsigned no_slot = ~0u;
+
 
         /// @brief  `Scope` constructor.
         /// Scope with no parent.
@@ -40,15 +55,17 @@ namespace creek
 
         /// @brief  `Scope` constructor.
         /// @param  parent      Parent scope (can be the global scope).
-        /// @param  return_pt   Return point.
-        /// @param  break_pt    Break point.
-        Scope(Scope& parent,
-              const std::shared_ptr<ReturnPoint>& return_pt,
-              const std::shared_ptr<BreakPoint>& break_pt);
+        /// @param  frame       Control flow started by the scope.
+        /// @param  slot_count  Number of slots to reserve, given by `VarResolver`.
+        Scope(Scope& parent, Frame frame, unsigned slot_count = 0);
 
         Scope(const Scope& other) = delete;
         Scope(Scope&& other) = delete;
 
+        /// @brief  `Scope` destructor.
+        /// Destroys the variables and gives the slots back to the stack.
+        ~Scope();
+
 
         /// @brief  Create a new variable in local scope.
         /// @param  var_name    Variable name.
@@ -58,33 +75,126 @@ namespace creek
         /// or the variable is deleted.
         Variable& create_local_var(VarName var_name, Data* data);
 
+        /// @brief  Create a new variable in local scope.
+        /// @param  var_name    Variable name.
+        /// @param  data        Initial value.
+        /// @param  slot        Slot given by `VarResolver`, or `no_slot`.
+        /// @param  is_captured Is the variable captured by a closure?
+        /// @return             A reference to the created variable.
+        /// Captured variables are shared with the closures, so they can
+        /// outlive the scope.
+        Variable& create_local_var(VarName var_name, Data* data, unsigned slot, bool is_captured = false);
+
         /// @brief  Find a variable accessible from this scope.
+        /// Only the variables stored by name are found.
         /// @param  var_name    Variable name.
         /// @return             A reference to the variable.
         /// The returned reference remains valid until the scope is destroyed
         /// or the variable is deleted.
         Variable& find_var(VarName var_name);
 
-        /// @brief  Is the function returning?
-        /// @return `true` if the shared return point is marked as returning.
-        bool is_returning() const;
+        /// @brief  Find a variable accessible from this scope.
+        /// @param  var_name    Variable name.
+        /// @param  depth       Number of scopes to go up, given by `VarResolver`.
+        /// @param  slot        Slot given by `VarResolver`, or `no_slot`.
+        /// @return             A reference to the variable.
+        /// Falls back to the lookup by name if the slot doesn't hold the
+        /// variable.
+        Variable& find_var(VarName var_name, unsigned depth, unsigned slot);
 
-        /// @brief  Is the loop breaking or the function returning?
-        /// Returns `true` if either the shared return point is marked as
-        /// returning or the shared break point is marked as breaking.
-        bool is_breaking() const;
+        /// @brief  Get a variable to share with a closure.
+        /// @param  var_name    Variable name.
+        /// @param  depth       Number of scopes to go up, given by `VarResolver`.
+        /// @param  slot        Slot given by `VarResolver`, or `no_slot`.
+        /// @return             The shared variable, or `nullptr` if not found.
+        /// If the variable is not created yet, it will be created in the
+        /// returned one. Variables not created as captured are moved to a
+        /// shared variable.
+        std::shared_ptr<Variable> capture_var(VarName var_name, unsigned depth, unsigned slot);
+
+        /// @brief  Add a variable shared by another scope.
+        /// @param  var_name    Variable name.
+        /// @param  variable    Variable given by `capture_var`.
+        /// @param  slot        Slot given by `VarResolver`.
+        void bind_var(VarName var_name, const std::shared_ptr<Variable>& variable, unsigned slot);
+
+        /// @brief  Destroy the variables of the scope.
+        /// The slots are kept, so loops can reuse the scope of their body
+        /// on each iteration.
+        void clear();
+
+        /// @brief  Get the root scope.
+        /// It is the scope with no parent above this one; closures look up
+        /// there the variables not resolved by `VarResolver`.
+        Scope& root_scope() const;
+
+        /// @brief  Get the completion of the function.
+        /// Blocks test it after each statement, so it is a single load.
+        Completion& completion() const
+        {
+            return *m_completion;
+        }
 
-        /// @brief  Get the return point.
-        const std::shared_ptr<ReturnPoint>& return_point() const;
 
-        /// @brief  Get the break point.
-        const std::shared_ptr<BreakPoint>& break_point() const;
+    private:
+        /// @brief  Variable created in a slot, or stored by name.
+        struct Slot
+        {
+            VarName var_name;               ///< Variable name.
+            Variable* variable = nullptr;   ///< `value` or `*box`; `nullptr` until created.
+            Variable value;                 ///< Variable not captured.
+            std::shared_ptr<Variable> box;  ///< Variable shared with closures.
+
+            /// @brief  Is the variable created, with this name?
+            /// A variable shared with a closure before being created is empty.
+            bool holds(VarName name) const
+            {
+                return variable && var_name == name && (!box || *box);
+            }
+
+            /// @brief  Get the variable to share with a closure.
+            /// A variable not captured yet is moved to `box`.
+            std::shared_ptr<Variable> share()
+            {
+                if (!box)
+                {
+                    box = std::make_shared<Variable>(std::move(value));
+                    variable = box.get();
+                }
+                return box;
+            }
+
+            /// @brief  Destroy the variable.
+            void clear()
+            {
+                variable = nullptr;
+                value.reset(nullptr);
+                box.reset();
+            }
+        };
 
+        class FrameStack;
+
+        /// @brief  Find a variable stored by name, in this scope or above.
+        /// @return The slot of the variable, or `nullptr` if not found.
+        Slot* find_named(VarName var_name);
+
+        /// @brief  Make room for a slot, if the scope can grow.
+        /// @return `true` if `slot` is in `m_slots`.
+        bool reserve_slot(unsigned slot);
 
-    private:
         Scope* m_parent;
-        std::map<VarName, Variable> m_vars;
-        std::shared_ptr<ReturnPoint> m_return_point;
-        std::shared_ptr<BreakPoint> m_break_point;
+        Scope* m_root;
+        Frame m_frame;
+        std::map<VarName, Slot> m_vars;    ///< Variables not resolved.
+
+        Slot* m_slots;              ///< Slots, in `m_frames` or owned by a closure environment.
+        unsigned m_slot_count;      ///< Number of slots.
+        FrameStack* m_frames;       ///< Stack of the slots, if any.
+        size_t m_frames_begin;      ///< Position of the slots in `m_frames`.
+        size_t m_frames_mark;       ///< Top of `m_frames` before the slots.
+
+        Completion m_own_completion;
+        Completion* m_completion;   ///< `m_own_completion` or the one of the function.
     };
 }
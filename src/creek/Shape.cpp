@@ -0,0 +1,63 @@
+#include <creek/Shape.hpp>
+
+#include <creek/Isolate.hpp>
+
+
+namespace creek
+{
+    // `Shape` constructor.
+    Shape::Shape() : m_last_key(0), m_last_child(nullptr)
+    {
+
+    }
+
+
+    // Get the shape without attributes of the current isolate.
+    const Shape* Shape::root()
+    {
+        return Isolate::current().root_shape();
+    }
+
+
+    // Find the slot of an attribute.
+    size_t Shape::find(VarName key) const
+    {
+        auto iter = m_slots.find(key);
+        return iter == m_slots.end() ? no_slot : iter->second;
+    }
+
+    // Get the shape with a new attribute.
+    const Shape* Shape::add(VarName key) const
+    {
+        // objects are usually built the same way, so check the last transition first
+        if (m_last_child && m_last_key == key.id())
+        {
+            return m_last_child;
+        }
+
+        auto& transition = m_transitions[key];
+        if (!transition)
+        {
+            transition.reset(new Shape());
+            transition->m_keys = m_keys;
+            transition->m_keys.push_back(key);
+            transition->m_slots = m_slots;
+            transition->m_slots[key] = m_keys.size();
+        }
+        m_last_key = key.id();
+        m_last_child = transition.get();
+        return m_last_child;
+    }
+
+    // Number of attributes.
+    size_t Shape::size() const
+    {
+        return m_keys.size();
+    }
+
+    // Attribute names, in slot order.
+    const std::vector<VarName>& Shape::keys() const
+    {
+        return m_keys;
+    }
+}
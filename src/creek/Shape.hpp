@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <creek/api_mode.hpp>
+#include <creek/VarName.hpp>
+
+
+namespace creek
+{
+    /// @brief  Layout of the attributes of an object (hidden class).
+    /// Gives each attribute name a slot index. Objects that got the same
+    /// attributes in the same order share the same shape, so only the
+    /// attribute values are stored per object.
+    /// Shapes are immutable; adding an attribute makes a transition to a
+    /// child shape, which is remembered to be shared by the next objects.
+    /// Shapes are owned by their parent and live as long as their isolate,
+    /// so they are referenced by plain pointers.
+    class CREEK_API Shape
+    {
+    public:
+        /// @brief  Value of `find` for attributes not in the shape.
+        static const size_t no_slot = ~size_t(0);
+
+
+        /// @brief  Get the shape without attributes of the current isolate.
+        /// Every shape is a transition from this one.
+        static const Shape* root();
+
+
+        /// @brief  Find the slot of an attribute.
+        /// @return Slot index, or `no_slot` if not found.
+        size_t find(VarName key) const;
+
+        /// @brief  Get the shape with a new attribute.
+        /// The attribute takes the slot `size()`.
+        /// @param  key     Attribute name; must not be in this shape.
+        const Shape* add(VarName key) const;
+
+        /// @brief  Number of attributes.
+        size_t size() const;
+
+        /// @brief  Attribute names, in slot order.
+        const std::vector<VarName>& keys() const;
+
+
+    private:
+        friend class Isolate;
+
+        Shape();
+
+        std::vector<VarName> m_keys;
+        std::map<VarName, size_t> m_slots;
+        mutable std::map< VarName, std::unique_ptr<Shape> > m_transitions;
+        mutable VarName::Id m_last_key;
+        mutable const Shape* m_last_child;
+    };
+}
@@ -6,7 +6,7 @@
 #include <creek/CFunction.hpp>
 #include <creek/Expression.hpp>
 #include <creek/Identifier.hpp>
-#include <creek/Interpreter.hpp>
+#include <creek/ModuleRegistry.hpp>
 #include <creek/Number.hpp>
 #include <creek/Object.hpp>
 #include <creek/Scope.hpp>
@@ -48,68 +48,29 @@ namespace creek
     }
 
 
-    Data* func_require(Scope& scope, std::vector< std::unique_ptr<Data> >& args)
+    // Load standard library.
+    // @param  scope   Scope where standard variables are created.
+    void load_standard_library(Scope& scope)
     {
-        static const std::vector<std::string> path_templates
-        {
-            "./?.txt",
-        };
-
-        auto module_name = args[0]->string_value();
-
-
-        // check path
-        std::string path;
-        bool found = false;
-        for (auto& path_template : path_templates)
-        {
-            // resolve path template
-            path = path_template;
-            size_t pos = 0;
-            while (true)
-            {
-                pos = path.find_first_of('?', pos);
-                if (pos == std::string::npos)
-                    break;
-                path.replace(pos, 1, module_name);
-            }
-
-            // test file existence
-            std::ifstream test_file(path);
-            if (!test_file.fail())
-            {
-                found = true;
-            }
-        }
-
-        if (!found)
-        {
-            throw Exception(std::string("Can't find module file ") + module_name);
-        }
-
-
-        // interpreter
-        Interpreter interpreter;
-
-        // create program
-        std::unique_ptr<Expression> program;
-        program.reset(interpreter.load_file(path));
-
-        // run program
-        Variable result = program->eval(scope);
-        return result.release();
+        load_standard_library(scope, std::make_shared<ModuleRegistry>());
     }
 
-
     // Load standard library.
     // @param  scope   Scope where standard variables are created.
-    void load_standard_library(Scope& scope)
+    // @param  modules Modules loaded by `require`.
+    void load_standard_library(Scope& scope, const std::shared_ptr<ModuleRegistry>& modules)
     {
+        // modules live as long as the `require` function
+        auto func_require = [modules](Scope& scope, std::vector< std::unique_ptr<Data> >& args) -> Data*
+        {
+            return modules->require(scope, args[0]->string_value()).release();
+        };
+
         // global functions
         scope.create_local_var(VarName::from_name("print"),     new CFunction(scope, 1, true, &func_print));
         scope.create_local_var(VarName::from_name("scan"),      new CFunction(scope, 1, true, &func_scan));
         scope.create_local_var(VarName::from_name("debug"),     new CFunction(scope, 1, true, &func_debug));
         scope.create_local_var(VarName::from_name("exit"),      new CFunction(scope, &exit));
-        scope.create_local_var(VarName::from_name("require"),   new CFunction(scope, 1, false, &func_require));
+        scope.create_local_var(VarName::from_name("require"),   new CFunction(scope, 1, false, func_require));
     }
 }
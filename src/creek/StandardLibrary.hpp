@@ -1,14 +1,23 @@
 #pragma once
 
+#include <memory>
+
 #include <creek/api_mode.hpp>
 
 
 namespace creek
 {
+    class ModuleRegistry;
     class Scope;
 
 
     /// Load standard library.
     /// @param  scope   Scope where standard variables are created.
     CREEK_API extern void load_standard_library(Scope& scope);
+
+    /// Load standard library.
+    /// @param  scope   Scope where standard variables are created.
+    /// @param  modules Modules loaded by `require`; shared by the scopes
+    ///                 given the same registry.
+    CREEK_API extern void load_standard_library(Scope& scope, const std::shared_ptr<ModuleRegistry>& modules);
 }
@@ -1,30 +1,77 @@
 #include <creek/String.hpp>
 
+#include <functional>
+#include <utility>
+
 #include <creek/Expression_DataTypes.hpp>
 #include <creek/GlobalScope.hpp>
+#include <creek/Iterator.hpp>
 #include <creek/utility.hpp>
 
 
 namespace creek
 {
-    String::String(Value value) : m_value(value)
+    namespace
+    {
+        // Iterator over the characters of a string, as strings.
+        // Iterates over the string as it was when created; changes to the
+        // string copy its buffer.
+        class StringIterator : public Iterator
+        {
+        public:
+            StringIterator(const std::shared_ptr<String::Value>& chars) :
+                m_chars(chars),
+                m_position(0)
+            {
+
+            }
+
+            Data* copy() const override
+            {
+                return new StringIterator(*this);
+            }
+
+            bool next(Variable& value) override
+            {
+                if (m_position >= m_chars->size())
+                {
+                    return false;
+                }
+                value = Variable(new String(String::Value(1, (*m_chars)[m_position++])));
+                return true;
+            }
+
+        private:
+            std::shared_ptr<String::Value> m_chars;
+            size_t m_position;
+        };
+    }
+
+
+    String::String(Value value) : Data(DataType::string), m_value(std::make_shared<Value>(std::move(value))), m_hash(0)
     {
 
     }
 
     const String::Value& String::value() const
     {
-        return m_value;
+        return *m_value;
     }
 
     String::Value& String::value()
     {
-        return m_value;
+        if (m_value.use_count() > 1)
+        {
+            m_value = std::make_shared<Value>(*m_value);
+        }
+        m_hash = 0;
+        return *m_value;
     }
 
     Data* String::copy() const
     {
-        return new String(m_value);
+        // share the buffer; `value()` copies it before any change
+        return new String(*this);
     }
 
     std::string String::class_name() const
@@ -34,12 +81,12 @@ namespace creek
 
     std::string String::debug_text() const
     {
-        return std::string("\"") + escape_string(m_value) + std::string("\"");
+        return std::string("\"") + escape_string(value()) + std::string("\"");
     }
 
     Expression* String::to_expression() const
     {
-        return new ExprString(m_value);
+        return new ExprString(value());
     }
 
 
@@ -50,12 +97,12 @@ namespace creek
 
     char String::char_value() const
     {
-        return m_value.size() == 0 ? '\0' : m_value.front();
+        return m_value->size() == 0 ? '\0' : m_value->front();
     }
 
     const std::string& String::string_value() const
     {
-        return m_value;
+        return *m_value;
     }
 
     // void String::string_value(const std::string& new_value)
@@ -65,7 +112,7 @@ namespace creek
 
     Data* String::index(Data* key)
     {
-        Value value = this->string_value();
+        const Value& value = this->string_value();
 
         int pos = key->int_value();
         if (pos < 0)
@@ -81,13 +128,18 @@ namespace creek
         int pos = key->int_value();
         if (pos < 0)
         {
-            pos = m_value.size() + pos;
+            pos = m_value->size() + pos;
         }
-        m_value[pos] = new_data->int_value();
+        value()[pos] = new_data->int_value();
 
         return new_data;
     }
 
+    Data* String::iter()
+    {
+        return new StringIterator(m_value);
+    }
+
     Data* String::add(Data* other)
     {
         return new String(this->string_value() + other->string_value());
@@ -166,8 +218,17 @@ namespace creek
         return this->string_value().compare(other->string_value());
     }
 
+    size_t String::hash() const
+    {
+        if (m_hash == 0)
+        {
+            m_hash = std::hash<Value>()(*m_value);
+        }
+        return m_hash;
+    }
+
     Data* String::get_class() const
     {
-        return GlobalScope::class_String->copy();
+        return GlobalScope::current().class_String->copy();
     }
 }
@@ -2,6 +2,7 @@
 
 #include <creek/Data.hpp>
 
+#include <memory>
 #include <string>
 
 #include <creek/api_mode.hpp>
@@ -10,6 +11,7 @@
 namespace creek
 {
     /// Data type: character string.
+    /// Copies share the same character buffer until one of them is modified.
     class CREEK_API String : public Data
     {
     public:
@@ -22,6 +24,9 @@ namespace creek
         String(Value value);
 
         const Value& value() const;
+
+        /// Get the value to modify it.
+        /// The buffer is copied first if it is shared.
         Value& value();
 
 
@@ -43,6 +48,8 @@ namespace creek
         Data* index(Data* key) override;
         Data* index(Data* key, Data* new_value) override;
 
+        Data* iter() override;
+
         Data* add(Data* other) override;
         // Data* sub(Data* other) override;
         Data* mul(Data* other) override;
@@ -55,10 +62,12 @@ namespace creek
         // Data* bit_xor(Data* other) override;
         // Data* bit_not() override;
         int cmp(Data* other) override;
+        size_t hash() const override;
 
         Data* get_class() const override;
 
     private:
-        Value m_value;
+        std::shared_ptr<Value> m_value;
+        mutable size_t m_hash; ///< Cached hash; 0 if not computed yet.
     };
 }
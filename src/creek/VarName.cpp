@@ -1,13 +1,165 @@
 #include <creek/VarName.hpp>
 
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
 #include <creek/Exception.hpp>
 
 
 namespace creek
 {
-    std::map<VarName::Name, VarName::Id> VarName::s_ids = { {"", 0} };
+    namespace
+    {
+        // names of `VarName::Known`, in order
+        const char* const known_names[] =
+        {
+            "",
+            "add",
+            "bit_and",
+            "bit_left_shift",
+            "bit_not",
+            "bit_or",
+            "bit_right_shift",
+            "bit_xor",
+            "call",
+            "cmp",
+            "derive",
+            "div",
+            "exp",
+            "id",
+            "index_get",
+            "index_set",
+            "init",
+            "instantiate",
+            "iter",
+            "keys",
+            "mod",
+            "mul",
+            "new",
+            "next",
+            "sub",
+            "super_class",
+            "to_boolean",
+            "to_number",
+            "to_string",
+            "unm",
+        };
+        static_assert(sizeof(known_names) / sizeof(known_names[0]) == VarName::known_count, "A known name is missing");
+
+
+        // registry of the interned names
+        // Names are kept in the hash tables of the shards, whose keys never
+        // move; the table of ids points to them. An id is published after
+        // its name is stored, so reading the name of a known id needs no
+        // lock.
+        class Registry
+        {
+        public:
+            Registry()
+            {
+                for (auto name : known_names)
+                {
+                    intern(name);
+                }
+            }
+
+            ~Registry()
+            {
+                for (auto& chunk : m_chunks)
+                {
+                    delete[] chunk.load(std::memory_order_relaxed);
+                }
+            }
+
+            // get the id of a name, registering it if new
+            VarName::Id intern(const VarName::Name& name)
+            {
+                size_t hash = std::hash<VarName::Name>()(name);
+                Shard& shard = m_shards[(hash >> 16) % shard_count];
+
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                auto it = shard.ids.find(name);
+                if (it != shard.ids.end())
+                {
+                    return it->second;
+                }
+
+                VarName::Id id = m_size.fetch_add(1);
+                it = shard.ids.emplace(name, id).first;
+                slot(id, true)->store(&it->first, std::memory_order_release);
+                return id;
+            }
+
+            // get the name of an id, or null if not registered
+            const VarName::Name* find(VarName::Id id)
+            {
+                auto name_slot = slot(id, false);
+                return name_slot ? name_slot->load(std::memory_order_acquire) : nullptr;
+            }
+
+        private:
+            using Slot = std::atomic<const VarName::Name*>;
+
+            static const size_t shard_count = 64;
+            static const size_t chunk_count = 48;
+            static const size_t first_chunk_size = 1024;
+
+            struct Shard
+            {
+                std::mutex mutex;
+                std::unordered_map<VarName::Name, VarName::Id> ids;
+            };
+
+            // get the slot of an id; chunk `i` has `first_chunk_size << i`
+            // slots, so slots never move
+            Slot* slot(VarName::Id id, bool create)
+            {
+                size_t chunk = 0;
+                size_t chunk_size = first_chunk_size;
+                while (id >= chunk_size && chunk + 1 < chunk_count)
+                {
+                    id -= chunk_size;
+                    chunk += 1;
+                    chunk_size *= 2;
+                }
+                if (id >= chunk_size)
+                {
+                    return nullptr;
+                }
+
+                Slot* slots = m_chunks[chunk].load(std::memory_order_acquire);
+                if (!slots && create)
+                {
+                    // other threads can be creating the same chunk
+                    Slot* new_slots = new Slot[chunk_size]();
+                    if (m_chunks[chunk].compare_exchange_strong(slots, new_slots, std::memory_order_acq_rel))
+                    {
+                        slots = new_slots;
+                    }
+                    else
+                    {
+                        delete[] new_slots;
+                    }
+                }
+                return slots ? &slots[id] : nullptr;
+            }
+
+            Shard m_shards[shard_count];
+            std::atomic<Slot*> m_chunks[chunk_count] = {};
+            std::atomic<VarName::Id> m_size{0};
+        };
+
+        // created on first use, so names can be interned during the static
+        // initialization of any translation unit
+        Registry& registry()
+        {
+            static Registry registry;
+            return registry;
+        }
+    }
 
-    std::vector<VarName::Name> VarName::s_names = {""};
 
     // @brief  `VarName` constructor.
     VarName::VarName() : m_id(0)
@@ -48,7 +200,7 @@ namespace creek
     // If the id is not register, throws an exception.
     VarName VarName::from_id(Id id)
     {
-        if (id >= s_names.size())
+        if (!registry().find(id))
         {
             throw Exception("VarName id not registered");
         }
@@ -59,6 +211,7 @@ namespace creek
     VarName& VarName::operator = (const VarName& other)
     {
         m_id = other.m_id;
+        return *this;
     }
 
 
@@ -66,15 +219,7 @@ namespace creek
     // If the name is not register, creates a new VarName.
     VarName VarName::from_name(const std::string& name)
     {
-        auto it = s_ids.find(name);
-        if (it == s_ids.end())
-        {
-            s_names.push_back(name);
-            Id id = s_names.size() - 1;
-            auto emplaceo = s_ids.emplace(name, id);
-            it = emplaceo.first;
-        }
-        return VarName(it->second);
+        return VarName(registry().intern(name));
     }
 
     // Get the id.
@@ -86,7 +231,7 @@ namespace creek
     // Get the name.
     const VarName::Name& VarName::name() const
     {
-        return s_names[m_id];
+        return *registry().find(m_id);
     }
 
     bool VarName::operator == (const VarName& other) const
@@ -1,9 +1,7 @@
 #pragma once
 
 #include <cstdint>
-#include <map>
 #include <string>
-#include <vector>
 
 #include <creek/api_mode.hpp>
 
@@ -11,6 +9,10 @@
 namespace creek
 {
     /// Variable name.
+    /// Names are interned in a registry shared by all threads. Creating a
+    /// `VarName` from a name hashes it and locks one of many shards of the
+    /// registry; getting the name of a `VarName` does not lock. Names used
+    /// by the engine are `Known` constants, with no lookup at all.
     class CREEK_API VarName
     {
     public:
@@ -20,6 +22,44 @@ namespace creek
         /// Type used for the id.
         using Id = uintptr_t;
 
+        /// @brief  Names used by the engine.
+        /// They are interned before any other name, in this order, so
+        /// making a `VarName` from them needs no lookup.
+        enum Known : Id
+        {
+            vn_empty = 0,       ///< Empty name, as in a default `VarName`.
+            vn_add,
+            vn_bit_and,
+            vn_bit_left_shift,
+            vn_bit_not,
+            vn_bit_or,
+            vn_bit_right_shift,
+            vn_bit_xor,
+            vn_call,
+            vn_cmp,
+            vn_derive,
+            vn_div,
+            vn_exp,
+            vn_id,
+            vn_index_get,
+            vn_index_set,
+            vn_init,
+            vn_instantiate,
+            vn_iter,
+            vn_keys,
+            vn_mod,
+            vn_mul,
+            vn_new,
+            vn_next,
+            vn_sub,
+            vn_super_class,
+            vn_to_boolean,
+            vn_to_number,
+            vn_to_string,
+            vn_unm,
+            known_count,        ///< Number of known names.
+        };
+
 
         /// @brief  `VarName` constructor.
         VarName();
@@ -32,6 +72,13 @@ namespace creek
         /// @param  name    Name of the variable.
         VarName(const char* name);
 
+        /// @brief  `VarName` constructor.
+        /// @param  known   Name used by the engine.
+        VarName(Known known) : m_id(known)
+        {
+
+        }
+
         /// @brief  `VarName` copy constructor.
         VarName(const VarName& other);
 
@@ -72,9 +119,6 @@ namespace creek
     private:
         explicit VarName(Id id);
 
-        static std::map<Name, Id> s_ids;
-        static std::vector<Name> s_names;
-
         Id m_id;
     };
 }
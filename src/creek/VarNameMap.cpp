@@ -1,17 +1,19 @@
 #include <creek/VarNameMap.hpp>
 
+#include <cstring>
+
 #include <creek/Exception.hpp>
 
 
 namespace creek
 {
     /// @brief  Get an ID from a name.
-    VarName::Id VarNameMap::id_from_name(const VarName::Name& name)
+    VarNameMap::Id VarNameMap::id_from_name(const VarName::Name& name)
     {
         auto iter = m_id_from_name.find(name);
         if (iter == m_id_from_name.end())
         {
-            VarName::Id new_id(m_id_from_name.size());
+            Id new_id(m_id_from_name.size());
             register_name(new_id, name);
             return new_id;
         }
@@ -22,7 +24,7 @@ namespace creek
     }
 
     /// @brief  Get a name from an ID.
-    const VarName::Name& VarNameMap::name_from_id(VarName::Id id) const
+    const VarName::Name& VarNameMap::name_from_id(Id id) const
     {
         auto iter = m_name_from_id.find(id);
         if (iter == m_name_from_id.end())
@@ -33,17 +35,18 @@ namespace creek
     }
 
     /// @brief  Get a global ID from a local ID.
-    /// If the local ID is not yet registered as global, it will be
-    /// registered.
-    VarName::Id VarNameMap::global_from_local(VarName::Id local_id) const
+    VarName::Id VarNameMap::global_from_local(Id local_id) const
     {
-        auto& name = name_from_id(local_id);
-        auto global_var_name = VarName::from_name(name);
-        return global_var_name.id();
+        auto iter = m_global_from_local.find(local_id);
+        if (iter == m_global_from_local.end())
+        {
+            throw Exception("VarName ID not found");
+        }
+        return iter->second;
     }
 
     /// @brief  Register a new var name.
-    void VarNameMap::register_name(VarName::Id id, const VarName::Name& name)
+    void VarNameMap::register_name(Id id, const VarName::Name& name)
     {
         if (m_id_from_name.emplace(name, id).second == false)
         {
@@ -53,17 +56,89 @@ namespace creek
         {
             throw Exception("Var name already exists");
         }
+        m_global_from_local.emplace(id, VarName::from_name(name).id());
     }
 
     /// @brief  Get the map.
-    const std::map<VarName::Name, VarName::Id>& VarNameMap::map() const
+    const std::map<VarName::Name, VarNameMap::Id>& VarNameMap::map() const
     {
         return m_id_from_name;
     }
 
     /// @brief  Get the map.
-    std::map<VarName::Name, VarName::Id>& VarNameMap::map()
+    std::map<VarName::Name, VarNameMap::Id>& VarNameMap::map()
     {
         return m_id_from_name;
     }
+
+
+    /// @brief  Get an ID from a string constant.
+    VarNameMap::Id VarNameMap::id_from_string(const std::string& value)
+    {
+        auto iter = m_id_from_string.find(value);
+        if (iter == m_id_from_string.end())
+        {
+            Id new_id(m_strings.size());
+            m_id_from_string.emplace(value, new_id);
+            m_strings.push_back(value);
+            return new_id;
+        }
+        else
+        {
+            return iter->second;
+        }
+    }
+
+    /// @brief  Get a string constant from an ID.
+    const std::string& VarNameMap::string_from_id(Id id) const
+    {
+        if (id >= m_strings.size())
+        {
+            throw Exception("String constant ID not found");
+        }
+        return m_strings[id];
+    }
+
+    /// @brief  Get the string constants, by ID.
+    const std::vector<std::string>& VarNameMap::strings() const
+    {
+        return m_strings;
+    }
+
+
+    /// @brief  Get an ID from a number constant.
+    VarNameMap::Id VarNameMap::id_from_number(double value)
+    {
+        uint64_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        auto iter = m_id_from_number.find(bits);
+        if (iter == m_id_from_number.end())
+        {
+            Id new_id(m_numbers.size());
+            m_id_from_number.emplace(bits, new_id);
+            m_numbers.push_back(value);
+            return new_id;
+        }
+        else
+        {
+            return iter->second;
+        }
+    }
+
+    /// @brief  Get a number constant from an ID.
+    double VarNameMap::number_from_id(Id id) const
+    {
+        if (id >= m_numbers.size())
+        {
+            throw Exception("Number constant ID not found");
+        }
+        return m_numbers[id];
+    }
+
+    /// @brief  Get the number constants, by ID.
+    const std::vector<double>& VarNameMap::numbers() const
+    {
+        return m_numbers;
+    }
 }
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cstdint>
 #include <map>
+#include <string>
+#include <vector>
 
 #include <creek/api_mode.hpp>
 #include <creek/VarName.hpp>
@@ -8,34 +11,72 @@
 
 namespace creek
 {
-    /// @brief  Dictionary of identifiers for a bytecode file.
+    /// @brief  Dictionary of identifiers and constants for a bytecode file.
+    /// Var names, strings and numbers are stored once in the dictionary;
+    /// the bytecode refers to them by ID.
     class CREEK_API VarNameMap
     {
     public:
+        /// @brief  ID of a var name or constant in the bytecode.
+        /// IDs of each kind are consecutive, starting at 0.
+        using Id = uint32_t;
+
+
         /// @brief  Get an ID from a name.
         /// The name is registered if it was not.
-        VarName::Id id_from_name(const VarName::Name& name);
+        Id id_from_name(const VarName::Name& name);
 
         /// @brief  Get a name from an ID.
         /// An exception is thrown if the ID was not registered.
-        const VarName::Name& name_from_id(VarName::Id id) const;
+        const VarName::Name& name_from_id(Id id) const;
 
         /// @brief  Get a global ID from a local ID.
-        /// If the local ID is not yet registered as global, it will be
-        /// registered.
-        VarName::Id global_from_local(VarName::Id local_id) const;
+        /// An exception is thrown if the ID was not registered.
+        VarName::Id global_from_local(Id local_id) const;
 
         /// @brief  Register a new var name.
-        void register_name(VarName::Id id, const VarName::Name& name);
+        /// The name is also interned as a global `VarName`.
+        void register_name(Id id, const VarName::Name& name);
 
         /// @brief  Get the map.
-        const std::map<VarName::Name, VarName::Id>& map() const;
+        const std::map<VarName::Name, Id>& map() const;
 
         /// @brief  Get the map.
-        std::map<VarName::Name, VarName::Id>& map();
+        std::map<VarName::Name, Id>& map();
+
+
+        /// @brief  Get an ID from a string constant.
+        /// The string is registered if it was not.
+        Id id_from_string(const std::string& value);
+
+        /// @brief  Get a string constant from an ID.
+        /// An exception is thrown if the ID was not registered.
+        const std::string& string_from_id(Id id) const;
+
+        /// @brief  Get the string constants, by ID.
+        const std::vector<std::string>& strings() const;
+
+
+        /// @brief  Get an ID from a number constant.
+        /// The number is registered if it was not. Numbers are compared
+        /// bitwise, so `0` and `-0` get different IDs.
+        Id id_from_number(double value);
+
+        /// @brief  Get a number constant from an ID.
+        /// An exception is thrown if the ID was not registered.
+        double number_from_id(Id id) const;
+
+        /// @brief  Get the number constants, by ID.
+        const std::vector<double>& numbers() const;
+
 
     private:
-        std::map<VarName::Name, VarName::Id> m_id_from_name;
-        std::map<VarName::Id, VarName::Name> m_name_from_id;
+        std::map<VarName::Name, Id> m_id_from_name;
+        std::map<Id, VarName::Name> m_name_from_id;
+        std::map<Id, VarName::Id> m_global_from_local;  ///< Interned when registered.
+        std::map<std::string, Id> m_id_from_string;
+        std::vector<std::string> m_strings;
+        std::map<uint64_t, Id> m_id_from_number;   ///< Indexed by the bits of the number.
+        std::vector<double> m_numbers;
     };
 }
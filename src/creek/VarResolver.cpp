@@ -0,0 +1,287 @@
+#include <creek/VarResolver.hpp>
+
+#include <creek/Expression.hpp>
+#include <creek/Scope.hpp>
+
+
+namespace creek
+{
+    /// @brief  `VarResolver` constructor.
+    VarResolver::VarResolver()
+    {
+
+    }
+
+    /// @brief  Resolve the local variables of a program.
+    /// @param  program     Program; its root is evaluated in its own scope.
+    void VarResolver::resolve(Expression* program)
+    {
+        m_functions.clear();
+        begin_function();
+        program->resolve(*this);
+        end_function();
+    }
+
+    /// @brief  Resolve the local variables of a program whose root scope is
+    /// shared with other programs.
+    /// @param  program     Program; its root is evaluated in the shared scope.
+    void VarResolver::resolve_shared(Expression* program)
+    {
+        m_functions.clear();
+        begin_function();
+        m_functions.back().is_shared = true;
+        program->resolve(*this);
+        end_function();
+    }
+
+    /// @brief  Enter a function body evaluated in the current scope.
+    void VarResolver::begin_function()
+    {
+        m_functions.emplace_back();
+        m_functions.back().vars = nullptr;
+        m_functions.back().is_shared = false;
+        begin_scope();
+    }
+
+    /// @brief  Enter the body of a closure.
+    /// @param  vars    Variables of the function.
+    void VarResolver::begin_function(FunctionVars& vars)
+    {
+        vars = FunctionVars();
+        begin_function();
+        m_functions.back().vars = &vars;
+    }
+
+    /// @brief  Leave a function body.
+    unsigned VarResolver::end_function()
+    {
+        resolve_pending();
+
+        auto& function = m_functions.back();
+        auto& vars = function.scopes.front();
+        unsigned slot_count = vars.size();
+        FunctionVars* function_vars = function.vars;
+
+        if (function_vars)
+        {
+            function_vars->slot_count = slot_count;
+            for (auto& declaration : vars)
+            {
+                function_vars->captured_slots.push_back(declaration.captured);
+            }
+
+            // not declared in the function: captured by it too
+            for (auto& pending : function.pending)
+            {
+                auto& capture = pending.vars->captures[pending.capture];
+                capture.depth = pending.site;
+                capture.slot = capture_slot(*function_vars, capture.var_name);
+            }
+        }
+
+        m_functions.pop_back();
+
+        // find the captures where the closure is created
+        if (function_vars && !m_functions.empty())
+        {
+            for (size_t i = 0; i < function_vars->captures.size(); ++i)
+            {
+                resolve_capture(*function_vars, i);
+            }
+        }
+
+        return slot_count;
+    }
+
+    /// @brief  Enter a new scope.
+    void VarResolver::begin_scope()
+    {
+        m_functions.back().scopes.emplace_back();
+    }
+
+    /// @brief  Leave the current scope.
+    void VarResolver::end_scope()
+    {
+        resolve_pending();
+        m_functions.back().scopes.pop_back();
+    }
+
+    /// @brief  Declare a variable in the current scope.
+    /// @param  var_name    Variable name.
+    unsigned VarResolver::declare(VarName var_name)
+    {
+        return declare(var_name, nullptr);
+    }
+
+    /// @brief  Declare a variable in the current scope.
+    /// @param  var_name    Variable name.
+    /// @param  is_captured Set to `true` if a closure captures the variable.
+    unsigned VarResolver::declare(VarName var_name, bool& is_captured)
+    {
+        is_captured = false;
+        return declare(var_name, &is_captured);
+    }
+
+    /// @brief  Find a variable of the current function.
+    /// @param  var_name    Variable name.
+    /// @param  depth       Number of scopes to go up.
+    /// @param  slot        Slot of the variable.
+    void VarResolver::find(VarName var_name, unsigned& depth, unsigned& slot) const
+    {
+        auto& function = m_functions.back();
+        auto& scopes = function.scopes;
+        for (size_t i = scopes.size(); i > 0; --i)
+        {
+            auto& vars = scopes[i - 1];
+            for (size_t j = vars.size(); j > 0; --j)
+            {
+                if (vars[j - 1].var_name == var_name)
+                {
+                    depth = scopes.size() - i;
+                    slot = j - 1;
+                    return;
+                }
+            }
+        }
+
+        // closures find the others in their environment
+        if (function.vars)
+        {
+            depth = scopes.size();
+            slot = capture_slot(*function.vars, var_name);
+            return;
+        }
+
+        depth = 0;
+        slot = Scope::no_slot;
+    }
+
+
+    /// @brief  Declare a variable in the current scope.
+    /// @param  var_name    Variable name.
+    /// @param  is_captured Flag of the declaring expression, or `nullptr`.
+    unsigned VarResolver::declare(VarName var_name, bool* is_captured)
+    {
+        auto& function = m_functions.back();
+        if (function.is_shared && function.scopes.size() == 1)
+        {
+            return Scope::no_slot;
+        }
+
+        // declared twice: the later declaration takes the flag
+        auto& vars = function.scopes.back();
+        for (size_t i = 0; i < vars.size(); ++i)
+        {
+            if (vars[i].var_name == var_name)
+            {
+                vars[i].is_captured = is_captured;
+                if (is_captured)
+                {
+                    *is_captured = vars[i].captured;
+                }
+                return i;
+            }
+        }
+
+        vars.push_back(Declaration{var_name, is_captured, false});
+        return vars.size() - 1;
+    }
+
+
+    /// @brief  Resolve the captures waiting for the current scope.
+    void VarResolver::resolve_pending()
+    {
+        auto& function = m_functions.back();
+        auto& vars = function.scopes.back();
+        size_t level = function.scopes.size() - 1;
+
+        size_t kept = 0;
+        for (auto& pending : function.pending)
+        {
+            auto& capture = pending.vars->captures[pending.capture];
+            size_t j = vars.size();
+            while (j > 0 && vars[j - 1].var_name != capture.var_name)
+            {
+                --j;
+            }
+
+            if (j > 0)
+            {
+                capture.depth = pending.site - 1 - level;
+                capture.slot = j - 1;
+                VarResolver::capture(vars[j - 1]);
+            }
+            else
+            {
+                function.pending[kept++] = pending;
+            }
+        }
+        function.pending.resize(kept);
+    }
+
+    /// @brief  Find a capture of a closure where it is created.
+    /// @param  vars    Variables of the closure.
+    /// @param  capture Index in `vars.captures`.
+    void VarResolver::resolve_capture(FunctionVars& vars, size_t capture)
+    {
+        auto& function = m_functions.back();
+        auto& scopes = function.scopes;
+        VarName var_name = vars.captures[capture].var_name;
+
+        for (size_t i = scopes.size(); i > 0; --i)
+        {
+            auto& scope_vars = scopes[i - 1];
+            for (size_t j = scope_vars.size(); j > 0; --j)
+            {
+                if (scope_vars[j - 1].var_name == var_name)
+                {
+                    vars.captures[capture].depth = scopes.size() - i;
+                    vars.captures[capture].slot = j - 1;
+                    VarResolver::capture(scope_vars[j - 1]);
+                    return;
+                }
+            }
+        }
+
+        // already captured from further out
+        if (function.vars)
+        {
+            for (size_t i = 0; i < function.vars->captures.size(); ++i)
+            {
+                if (function.vars->captures[i].var_name == var_name)
+                {
+                    vars.captures[capture].depth = scopes.size();
+                    vars.captures[capture].slot = i;
+                    return;
+                }
+            }
+        }
+
+        // may be declared later, before the closure is called
+        function.pending.push_back(Pending{&vars, capture, scopes.size()});
+    }
+
+    /// @brief  Mark a declaration as captured.
+    void VarResolver::capture(Declaration& declaration)
+    {
+        declaration.captured = true;
+        if (declaration.is_captured)
+        {
+            *declaration.is_captured = true;
+        }
+    }
+
+    /// @brief  Find the slot of a closure capture, adding it if needed.
+    unsigned VarResolver::capture_slot(FunctionVars& vars, VarName var_name)
+    {
+        for (size_t i = 0; i < vars.captures.size(); ++i)
+        {
+            if (vars.captures[i].var_name == var_name)
+            {
+                return i;
+            }
+        }
+        vars.captures.push_back(FunctionVars::Capture{var_name, 0, Scope::no_slot});
+        return vars.captures.size() - 1;
+    }
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <vector>
+
+#include <creek/api_mode.hpp>
+#include <creek/VarName.hpp>
+
+
+namespace creek
+{
+    class Expression;
+
+
+    /// @brief  Variables of a function body, found by `VarResolver`.
+    struct CREEK_API FunctionVars
+    {
+        /// @brief  Variable captured from the scope where the function is
+        /// created.
+        struct Capture
+        {
+            VarName var_name;   ///< Variable name.
+            unsigned depth;     ///< Number of scopes to go up from there.
+            unsigned slot;      ///< Slot there; `Scope::no_slot` if not found.
+        };
+
+        unsigned slot_count = 0;            ///< Slots of the function scope.
+        std::vector<bool> captured_slots;   ///< Is each slot of the function scope captured?
+        std::vector<Capture> captures;      ///< Captured variables, by slot of the closure environment.
+    };
+
+
+    /// @brief  Resolver of local variables.
+    /// Gives each local variable a depth (number of scopes to go up from the
+    /// current one) and a slot (index of the variable in that scope).
+    /// Variables of enclosing functions are captured: they are resolved to
+    /// the environment of the closure, one scope above the function scope,
+    /// and their declarations are marked as captured. The others are looked
+    /// up by name when evaluated.
+    class CREEK_API VarResolver
+    {
+    public:
+        /// @brief  `VarResolver` constructor.
+        VarResolver();
+
+
+        /// @brief  Resolve the local variables of a program.
+        /// @param  program     Program; its root is evaluated in its own scope.
+        void resolve(Expression* program);
+
+        /// @brief  Resolve the local variables of a program whose root
+        /// scope is shared with the programs run after it, like the lines of
+        /// an interactive session.
+        /// The variables declared in the root scope are stored by name, so
+        /// the next programs can find them.
+        /// @param  program     Program; its root is evaluated in the shared scope.
+        void resolve_shared(Expression* program);
+
+
+        /// @brief  Enter a function body evaluated in the current scope.
+        /// The function scope is the current scope.
+        void begin_function();
+
+        /// @brief  Enter the body of a closure.
+        /// The function scope is the current scope.
+        /// @param  vars    Variables of the function; must remain valid
+        ///                 until the program is resolved.
+        void begin_function(FunctionVars& vars);
+
+        /// @brief  Leave a function body.
+        /// @return Number of slots of the function scope.
+        unsigned end_function();
+
+        /// @brief  Enter a new scope.
+        void begin_scope();
+
+        /// @brief  Leave the current scope.
+        void end_scope();
+
+
+        /// @brief  Declare a variable in the current scope.
+        /// A name declared twice in a scope gets the same slot, so the
+        /// second declaration fails when evaluated.
+        /// @param  var_name    Variable name.
+        /// @return Slot of the variable; `Scope::no_slot` in a shared root
+        ///         scope.
+        unsigned declare(VarName var_name);
+
+        /// @brief  Declare a variable in the current scope.
+        /// @param  var_name    Variable name.
+        /// @param  is_captured Set to `true` if a closure captures the
+        ///                     variable; must remain valid until the program
+        ///                     is resolved.
+        /// @return Slot of the variable; `Scope::no_slot` in a shared root
+        ///         scope.
+        unsigned declare(VarName var_name, bool& is_captured);
+
+        /// @brief  Find a variable of the current function.
+        /// @param  var_name    Variable name.
+        /// @param  depth       Number of scopes to go up.
+        /// @param  slot        Slot of the variable; `Scope::no_slot` if not found.
+        void find(VarName var_name, unsigned& depth, unsigned& slot) const;
+
+
+    private:
+        /// @brief  Declared variable.
+        struct Declaration
+        {
+            VarName var_name;               ///< Variable name.
+            bool* is_captured;              ///< Flag of the declaring expression.
+            bool captured;                  ///< Is the variable captured?
+        };
+
+        /// @brief  Capture of a closure not declared yet where the closure
+        /// is created; it may be declared later in an open scope.
+        struct Pending
+        {
+            FunctionVars* vars;             ///< Variables of the closure.
+            size_t capture;                 ///< Index in `vars->captures`.
+            size_t site;                    ///< Number of scopes where the closure is created.
+        };
+
+        using ScopeVars = std::vector<Declaration>;
+
+        struct FunctionScopes
+        {
+            std::vector<ScopeVars> scopes;
+            FunctionVars* vars;             ///< Variables of a closure, or `nullptr`.
+            std::vector<Pending> pending;
+            bool is_shared;                 ///< Is the root scope shared with other programs?
+        };
+
+        /// @brief  Declare a variable in the current scope.
+        /// @param  is_captured Flag of the declaring expression, or `nullptr`.
+        unsigned declare(VarName var_name, bool* is_captured);
+
+        /// @brief  Resolve the captures waiting for the current scope.
+        void resolve_pending();
+
+        /// @brief  Find a capture of a closure where it is created.
+        /// @param  vars    Variables of the closure.
+        /// @param  capture Index in `vars.captures`.
+        void resolve_capture(FunctionVars& vars, size_t capture);
+
+        /// @brief  Mark a declaration as captured.
+        static void capture(Declaration& declaration);
+
+        /// @brief  Find the slot of a closure capture, adding it if needed.
+        static unsigned capture_slot(FunctionVars& vars, VarName var_name);
+
+        std::vector<FunctionScopes> m_functions;
+    };
+}
@@ -1,13 +1,59 @@
 #include <creek/Variable.hpp>
 
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#include <creek/Boolean.hpp>
 #include <creek/Data.hpp>
+#include <creek/Null.hpp>
+#include <creek/Number.hpp>
+#include <creek/String.hpp>
 #include <creek/utility.hpp>
+#include <creek/Vector.hpp>
+#include <creek/Void.hpp>
 
 
 namespace creek
 {
+    namespace
+    {
+        // Any double with these bits set is a boxed value; real NaNs are
+        // stored as `canonical_nan`, which doesn't have them all.
+        const uint64_t boxed_bits = 0x7ffc000000000000;
+        const uint64_t pointer_bits = 0xfffc000000000000;
+        const uint64_t canonical_nan = 0x7ff8000000000000;
+
+        const uint64_t null_bits = boxed_bits | 1;
+        const uint64_t void_bits = boxed_bits | 2;
+        const uint64_t false_bits = boxed_bits | 3;
+        const uint64_t true_bits = boxed_bits | 4;
+
+        const uint64_t empty_bits = pointer_bits;
+
+        static_assert(sizeof(double) == sizeof(uint64_t), "double must be 64 bits");
+        static_assert(sizeof(Data*) <= sizeof(uint64_t), "pointers must fit in 64 bits");
+
+        uint64_t box_pointer(Data* data)
+        {
+            return pointer_bits | uint64_t(uintptr_t(data));
+        }
+
+        uint64_t box_number(double value)
+        {
+            if (value != value)
+            {
+                return canonical_nan;
+            }
+            uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return bits;
+        }
+    }
+
+
     // `Variable` constructor.
-    Variable::Variable() : m_data(nullptr)
+    Variable::Variable() : m_bits(empty_bits)
     {
 
     }
@@ -15,39 +61,48 @@ namespace creek
     // `Variable` destructor.
     Variable::~Variable()
     {
-
+        unref();
     }
 
     // `Variable` constructor.
     // @param  data        Initial data.
-    Variable::Variable(Data* data) : m_data(data)
+    Variable::Variable(Data* data) : m_bits(box_pointer(data))
     {
 
     }
 
     // `Variable` copy constructor.
-    Variable::Variable(const Variable& other) : m_data(other->copy())
+    Variable::Variable(const Variable& other) : m_bits(other.m_bits)
     {
-
+        if (is_pointer() && pointer())
+        {
+            pointer()->m_ref_count += 1;
+        }
     }
 
     // `Variable` move constructor.
-    Variable::Variable(Variable&& other) : m_data(other.release())
+    Variable::Variable(Variable&& other) : m_bits(other.m_bits)
     {
-
+        other.m_bits = empty_bits;
     }
 
     // `Variable` copy operator.
     Variable& Variable::operator = (const Variable& other)
     {
-        data(other->copy());
+        Variable copy(other);
+        swap(copy);
         return *this;
     }
 
     // `Variable` move operator.
     Variable& Variable::operator = (Variable&& other)
     {
-        data(other.release());
+        if (this != &other)
+        {
+            unref();
+            m_bits = other.m_bits;
+            other.m_bits = empty_bits;
+        }
         return *this;
     }
 
@@ -58,35 +113,227 @@ namespace creek
 //    }
 
     // Get the stored data.
+    // Immediate values are allocated here.
     Data* Variable::data() const
     {
-        return m_data.get();
+        if (!is_pointer())
+        {
+            m_bits = box_pointer(new_data());
+        }
+        return pointer();
     }
 
     // Set the stored data.
     void Variable::data(Data* new_data)
     {
-        m_data.reset(new_data);
+        Variable old_data(new_data);
+        swap(old_data);
     }
 
     // Set the stored data.
     void Variable::reset(Data* new_data)
     {
-        m_data.reset(new_data);
+        data(new_data);
     }
 
     // Get the stored data and release ownership.
+    // If the data is shared with other variables, a copy is returned.
     Data* Variable::release()
     {
-        return m_data.release();
+        if (!is_pointer())
+        {
+            Data* released = new_data();
+            m_bits = empty_bits;
+            return released;
+        }
+        detach();
+        Data* released = pointer();
+        m_bits = empty_bits;
+        return released;
     }
 
     // Swap data with other variable.
     void Variable::swap(Variable& other)
     {
-        m_data.swap(other.m_data);
+        std::swap(m_bits, other.m_bits);
+    }
+
+    // Make the stored data not shared with other variables.
+    void Variable::detach()
+    {
+        if (is_pointer() && pointer() && pointer()->m_ref_count > 1)
+        {
+            Data* own_data = pointer()->copy();
+            pointer()->m_ref_count -= 1;
+            m_bits = box_pointer(own_data);
+        }
+    }
+
+    // Drop a reference to the stored data, deleting it if it was the last
+    // one.
+    void Variable::unref()
+    {
+        if (is_pointer() && pointer() && --pointer()->m_ref_count == 0)
+        {
+            delete pointer();
+        }
+    }
+
+    // Check if holding a `Data` pointer (or nothing).
+    bool Variable::is_pointer() const
+    {
+        return (m_bits & pointer_bits) == pointer_bits;
+    }
+
+    // Get the `Data` pointer.
+    Data* Variable::pointer() const
+    {
+        return reinterpret_cast<Data*>(uintptr_t(m_bits & ~pointer_bits));
+    }
+
+    // Create a new `Data` from the immediate value.
+    Data* Variable::new_data() const
+    {
+        switch (m_bits)
+        {
+            case null_bits:     return new Null();
+            case void_bits:     return new Void();
+            case false_bits:    return new Boolean(false);
+            case true_bits:     return new Boolean(true);
+            default:            return new Number(number());
+        }
+    }
+
+
+    // @name   Immediate values
+    // @{
+    // Create a variable holding an immediate number.
+    Variable Variable::make_number(double value)
+    {
+        Variable var;
+        var.m_bits = box_number(value);
+        return var;
+    }
+
+    // Create a variable holding an immediate boolean.
+    Variable Variable::make_boolean(bool value)
+    {
+        Variable var;
+        var.m_bits = value ? true_bits : false_bits;
+        return var;
+    }
+
+    // Create a variable holding an immediate null.
+    Variable Variable::make_null()
+    {
+        Variable var;
+        var.m_bits = null_bits;
+        return var;
+    }
+
+    // Create a variable holding an immediate void.
+    Variable Variable::make_void()
+    {
+        Variable var;
+        var.m_bits = void_bits;
+        return var;
+    }
+
+    // Store the data inline if it is a number, boolean, null or void not
+    // shared with other variables.
+    void Variable::unbox()
+    {
+        if (!is_pointer() || !pointer() || pointer()->m_ref_count != 1)
+        {
+            return;
+        }
+
+        Data* data = pointer();
+        switch (data->type())
+        {
+            case DataType::number:      *this = make_number(static_cast<Number*>(data)->value()); break;
+            case DataType::boolean:     *this = make_boolean(data->bool_value()); break;
+            case DataType::null:        *this = make_null(); break;
+            case DataType::void_data:   *this = make_void(); break;
+            default:                    break;
+        }
+    }
+
+    // Get the number stored, immediate or in a `Number`.
+    bool Variable::get_number(double& value) const
+    {
+        if (is_number())
+        {
+            value = number();
+            return true;
+        }
+        else if (is_pointer() && pointer() && pointer()->type() == DataType::number)
+        {
+            value = static_cast<Number*>(pointer())->value();
+            return true;
+        }
+        return false;
+    }
+
+    // Get the value of the `String` stored.
+    const std::string* Variable::get_string() const
+    {
+        if (is_pointer() && pointer() && pointer()->type() == DataType::string)
+        {
+            return &static_cast<String*>(pointer())->value();
+        }
+        return nullptr;
+    }
+
+    // Get the `Vector` stored.
+    Vector* Variable::get_vector() const
+    {
+        if (is_pointer() && pointer() && pointer()->type() == DataType::vector)
+        {
+            return static_cast<Vector*>(pointer());
+        }
+        return nullptr;
+    }
+
+    // Check if holding an immediate number.
+    bool Variable::is_number() const
+    {
+        return (m_bits & boxed_bits) != boxed_bits;
+    }
+
+    // Get the immediate number.
+    double Variable::number() const
+    {
+        double value;
+        std::memcpy(&value, &m_bits, sizeof(value));
+        return value;
+    }
+
+    // Get the bool value of the data.
+    bool Variable::bool_value() const
+    {
+        switch (m_bits)
+        {
+            case true_bits:     return true;
+            case false_bits:    return false;
+            default:            return is_number() ? number() > 0 : data()->bool_value();
+        }
+    }
+
+    // Get the int value of the data.
+    int Variable::int_value() const
+    {
+        return is_number() ? int(number()) : data()->int_value();
     }
 
+    // Get the double value of the data.
+    double Variable::double_value() const
+    {
+        return is_number() ? number() : data()->double_value();
+    }
+    // @}
+
+
     // Get the soterd data (const).
     // Same as `data()`.
     Data* Variable::operator * () const
@@ -117,7 +364,7 @@ namespace creek
 
     Variable::operator bool () const
     {
-        return data();// && data()->bool_value();
+        return m_bits != empty_bits;// && data()->bool_value();
     }
 
 
@@ -126,9 +373,21 @@ namespace creek
     // Get the data at index.
     Variable Variable::index(Variable key)
     {
+        double pos;
+        Vector* vector = get_vector();
+        if (vector && key.get_number(pos))
+        {
+            // same as `Vector::index`
+            auto& items = vector->vector_value();
+            int i = pos;
+            if (i < 0) i = items.size() + i;
+            return items[i];
+        }
         assert(data());
         assert(key.data());
-        return Variable(data()->index(key.data()));
+        Variable result(data()->index(key.data()));
+        result.unbox();
+        return result;
     }
 
     // Set the data at index.
@@ -137,6 +396,18 @@ namespace creek
         assert(data());
         assert(key.data());
         assert(new_data.data());
+        double pos;
+        Vector* vector = get_vector();
+        if (vector && key.get_number(pos))
+        {
+            // same as `Vector::index`
+            auto& items = vector->vector_value();
+            int i = pos;
+            if (i < 0) i = items.size() + i;
+            items[i] = new_data;
+            return new_data;
+        }
+        detach();
         return Variable(data()->index(key.data(), new_data.release()));
     }
     // @}
@@ -149,7 +420,9 @@ namespace creek
     Variable Variable::attr(VarName key)
     {
         assert(data());
-        return Variable(data()->attr(key));
+        Variable result(data()->attr(key));
+        result.unbox();
+        return result;
     }
 
     /// @brief  Set the attribute.
@@ -159,6 +432,7 @@ namespace creek
     {
         assert(data());
         assert(new_data.data());
+        detach();
         return Variable(data()->attr(key, new_data.release()));
     }
     /// @}
@@ -169,6 +443,18 @@ namespace creek
     // Addition.
     Variable Variable::add(Variable& other)
     {
+        double l, r;
+        if (get_number(l) && other.get_number(r))
+        {
+            return make_number(l + r);
+        }
+        if (auto l_string = get_string())
+        {
+            if (auto r_string = other.get_string())
+            {
+                return Variable(new String(*l_string + *r_string));
+            }
+        }
         assert(data());
         assert(other.data());
         return Variable(data()->add(other.data()));
@@ -177,6 +463,11 @@ namespace creek
     // Subtraction.
     Variable Variable::sub(Variable& other)
     {
+        double l, r;
+        if (get_number(l) && other.get_number(r))
+        {
+            return make_number(l - r);
+        }
         assert(data());
         assert(other.data());
         return Variable(data()->sub(other.data()));
@@ -185,6 +476,11 @@ namespace creek
     // Multiplication.
     Variable Variable::mul(Variable& other)
     {
+        double l, r;
+        if (get_number(l) && other.get_number(r))
+        {
+            return make_number(l * r);
+        }
         assert(data());
         assert(other.data());
         return Variable(data()->mul(other.data()));
@@ -193,6 +489,11 @@ namespace creek
     // Divison.
     Variable Variable::div(Variable& other)
     {
+        double l, r;
+        if (get_number(l) && other.get_number(r))
+        {
+            return make_number(l / r);
+        }
         assert(data());
         assert(other.data());
         return Variable(data()->div(other.data()));
@@ -201,6 +502,11 @@ namespace creek
     // Modulo.
     Variable Variable::mod(Variable& other)
     {
+        double l, r;
+        if (get_number(l) && other.get_number(r))
+        {
+            return make_number(int(l) % int(r));
+        }
         assert(data());
         assert(other.data());
         return Variable(data()->mod(other.data()));
@@ -209,6 +515,11 @@ namespace creek
     // Exponentiation.
     Variable Variable::exp(Variable& other)
     {
+        double l, r;
+        if (get_number(l) && other.get_number(r))
+        {
+            return make_number(std::pow(l, r));
+        }
         assert(data());
         assert(other.data());
         return Variable(data()->exp(other.data()));
@@ -217,6 +528,11 @@ namespace creek
     // Unary minus.
     Variable Variable::unm()
     {
+        double v;
+        if (get_number(v))
+        {
+            return make_number(-v);
+        }
         assert(data());
         return Variable(data()->unm());
     }
@@ -228,6 +544,11 @@ namespace creek
     // Bitwise and.
     Variable Variable::bit_and(Variable& other)
     {
+        double l, r;
+        if (get_number(l) && other.get_number(r))
+        {
+            return make_number(int(l) & int(r));
+        }
         assert(data());
         assert(other.data());
         return Variable(data()->bit_and(other.data()));
@@ -236,6 +557,11 @@ namespace creek
     // Bitwise or.
     Variable Variable::bit_or(Variable& other)
     {
+        double l, r;
+        if (get_number(l) && other.get_number(r))
+        {
+            return make_number(int(l) | int(r));
+        }
         assert(data());
         assert(other.data());
         return Variable(data()->bit_or(other.data()));
@@ -244,6 +570,11 @@ namespace creek
     // Bitwise xor.
     Variable Variable::bit_xor(Variable& other)
     {
+        double l, r;
+        if (get_number(l) && other.get_number(r))
+        {
+            return make_number(int(l) ^ int(r));
+        }
         assert(data());
         assert(other.data());
         return Variable(data()->bit_xor(other.data()));
@@ -252,6 +583,11 @@ namespace creek
     // Bitwise not.
     Variable Variable::bit_not()
     {
+        double v;
+        if (get_number(v))
+        {
+            return make_number(~int(v));
+        }
         assert(data());
         return Variable(data()->bit_not());
     }
@@ -259,6 +595,11 @@ namespace creek
     // Bitwise left shift.
     Variable Variable::bit_left_shift(Variable& other)
     {
+        double l, r;
+        if (get_number(l) && other.get_number(r))
+        {
+            return make_number(int(l) << int(r));
+        }
         assert(data());
         assert(other.data());
         return Variable(data()->bit_left_shift(other.data()));
@@ -267,6 +608,11 @@ namespace creek
     // Bitwise right shift.
     Variable Variable::bit_right_shift(Variable& other)
     {
+        double l, r;
+        if (get_number(l) && other.get_number(r))
+        {
+            return make_number(int(l) >> int(r));
+        }
         assert(data());
         assert(other.data());
         return Variable(data()->bit_right_shift(other.data()));
@@ -282,10 +628,36 @@ namespace creek
     // @return -1 if less-than, 0 if equal, +1 if greater-than.
     int Variable::cmp(const Variable& other) const
     {
+        double l, r;
+        if (get_number(l) && other.get_number(r))
+        {
+            // same precision as `Number::cmp`
+            float this_float = l;
+            float other_float = r;
+            return this_float < other_float ? -1 : this_float > other_float ? 1 : 0;
+        }
+        if (auto l_string = get_string())
+        {
+            if (auto r_string = other.get_string())
+            {
+                return l_string->compare(*r_string);
+            }
+        }
         assert(data());
         assert(other.data());
         return data()->cmp(other.data());
     }
+
+    // Hash for hash containers.
+    size_t Variable::hash() const
+    {
+        if (is_number())
+        {
+            return Number::hash(number());
+        }
+        assert(data());
+        return data()->hash();
+    }
     // @}
 
 
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <string>
 
 #include <creek/api_mode.hpp>
 #include <creek/Data.hpp>
@@ -8,9 +10,17 @@
 
 namespace creek
 {
+    class Vector;
+
+
     /// Stores a data of any type.
     /// Has shortcuts to operate with stored data.
     /// Overloads operator for operations.
+    /// Copies of a variable share the same data, which is reference counted;
+    /// the data is copied before being modified while shared.
+    /// Numbers, booleans, null and void can be stored inline as immediate
+    /// values (NaN-boxed), without allocating a `Data`; one is allocated only
+    /// when the data is accessed.
     class CREEK_API Variable
     {
     public:
@@ -51,6 +61,7 @@ namespace creek
         void reset(Data* new_data);
 
         /// Get the stored data and release ownership.
+        /// If the data is shared with other variables, a copy is returned.
         Data* release();
 
         /// Swap data with other variable.
@@ -75,6 +86,45 @@ namespace creek
         /// @}
 
 
+        /// @name   Immediate values
+        /// @{
+        /// Create a variable holding an immediate number.
+        static Variable make_number(double value);
+
+        /// Create a variable holding an immediate boolean.
+        static Variable make_boolean(bool value);
+
+        /// Create a variable holding an immediate null.
+        static Variable make_null();
+
+        /// Create a variable holding an immediate void.
+        static Variable make_void();
+
+        /// Store the data inline if it is a number, boolean, null or void
+        /// not shared with other variables.
+        void unbox();
+
+        /// Check if holding an immediate number.
+        bool is_number() const;
+
+        /// Get the immediate number.
+        /// Must be checked with `is_number` first.
+        double number() const;
+
+        /// Get the bool value of the data.
+        /// Same as `data()->bool_value()`, without allocating immediates.
+        bool bool_value() const;
+
+        /// Get the int value of the data.
+        /// Same as `data()->int_value()`, without allocating immediates.
+        int int_value() const;
+
+        /// Get the double value of the data.
+        /// Same as `data()->double_value()`, without allocating immediates.
+        double double_value() const;
+        /// @}
+
+
         /// @name   Container index
         /// @{
         /// Get the data at index.
@@ -152,6 +202,10 @@ namespace creek
         /// This special operation must return an integer.
         /// @return -1 if less-than, 0 if equal, +1 if greater-than.
         int cmp(const Variable& other) const;
+
+        /// Hash for hash containers.
+        /// Same as `data()->hash()`, without allocating immediate numbers.
+        size_t hash() const;
         /// @}
 
 
@@ -178,6 +232,41 @@ namespace creek
         /// Get the stored data.
         Data* data() const;
 
-        std::unique_ptr<Data> m_data = nullptr;
+        /// Make the stored data not shared with other variables.
+        void detach();
+
+        /// Drop a reference to the stored data, deleting it if it was the
+        /// last one.
+        void unref();
+
+        /// Check if holding a `Data` pointer (or nothing).
+        bool is_pointer() const;
+
+        /// Get the `Data` pointer.
+        /// Must be checked with `is_pointer` first.
+        Data* pointer() const;
+
+        /// Create a new `Data` from the immediate value.
+        Data* new_data() const;
+
+        /// @name   Fast paths
+        /// Check the type tag to skip the virtual `Data` methods.
+        /// @{
+        /// Get the number stored, immediate or in a `Number`.
+        /// @return False if not holding a number.
+        bool get_number(double& value) const;
+
+        /// Get the value of the `String` stored.
+        /// @return Null if not holding a string.
+        const std::string* get_string() const;
+
+        /// Get the `Vector` stored.
+        /// @return Null if not holding a vector.
+        Vector* get_vector() const;
+        /// @}
+
+        /// Stored value.
+        /// Either a double, an immediate tag or a `Data` pointer.
+        mutable uint64_t m_bits;
     };
 }
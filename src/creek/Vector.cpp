@@ -4,13 +4,52 @@
 
 #include <creek/Expression_DataTypes.hpp>
 #include <creek/GlobalScope.hpp>
+#include <creek/Iterator.hpp>
 
 
 namespace creek
 {
+    namespace
+    {
+        // Iterator over the items of a vector.
+        // Items added while iterating are not visited.
+        class VectorIterator : public Iterator
+        {
+        public:
+            VectorIterator(const Vector::Value& items) :
+                m_items(items),
+                m_position(0),
+                m_end(items->size())
+            {
+
+            }
+
+            Data* copy() const override
+            {
+                return new VectorIterator(*this);
+            }
+
+            bool next(Variable& value) override
+            {
+                if (m_position >= m_end || m_position >= m_items->size())
+                {
+                    return false;
+                }
+                value = (*m_items)[m_position++];
+                return true;
+            }
+
+        private:
+            Vector::Value m_items;
+            size_t m_position;
+            size_t m_end;
+        };
+    }
+
+
     // `Vector` constructor.
     // @param  value   Vector value.
-    Vector::Vector(const Value& value) : m_value(value)
+    Vector::Vector(const Value& value) : Data(DataType::vector), m_value(value)
     {
 
     }
@@ -78,22 +117,32 @@ namespace creek
     {
         int pos = key->int_value();
         if (pos < 0) pos = vector_value().size() + pos;
-        return vector_value()[pos]->copy();
+        // copy the variable, so immediate items stay unboxed in the vector
+        return Variable(vector_value()[pos]).release();
     }
 
     Data* Vector::index(Data* key, Data* new_value)
     {
         int pos = key->int_value();
         if (pos < 0) pos = vector_value().size() + pos;
-        vector_value()[pos].data(new_value->copy());
+        Variable& item = vector_value()[pos];
+        item.data(new_value->copy());
+        item.unbox();
         return new_value;
     }
 
 
+    Data* Vector::iter()
+    {
+        return new VectorIterator(m_value);
+    }
+
+
     int Vector::cmp(Data* other)
     {
-        if (Vector* other_as_vector = dynamic_cast<Vector*>(other))
+        if (other->type() == DataType::vector)
         {
+            Vector* other_as_vector = static_cast<Vector*>(other);
             auto& this_vector = this->vector_value();
             auto& other_vector = other_as_vector->vector_value();
 
@@ -126,8 +175,18 @@ namespace creek
         }
     }
 
+    size_t Vector::hash() const
+    {
+        size_t hash = m_value->size();
+        for (auto& item : *m_value)
+        {
+            hash = hash * 31 + item.hash();
+        }
+        return hash;
+    }
+
     Data* Vector::get_class() const
     {
-        return GlobalScope::class_Vector->copy();
+        return GlobalScope::current().class_Vector->copy();
     }
 }
@@ -47,6 +47,8 @@ namespace creek
         Data* index(Data* key) override;
         Data* index(Data* key, Data* new_value) override;
 
+        Data* iter() override;
+
         // Data* add(Data* other) override;
         // Data* sub(Data* other) override;
         // Data* mul(Data* other) override;
@@ -60,6 +62,7 @@ namespace creek
         // Data* bit_not() override;
 
         int cmp(Data* other) override;
+        size_t hash() const override;
 
         Data* get_class() const override;
 
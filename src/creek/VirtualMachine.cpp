@@ -0,0 +1,935 @@
+#include <creek/VirtualMachine.hpp>
+
+#include <iostream>
+
+#include <creek/Boolean.hpp>
+#include <creek/Compiler.hpp>
+#include <creek/Exception.hpp>
+#include <creek/GlobalScope.hpp>
+#include <creek/Map.hpp>
+#include <creek/Number.hpp>
+#include <creek/Scope.hpp>
+#include <creek/VarResolver.hpp>
+#include <creek/Vector.hpp>
+
+
+// use computed goto for the dispatch loop where available
+#if defined(__GNUC__)
+#   define CREEK_VM_COMPUTED_GOTO
+#endif
+
+#ifdef CREEK_VM_COMPUTED_GOTO
+#   define CREEK_VM_LABEL(name)     &&op_##name
+#   define CREEK_VM_INVALID         &&op_invalid
+#   define CREEK_VM_BEGIN()         goto *labels[static_cast<uint8_t>(ip->op)];
+#   define CREEK_VM_END()
+#   define CREEK_VM_CASE(name)      op_##name:
+#   define CREEK_VM_DEFAULT()       op_invalid:
+#   define CREEK_VM_DISPATCH()      goto *labels[static_cast<uint8_t>(ip->op)]
+#else
+#   define CREEK_VM_BEGIN()         for (;;) { switch (ip->op) {
+#   define CREEK_VM_END()           } }
+#   define CREEK_VM_CASE(name)      case OpCode::name:
+#   define CREEK_VM_DEFAULT()       default:
+#   define CREEK_VM_DISPATCH()      continue
+#endif
+
+// binary operation with a data method
+#define CREEK_VM_BINARY(method)                             \
+    {                                                       \
+        Variable& r = m_stack.back();                       \
+        Variable& l = *(m_stack.end() - 2);                 \
+        l = l.method(r);                                    \
+        m_stack.pop_back();                                 \
+        ++ip;                                               \
+    }
+
+// comparison returning a boolean
+#define CREEK_VM_COMPARE(condition)                         \
+    {                                                       \
+        Variable& r = m_stack.back();                       \
+        Variable& l = *(m_stack.end() - 2);                 \
+        int c = l.cmp(r);                                   \
+        l = Variable::make_boolean(condition);              \
+        m_stack.pop_back();                                 \
+        ++ip;                                               \
+    }
+
+// unary operation with a data method
+#define CREEK_VM_UNARY(method)                              \
+    {                                                       \
+        Variable& v = m_stack.back();                       \
+        v = v.method();                                     \
+        ++ip;                                               \
+    }
+
+
+namespace creek
+{
+    namespace
+    {
+        // check the variable of a `for` loop against its maximum; numbers
+        // are compared natively, with the same precision as `Variable::cmp`
+        bool for_less(const Variable& i, const Variable& max)
+        {
+            if (i.is_number() && max.is_number())
+            {
+                return static_cast<float>(i.number()) < static_cast<float>(max.number());
+            }
+            return i.cmp(max) < 0;
+        }
+    }
+
+
+    /// @brief  `Program` constructor.
+    Program::Program()
+    {
+
+    }
+
+    /// @brief  Append an instruction.
+    /// @return Index of the new instruction.
+    uint32_t Program::emit(OpCode op, uint32_t a, uint32_t b, uint16_t c)
+    {
+        m_code.push_back(Instruction{op, c, a, b});
+        return m_code.size() - 1;
+    }
+
+    /// @brief  Set the first operand of an instruction.
+    void Program::patch(uint32_t index, uint32_t a)
+    {
+        m_code[index].a = a;
+    }
+
+    /// @brief  Number of instructions.
+    uint32_t Program::size() const
+    {
+        return m_code.size();
+    }
+
+    /// @brief  Get the instructions.
+    const std::vector<Instruction>& Program::code() const
+    {
+        return m_code;
+    }
+
+    /// @brief  Add a constant.
+    uint32_t Program::add_constant(Data* data)
+    {
+        m_constants.emplace_back(data);
+        m_constants.back().unbox();
+        return m_constants.size() - 1;
+    }
+
+    /// @brief  Add a variable name.
+    uint32_t Program::add_name(VarName name)
+    {
+        auto found = m_name_indexes.find(name);
+        if (found != m_name_indexes.end())
+        {
+            return found->second;
+        }
+        m_name_indexes.emplace(name, m_names.size());
+        m_names.push_back(name);
+        return m_names.size() - 1;
+    }
+
+    /// @brief  Add an attribute lookup, for one instruction.
+    uint32_t Program::add_attr_lookup(VarName name)
+    {
+        m_attr_names.push_back(name);
+        m_attr_caches.emplace_back();
+        return m_attr_caches.size() - 1;
+    }
+
+    /// @brief  Add the range of a `for` loop with constant bounds.
+    uint32_t Program::add_for_range(const ForRange& range)
+    {
+        m_for_ranges.push_back(range);
+        return m_for_ranges.size() - 1;
+    }
+
+    /// @brief  Add an expression to evaluate with `vm_eval`.
+    uint32_t Program::add_expression(Expression* expression)
+    {
+        m_expressions.emplace_back(expression);
+        return m_expressions.size() - 1;
+    }
+
+    /// @brief  Set the bytecode this program was compiled from.
+    void Program::source(const Bytecode& bytes, const std::shared_ptr<const VarNameMap>& var_name_map)
+    {
+        m_source_bytes = bytes;
+        m_source_var_name_map = var_name_map;
+    }
+
+    /// @brief  Get the source bytecode.
+    const Bytecode& Program::source_bytes() const
+    {
+        return m_source_bytes;
+    }
+
+    /// @brief  Get the var name map of the source bytecode.
+    const std::shared_ptr<const VarNameMap>& Program::source_var_name_map() const
+    {
+        return m_source_var_name_map;
+    }
+
+    /// @brief  Check if this program has a source but no instructions.
+    bool Program::is_lazy() const
+    {
+        return m_code.empty() && m_source_var_name_map;
+    }
+
+
+    /// @brief  Set the function this program is the body of.
+    void Program::function(const std::vector<VarName>& arg_names, const std::shared_ptr<FunctionVars>& vars)
+    {
+        m_arg_names = arg_names;
+        m_function_vars = vars;
+    }
+
+    /// @brief  Get the argument names of the function.
+    const std::vector<VarName>& Program::arg_names() const
+    {
+        return m_arg_names;
+    }
+
+    /// @brief  Get the variables of the function.
+    const std::shared_ptr<FunctionVars>& Program::function_vars() const
+    {
+        return m_function_vars;
+    }
+
+
+    /// @brief  `VirtualMachine` constructor.
+    VirtualMachine::VirtualMachine()
+    {
+
+    }
+
+    /// @brief  Execute a program.
+    /// @param  program     Program to execute.
+    /// @param  scope       Scope where the program is executed.
+    Variable VirtualMachine::run(const Program& program, Scope& scope)
+    {
+#ifdef CREEK_VM_COMPUTED_GOTO
+        static const void* const labels[] =
+        {
+            /* 0x00 */ CREEK_VM_LABEL(nop), CREEK_VM_LABEL(print), CREEK_VM_INVALID, CREEK_VM_INVALID,
+                       CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID,
+                       CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID,
+                       CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID,
+            /* 0x10 */ CREEK_VM_LABEL(add), CREEK_VM_LABEL(sub), CREEK_VM_LABEL(mul), CREEK_VM_LABEL(div),
+                       CREEK_VM_LABEL(mod), CREEK_VM_LABEL(exp), CREEK_VM_LABEL(unm), CREEK_VM_LABEL(bit_and),
+                       CREEK_VM_LABEL(bit_or), CREEK_VM_LABEL(bit_xor), CREEK_VM_LABEL(bit_not), CREEK_VM_LABEL(bit_left_shift),
+                       CREEK_VM_LABEL(bit_right_shift), CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_LABEL(bool_xor),
+            /* 0x20 */ CREEK_VM_LABEL(bool_not), CREEK_VM_LABEL(cmp), CREEK_VM_LABEL(eq), CREEK_VM_LABEL(ne),
+                       CREEK_VM_LABEL(lt), CREEK_VM_LABEL(le), CREEK_VM_LABEL(gt), CREEK_VM_LABEL(ge),
+                       CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID,
+                       CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID,
+            /* 0x30 */ CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID,
+                       CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_LABEL(data_vector), CREEK_VM_LABEL(data_map),
+                       CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID,
+                       CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID,
+            /* 0x40 */ CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID,
+                       CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID,
+                       CREEK_VM_INVALID, CREEK_VM_LABEL(control_throw), CREEK_VM_LABEL(control_return), CREEK_VM_LABEL(control_break),
+                       CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID,
+            /* 0x50 */ CREEK_VM_LABEL(call), CREEK_VM_LABEL(variadic_call), CREEK_VM_LABEL(call_method), CREEK_VM_LABEL(variadic_call_method),
+                       CREEK_VM_LABEL(index_get), CREEK_VM_LABEL(index_set), CREEK_VM_LABEL(attr_get), CREEK_VM_LABEL(attr_set),
+                       CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID,
+                       CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID,
+            /* 0x60 */ CREEK_VM_LABEL(var_create_local), CREEK_VM_LABEL(var_load_local), CREEK_VM_LABEL(var_store_local), CREEK_VM_LABEL(var_create_global),
+                       CREEK_VM_LABEL(var_load_global), CREEK_VM_LABEL(var_store_global), CREEK_VM_INVALID, CREEK_VM_INVALID,
+                       CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID,
+                       CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID,
+            /* 0x70 */ CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID,
+                       CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID,
+                       CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID,
+                       CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID,
+            /* 0x80 */ CREEK_VM_LABEL(vm_pop), CREEK_VM_LABEL(vm_drop), CREEK_VM_LABEL(vm_const), CREEK_VM_LABEL(vm_eval),
+                       CREEK_VM_LABEL(vm_jump), CREEK_VM_LABEL(vm_jump_if_false), CREEK_VM_LABEL(vm_jump_if_false_keep), CREEK_VM_LABEL(vm_jump_if_true_keep),
+                       CREEK_VM_LABEL(vm_jump_if_case), CREEK_VM_LABEL(vm_push_scope), CREEK_VM_LABEL(vm_pop_scope), CREEK_VM_LABEL(vm_loop_begin),
+                       CREEK_VM_LABEL(vm_loop_set), CREEK_VM_LABEL(vm_loop_end), CREEK_VM_LABEL(vm_for_in_begin), CREEK_VM_LABEL(vm_for_in_next),
+            /* 0x90 */ CREEK_VM_LABEL(vm_try_begin), CREEK_VM_LABEL(vm_try_end), CREEK_VM_LABEL(vm_clear_scope), CREEK_VM_LABEL(vm_for_check),
+                       CREEK_VM_LABEL(vm_for_step), CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID,
+                       CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID,
+                       CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID, CREEK_VM_INVALID,
+        };
+#endif
+
+        // restore the stacks when leaving, even on exceptions
+        struct Restore
+        {
+            VirtualMachine& vm;
+            size_t stack_size;
+            size_t scope_count;
+            size_t block_count;
+
+            ~Restore()
+            {
+                while (vm.m_scopes.size() > scope_count)
+                {
+                    vm.m_scopes.pop_back();
+                }
+                vm.m_stack.resize(stack_size);
+                vm.m_blocks.resize(block_count);
+            }
+        } restore { *this, m_stack.size(), m_scopes.size(), m_blocks.size() };
+
+        const size_t scope_base = restore.scope_count;
+        const size_t block_base = restore.block_count;
+
+        const Instruction* const code = program.m_code.data();
+        const Instruction* ip = code;
+        Scope* current = &scope;
+
+        for (;;)
+        {
+            try
+            {
+                CREEK_VM_BEGIN()
+
+                // debug
+                CREEK_VM_CASE(nop)
+                {
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(print)
+                {
+                    std::cout << m_stack.back()->debug_text() << std::endl;
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+
+                // arithmetic
+                CREEK_VM_CASE(add)              CREEK_VM_BINARY(add)                CREEK_VM_DISPATCH();
+                CREEK_VM_CASE(sub)              CREEK_VM_BINARY(sub)                CREEK_VM_DISPATCH();
+                CREEK_VM_CASE(mul)              CREEK_VM_BINARY(mul)                CREEK_VM_DISPATCH();
+                CREEK_VM_CASE(div)              CREEK_VM_BINARY(div)                CREEK_VM_DISPATCH();
+                CREEK_VM_CASE(mod)              CREEK_VM_BINARY(mod)                CREEK_VM_DISPATCH();
+                CREEK_VM_CASE(exp)              CREEK_VM_BINARY(exp)                CREEK_VM_DISPATCH();
+                CREEK_VM_CASE(unm)              CREEK_VM_UNARY(unm)                 CREEK_VM_DISPATCH();
+
+
+                // bitwise
+                CREEK_VM_CASE(bit_and)          CREEK_VM_BINARY(bit_and)            CREEK_VM_DISPATCH();
+                CREEK_VM_CASE(bit_or)           CREEK_VM_BINARY(bit_or)             CREEK_VM_DISPATCH();
+                CREEK_VM_CASE(bit_xor)          CREEK_VM_BINARY(bit_xor)            CREEK_VM_DISPATCH();
+                CREEK_VM_CASE(bit_not)          CREEK_VM_UNARY(bit_not)             CREEK_VM_DISPATCH();
+                CREEK_VM_CASE(bit_left_shift)   CREEK_VM_BINARY(bit_left_shift)     CREEK_VM_DISPATCH();
+                CREEK_VM_CASE(bit_right_shift)  CREEK_VM_BINARY(bit_right_shift)    CREEK_VM_DISPATCH();
+
+
+                // boolean
+                CREEK_VM_CASE(bool_xor)
+                {
+                    Variable r(std::move(m_stack.back()));
+                    m_stack.pop_back();
+                    Variable& l = m_stack.back();
+                    l = Variable::make_boolean(l.bool_value() != r.bool_value());
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(bool_not)
+                {
+                    Variable& v = m_stack.back();
+                    v = Variable::make_boolean(!v.bool_value());
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+
+                // comparison
+                CREEK_VM_CASE(cmp)
+                {
+                    Variable r(std::move(m_stack.back()));
+                    m_stack.pop_back();
+                    Variable& l = m_stack.back();
+                    l = Variable::make_number(l.cmp(r));
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(eq)               CREEK_VM_COMPARE(c == 0)            CREEK_VM_DISPATCH();
+                CREEK_VM_CASE(ne)               CREEK_VM_COMPARE(c != 0)            CREEK_VM_DISPATCH();
+                CREEK_VM_CASE(lt)               CREEK_VM_COMPARE(c < 0)             CREEK_VM_DISPATCH();
+                CREEK_VM_CASE(le)               CREEK_VM_COMPARE(c <= 0)            CREEK_VM_DISPATCH();
+                CREEK_VM_CASE(gt)               CREEK_VM_COMPARE(c > 0)             CREEK_VM_DISPATCH();
+                CREEK_VM_CASE(ge)               CREEK_VM_COMPARE(c >= 0)            CREEK_VM_DISPATCH();
+
+
+                // data types
+                CREEK_VM_CASE(data_vector)
+                {
+                    auto first = m_stack.end() - ip->a;
+                    Vector::Value value = std::make_shared< std::vector<Variable> >();
+                    value->reserve(ip->a);
+                    for (auto i = first; i != m_stack.end(); ++i)
+                    {
+                        value->emplace_back(std::move(*i));
+                    }
+                    m_stack.erase(first, m_stack.end());
+                    m_stack.emplace_back(new Vector(value));
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(data_map)
+                {
+                    auto first = m_stack.end() - 2 * ip->a;
+                    Map::Value value = std::make_shared<Map::Definition>();
+                    for (auto i = first; i != m_stack.end(); i += 2)
+                    {
+                        value->get_or_add(**i) = std::move(*(i + 1));
+                    }
+                    m_stack.erase(first, m_stack.end());
+                    m_stack.emplace_back(new Map(value));
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+
+                // control flow
+                CREEK_VM_CASE(control_throw)
+                {
+                    Variable value(std::move(m_stack.back()));
+                    m_stack.pop_back();
+                    throw value;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(control_return)
+                {
+                    Variable value(std::move(m_stack.back()));
+                    m_stack.pop_back();
+                    return value;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(control_break)
+                {
+                    Variable value(std::move(m_stack.back()));
+                    m_stack.pop_back();
+
+                    // innermost loop, leaving any try block inside it
+                    size_t i = m_blocks.size();
+                    while (i > block_base && m_blocks[i - 1].kind != OpCode::vm_loop_begin)
+                    {
+                        i -= 1;
+                    }
+
+                    // not in a loop: the whole program ends, like the
+                    // break point of a function does
+                    if (i == block_base)
+                    {
+                        return value;
+                    }
+
+                    m_blocks.resize(i);
+                    const Block& block = m_blocks.back();
+                    while (m_scopes.size() > block.scope_count)
+                    {
+                        m_scopes.pop_back();
+                    }
+                    current = m_scopes.size() > scope_base ? &m_scopes.back() : &scope;
+                    m_stack.resize(block.stack_size);
+                    m_stack.back() = std::move(value);
+                    ip = code + block.target;
+                }
+                CREEK_VM_DISPATCH();
+
+
+                // general
+                CREEK_VM_CASE(call)
+                {
+                    size_t first = m_stack.size() - ip->a;
+                    std::vector< std::unique_ptr<Data> > args;
+                    args.reserve(ip->a);
+                    for (size_t i = first; i < m_stack.size(); ++i)
+                    {
+                        args.emplace_back(m_stack[i].release());
+                    }
+                    Variable function(std::move(m_stack[first - 1]));
+                    m_stack.resize(first - 1);
+                    m_stack.emplace_back(function->call(args));
+                    m_stack.back().unbox();
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(variadic_call)
+                {
+                    Variable vararg(std::move(m_stack.back()));
+                    m_stack.pop_back();
+
+                    size_t first = m_stack.size() - ip->a;
+                    std::vector< std::unique_ptr<Data> > args;
+                    for (size_t i = first; i < m_stack.size(); ++i)
+                    {
+                        args.emplace_back(m_stack[i].release());
+                    }
+                    for (auto& a : vararg->vector_value())
+                    {
+                        args.emplace_back(a->copy());
+                    }
+                    Variable function(std::move(m_stack[first - 1]));
+                    m_stack.resize(first - 1);
+                    m_stack.emplace_back(function->call(args));
+                    m_stack.back().unbox();
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(call_method)
+                {
+                    size_t first = m_stack.size() - ip->a;
+                    Variable object(std::move(m_stack[first - 1]));
+                    Variable method(program.m_attr_caches[ip->b].method(object, program.m_attr_names[ip->b]));
+
+                    std::vector< std::unique_ptr<Data> > args;
+                    args.reserve(ip->a + 1);
+                    args.emplace_back(object.release());
+                    for (size_t i = first; i < m_stack.size(); ++i)
+                    {
+                        args.emplace_back(m_stack[i].release());
+                    }
+                    m_stack.resize(first - 1);
+                    m_stack.emplace_back(method->call(args));
+                    m_stack.back().unbox();
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(variadic_call_method)
+                {
+                    Variable vararg(std::move(m_stack.back()));
+                    m_stack.pop_back();
+
+                    size_t first = m_stack.size() - ip->a;
+                    Variable object(std::move(m_stack[first - 1]));
+                    Variable method(program.m_attr_caches[ip->b].method(object, program.m_attr_names[ip->b]));
+
+                    // same arguments as `ExprVariadicCallMethod`
+                    std::vector< std::unique_ptr<Data> > args;
+                    for (size_t i = first; i < m_stack.size(); ++i)
+                    {
+                        args.emplace_back(m_stack[i].release());
+                    }
+                    for (auto& a : vararg->vector_value())
+                    {
+                        args.emplace_back(a->copy());
+                    }
+                    m_stack.resize(first - 1);
+                    m_stack.emplace_back(method->call(args));
+                    m_stack.back().unbox();
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(index_get)
+                {
+                    Variable index(std::move(m_stack.back()));
+                    m_stack.pop_back();
+                    Variable& array = m_stack.back();
+                    array = array.index(std::move(index));
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(index_set)
+                {
+                    Variable value(std::move(m_stack.back()));
+                    m_stack.pop_back();
+                    Variable index(std::move(m_stack.back()));
+                    m_stack.pop_back();
+                    Variable& array = m_stack.back();
+                    array = array.index(std::move(index), std::move(value));
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(attr_get)
+                {
+                    Variable& object = m_stack.back();
+                    object = program.m_attr_caches[ip->a].attr(object, program.m_attr_names[ip->a]);
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(attr_set)
+                {
+                    Variable value(std::move(m_stack.back()));
+                    m_stack.pop_back();
+                    Variable& object = m_stack.back();
+                    object = object.attr(program.m_names[ip->a], std::move(value));
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+
+                // variable
+                CREEK_VM_CASE(var_create_local)
+                {
+                    current->create_local_var(program.m_names[ip->a], nullptr, ip->b) = m_stack.back();
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(var_load_local)
+                {
+                    m_stack.emplace_back(current->find_var(program.m_names[ip->a], ip->c, ip->b));
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(var_store_local)
+                {
+                    current->find_var(program.m_names[ip->a], ip->c, ip->b) = m_stack.back();
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(var_create_global)
+                {
+                    GlobalScope::current().create_local_var(program.m_names[ip->a], nullptr) = m_stack.back();
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(var_load_global)
+                {
+                    m_stack.emplace_back(GlobalScope::current().find_var(program.m_names[ip->a]));
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(var_store_global)
+                {
+                    GlobalScope::current().find_var(program.m_names[ip->a]) = m_stack.back();
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+
+                // virtual machine
+                CREEK_VM_CASE(vm_pop)
+                {
+                    m_stack.pop_back();
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(vm_drop)
+                {
+                    // keep the top value, drop `a` values below it
+                    m_stack.erase(m_stack.end() - 1 - ip->a, m_stack.end() - 1);
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(vm_const)
+                {
+                    m_stack.emplace_back(program.m_constants[ip->a]);
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(vm_eval)
+                {
+                    m_stack.emplace_back(program.m_expressions[ip->a]->eval(*current));
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(vm_jump)
+                {
+                    ip = code + ip->a;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(vm_jump_if_false)
+                {
+                    bool condition = m_stack.back().bool_value();
+                    m_stack.pop_back();
+                    ip = condition ? ip + 1 : code + ip->a;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(vm_jump_if_false_keep)
+                {
+                    if (m_stack.back().bool_value())
+                    {
+                        m_stack.pop_back();
+                        ++ip;
+                    }
+                    else
+                    {
+                        ip = code + ip->a;
+                    }
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(vm_jump_if_true_keep)
+                {
+                    if (m_stack.back().bool_value())
+                    {
+                        ip = code + ip->a;
+                    }
+                    else
+                    {
+                        m_stack.pop_back();
+                        ++ip;
+                    }
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(vm_jump_if_case)
+                {
+                    // compare the case value with the switch condition
+                    Variable value(std::move(m_stack.back()));
+                    m_stack.pop_back();
+                    if (m_stack.back().cmp(value) == 0)
+                    {
+                        m_stack.pop_back();
+                        ip = code + ip->a;
+                    }
+                    else
+                    {
+                        ++ip;
+                    }
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(vm_push_scope)
+                {
+                    m_scopes.emplace_back(*current);
+                    current = &m_scopes.back();
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(vm_pop_scope)
+                {
+                    m_scopes.pop_back();
+                    current = m_scopes.size() > scope_base ? &m_scopes.back() : &scope;
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(vm_clear_scope)
+                {
+                    // loops reuse the scope of their body
+                    current->clear();
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(vm_for_check)
+                {
+                    const ForRange& range = program.m_for_ranges[ip->b];
+                    Variable& i = current->find_var(program.m_names[range.var], range.depth, range.slot);
+                    ip = for_less(i, program.m_constants[range.max]) ? ip + 1 : code + ip->a;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(vm_for_step)
+                {
+                    // add the step and check the maximum
+                    const ForRange& range = program.m_for_ranges[ip->b];
+                    Variable& i = current->find_var(program.m_names[range.var], range.depth, range.slot);
+                    const Variable& step = program.m_constants[range.step];
+                    if (i.is_number() && step.is_number())
+                    {
+                        i = Variable::make_number(i.number() + step.number());
+                    }
+                    else
+                    {
+                        Variable step_value(step);
+                        i = i.add(step_value);
+                    }
+                    ip = for_less(i, program.m_constants[range.max]) ? code + ip->a : ip + 1;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(vm_loop_begin)
+                {
+                    // the loop result is the top of the stack
+                    m_blocks.push_back(Block{OpCode::vm_loop_begin, ip->a, m_stack.size(), m_scopes.size()});
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(vm_loop_set)
+                {
+                    m_stack[m_blocks.back().stack_size - 1] = std::move(m_stack.back());
+                    m_stack.pop_back();
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(vm_loop_end)
+                {
+                    m_blocks.pop_back();
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(vm_for_in_begin)
+                {
+                    // range, iterator
+                    Variable iterator(m_stack.back()->iter());
+                    m_stack.emplace_back(std::move(iterator));
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(vm_for_in_next)
+                {
+                    // range, iterator, loop result, next item
+                    Data* iterator = *m_stack[m_stack.size() - 2];
+                    m_stack.emplace_back();
+                    if (iterator->next(m_stack.back()))
+                    {
+                        ++ip;
+                    }
+                    else
+                    {
+                        m_stack.pop_back();
+                        ip = code + ip->a;
+                    }
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(vm_try_begin)
+                {
+                    m_blocks.push_back(Block{OpCode::vm_try_begin, ip->a, m_stack.size(), m_scopes.size()});
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+                CREEK_VM_CASE(vm_try_end)
+                {
+                    m_blocks.pop_back();
+                    ++ip;
+                }
+                CREEK_VM_DISPATCH();
+
+
+                // invalid
+                CREEK_VM_DEFAULT()
+                {
+                    throw Exception(std::string("Invalid instruction ") + op_code_names.at(ip->op));
+                }
+
+                CREEK_VM_END()
+            }
+            catch (...)
+            {
+                // innermost try block, leaving any loop inside it
+                size_t i = m_blocks.size();
+                while (i > block_base && m_blocks[i - 1].kind != OpCode::vm_try_begin)
+                {
+                    i -= 1;
+                }
+                if (i == block_base)
+                {
+                    throw;
+                }
+
+                Block block = m_blocks[i - 1];
+                m_blocks.resize(i - 1);
+                while (m_scopes.size() > block.scope_count)
+                {
+                    m_scopes.pop_back();
+                }
+                current = m_scopes.size() > scope_base ? &m_scopes.back() : &scope;
+                m_stack.resize(block.stack_size);
+                ip = code + block.target;
+            }
+        }
+    }
+
+
+    /// @brief  Execute a program with a machine of the calling thread.
+    Variable VirtualMachine::run_on_thread(const Program& program, Scope& scope)
+    {
+        static thread_local std::vector< std::unique_ptr<VirtualMachine> > machines;
+        static thread_local size_t running = 0;
+
+        // a run started by a call from another run takes the next machine
+        if (running == machines.size())
+        {
+            machines.emplace_back(new VirtualMachine());
+        }
+        VirtualMachine& vm = *machines[running];
+
+        struct Leave
+        {
+            size_t& running;
+
+            ~Leave()
+            {
+                running -= 1;
+            }
+        } leave { ++running };
+
+        return vm.run(program, scope);
+    }
+
+
+    /// @brief  `ExprProgram` constructor.
+    /// @param  program     Compiled program.
+    ExprProgram::ExprProgram(const std::shared_ptr<Program>& program) :
+        m_program(program)
+    {
+
+    }
+
+    Expression* ExprProgram::clone() const
+    {
+        return new ExprProgram(m_program);
+    }
+
+    bool ExprProgram::is_const() const
+    {
+        return false;
+    }
+
+    Expression* ExprProgram::const_optimize() const
+    {
+        return clone();
+    }
+
+    Variable ExprProgram::eval(Scope& scope)
+    {
+        if (m_program->is_lazy())
+        {
+            Compiler compiler;
+            compiler.compile(*m_program);
+        }
+
+        return VirtualMachine::run_on_thread(*m_program, scope);
+    }
+
+    void ExprProgram::bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const
+    {
+        Compiler compiler;
+        std::unique_ptr<Expression> expression(compiler.decompile(*m_program));
+
+        // the functions of the body are listed with their captures
+        VarResolver().resolve(expression.get());
+        expression->bytecode(bytecode, var_name_map);
+    }
+
+    /// @brief  Get the compiled program.
+    const std::shared_ptr<Program>& ExprProgram::program() const
+    {
+        return m_program;
+    }
+}
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <creek/api_mode.hpp>
+#include <creek/AttrCache.hpp>
+#include <creek/Bytecode.hpp>
+#include <creek/Expression.hpp>
+#include <creek/OpCode.hpp>
+#include <creek/Scope.hpp>
+#include <creek/VarName.hpp>
+#include <creek/VarNameMap.hpp>
+#include <creek/Variable.hpp>
+
+
+namespace creek
+{
+    struct FunctionVars;
+
+
+    /// @brief  Virtual machine instruction.
+    /// Data operations reuse the bytecode op-codes; control flow is done
+    /// with the `vm_*` op-codes.
+    /// Local variables are given by name (`a`), slot (`b`) and depth (`c`),
+    /// as resolved by `VarResolver` when compiling.
+    struct Instruction
+    {
+        OpCode op;      ///< Operation.
+        uint16_t c;     ///< Third operand (scope depth).
+        uint32_t a;     ///< First operand (jump target, count or table index).
+        uint32_t b;     ///< Second operand.
+    };
+
+
+    /// @brief  Loop variable and constant bounds of a `for` loop.
+    /// Used by `vm_for_check` and `vm_for_step`, which count numbers
+    /// natively like `ExprFor` does.
+    struct ForRange
+    {
+        uint32_t var;       ///< Name index of the variable.
+        uint32_t slot;      ///< Slot of the variable.
+        uint16_t depth;     ///< Scope depth of the variable.
+        uint32_t max;       ///< Constant index of the maximum value.
+        uint32_t step;      ///< Constant index of the step value.
+    };
+
+
+    /// @brief  Compiled program for the virtual machine.
+    /// Flat array of instructions plus the tables they refer to.
+    /// A program can also be lazy: it only has its source bytecode until it
+    /// is compiled by `Compiler::compile(Program&)` on its first run.
+    class CREEK_API Program
+    {
+    public:
+        /// @brief  `Program` constructor.
+        Program();
+
+
+        /// @brief  Append an instruction.
+        /// @return Index of the new instruction.
+        uint32_t emit(OpCode op, uint32_t a = 0, uint32_t b = 0, uint16_t c = 0);
+
+        /// @brief  Set the first operand of an instruction.
+        /// Used to resolve forward jumps.
+        void patch(uint32_t index, uint32_t a);
+
+        /// @brief  Number of instructions.
+        uint32_t size() const;
+
+        /// @brief  Get the instructions.
+        const std::vector<Instruction>& code() const;
+
+
+        /// @brief  Add a constant.
+        /// @return Index of the constant.
+        uint32_t add_constant(Data* data);
+
+        /// @brief  Add a variable name.
+        /// @return Index of the name.
+        uint32_t add_name(VarName name);
+
+        /// @brief  Add an attribute lookup, for one instruction.
+        /// @param  name    Attribute name.
+        /// @return Index of the lookup.
+        uint32_t add_attr_lookup(VarName name);
+
+        /// @brief  Add the range of a `for` loop with constant bounds.
+        /// @return Index of the range.
+        uint32_t add_for_range(const ForRange& range);
+
+        /// @brief  Add an expression to evaluate with `vm_eval`.
+        /// @return Index of the expression.
+        uint32_t add_expression(Expression* expression);
+
+
+        /// @brief  Set the bytecode this program was compiled from.
+        /// Needed to get back an equivalent expression.
+        void source(const Bytecode& bytes, const std::shared_ptr<const VarNameMap>& var_name_map);
+
+        /// @brief  Get the source bytecode.
+        const Bytecode& source_bytes() const;
+
+        /// @brief  Get the var name map of the source bytecode.
+        const std::shared_ptr<const VarNameMap>& source_var_name_map() const;
+
+        /// @brief  Check if this program has a source but no instructions.
+        bool is_lazy() const;
+
+
+        /// @brief  Set the function this program is the body of.
+        /// Needed to compile a lazy body: the arguments take the first
+        /// slots, and the captures are in the closure environment.
+        /// @param  arg_names   Argument names.
+        /// @param  vars        Variables of the function; the slots of the
+        ///                     body are stored there once it is compiled.
+        void function(const std::vector<VarName>& arg_names, const std::shared_ptr<FunctionVars>& vars);
+
+        /// @brief  Get the argument names of the function.
+        const std::vector<VarName>& arg_names() const;
+
+        /// @brief  Get the variables of the function, if the program is a
+        /// function body.
+        const std::shared_ptr<FunctionVars>& function_vars() const;
+
+
+    private:
+        friend class VirtualMachine;
+
+        std::vector<Instruction> m_code;
+        std::vector<Variable> m_constants;
+        std::vector<VarName> m_names;
+        std::map<VarName, uint32_t> m_name_indexes;    ///< Index of each name in `m_names`.
+        std::vector<VarName> m_attr_names;              ///< Attribute of each lookup.
+        mutable std::vector<AttrCache> m_attr_caches;   ///< Cache of each lookup.
+        std::vector<ForRange> m_for_ranges;
+        std::vector< std::unique_ptr<Expression> > m_expressions;
+
+        Bytecode m_source_bytes;
+        std::shared_ptr<const VarNameMap> m_source_var_name_map;
+
+        std::vector<VarName> m_arg_names;
+        std::shared_ptr<FunctionVars> m_function_vars;
+    };
+
+
+    /// @brief  Stack based virtual machine.
+    /// Executes a compiled `Program` with a dispatch loop (computed goto
+    /// when compiled with GCC or Clang, a switch otherwise).
+    class CREEK_API VirtualMachine
+    {
+    public:
+        /// @brief  `VirtualMachine` constructor.
+        VirtualMachine();
+
+
+        /// @brief  Execute a program.
+        /// @param  program     Program to execute.
+        /// @param  scope       Scope where the program is executed.
+        /// @return Value of the program.
+        Variable run(const Program& program, Scope& scope);
+
+        /// @brief  Execute a program with a machine of the calling thread.
+        /// Each thread keeps one machine for each level of runs nested by
+        /// function calls, so the stacks keep their memory between runs.
+        /// @param  program     Program to execute.
+        /// @param  scope       Scope where the program is executed.
+        /// @return Value of the program.
+        static Variable run_on_thread(const Program& program, Scope& scope);
+
+
+    private:
+        /// @brief  Loop or try block being executed.
+        struct Block
+        {
+            OpCode kind;            ///< `vm_loop_begin` or `vm_try_begin`.
+            uint32_t target;        ///< Loop exit or catch handler.
+            size_t stack_size;      ///< Operand stack size when entered.
+            size_t scope_count;     ///< Scope stack size when entered.
+        };
+
+        std::vector<Variable> m_stack;
+        std::deque<Scope> m_scopes;
+        std::vector<Block> m_blocks;
+    };
+
+
+    /// @brief  Expression: Run a compiled program in the virtual machine.
+    class CREEK_API ExprProgram : public Expression
+    {
+    public:
+        /// @brief  `ExprProgram` constructor.
+        /// @param  program     Compiled program.
+        ExprProgram(const std::shared_ptr<Program>& program);
+
+        Expression* clone() const override;
+        bool is_const() const override;
+        Expression* const_optimize() const override;
+        Variable eval(Scope& scope) override;
+        void bytecode(Bytecode& bytecode, VarNameMap& var_name_map) const override;
+
+        /// @brief  Get the compiled program.
+        const std::shared_ptr<Program>& program() const;
+
+    private:
+        std::shared_ptr<Program> m_program;
+    };
+}
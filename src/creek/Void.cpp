@@ -6,6 +6,11 @@
 
 namespace creek
 {
+    Void::Void() : Data(DataType::void_data)
+    {
+
+    }
+
     Data* Void::copy() const
     {
         return new Void();
@@ -33,6 +38,6 @@ namespace creek
 
     Data* Void::get_class() const
     {
-        return GlobalScope::class_Void->copy();
+        return GlobalScope::current().class_Void->copy();
     }
 }
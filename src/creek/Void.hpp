@@ -14,6 +14,10 @@ namespace creek
         using Value = void;
 
 
+        /// Constructor.
+        Void();
+
+
         Data* copy() const override;
         std::string class_name() const override;
         std::string debug_text() const override;
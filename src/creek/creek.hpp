@@ -4,10 +4,13 @@
 #pragma once
 
 #include <creek/api_mode.hpp>
+#include <creek/AttrCache.hpp>
 #include <creek/Boolean.hpp>
 #include <creek/Bytecode.hpp>
+#include <creek/BytecodeCache.hpp>
 #include <creek/BytecodeInterpreter.hpp>
 #include <creek/CFunction.hpp>
+#include <creek/Compiler.hpp>
 #include <creek/Data.hpp>
 #include <creek/DynCFunction.hpp>
 #include <creek/DynLibrary.hpp>
@@ -28,13 +31,18 @@
 #include <creek/GlobalScope.hpp>
 #include <creek/Identifier.hpp>
 #include <creek/Interpreter.hpp>
+#include <creek/Isolate.hpp>
+#include <creek/Iterator.hpp>
 #include <creek/Map.hpp>
+#include <creek/MappedFile.hpp>
+#include <creek/ModuleRegistry.hpp>
 #include <creek/Null.hpp>
 #include <creek/Number.hpp>
 #include <creek/Object.hpp>
 #include <creek/OpCode.hpp>
 #include <creek/Resolver.hpp>
 #include <creek/Scope.hpp>
+#include <creek/Shape.hpp>
 #include <creek/StandardLibrary.hpp>
 #include <creek/String.hpp>
 #include <creek/Token.hpp>
@@ -42,6 +50,8 @@
 #include <creek/Variable.hpp>
 #include <creek/VarName.hpp>
 #include <creek/VarNameMap.hpp>
+#include <creek/VarResolver.hpp>
 #include <creek/Vector.hpp>
 #include <creek/Version.hpp>
+#include <creek/VirtualMachine.hpp>
 #include <creek/Void.hpp>